@@ -0,0 +1,143 @@
+/*
+ * Compares two Google Benchmark JSON outputs, written with --benchmark_out_format=json and a few repetitions each.
+ * A benchmark regressed when its median got slower than the threshold and the Mann-Whitney test finds the slow down
+ * significant, so that noise alone does not fail a run. Exits with 1 when a benchmark matching --fail-on regressed,
+ * the other regressions are only reported.
+ *
+ * benchmark-compare [--threshold 0.05] [--alpha 0.05] [--fail-on <regex>] <baseline.json> <contender.json>
+ **/
+
+import std;
+
+import benchmark_comparison;
+
+using namespace benchmark_comparison;
+
+namespace {
+
+constexpr std::string_view usage { "Usage: benchmark-compare [--threshold 0.05] [--alpha 0.05] [--fail-on <regex>] <baseline.json> <contender.json>" };
+
+struct Options {
+    ComparisonSettings m_settings;
+    std::optional<std::regex> m_failOn;
+    std::filesystem::path m_baseline;
+    std::filesystem::path m_contender;
+};
+
+[[nodiscard]] auto parseFraction(const std::string_view text) -> std::optional<double> {
+    double value { 0.0 };
+
+    if (const auto [end, error] { std::from_chars(text.data(), text.data() + text.size(), value) };
+        error != std::errc {} or end != text.data() + text.size() or value < 0.0) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+[[nodiscard]] auto parseOptions(const std::span<char*> arguments) -> std::expected<Options, std::string> {
+    Options options { ComparisonSettings { 0.05, 0.05 }, std::nullopt, {}, {} };
+    std::vector<std::string_view> files {};
+
+    for (std::size_t i { 0 }; i < arguments.size(); ++i) {
+        const std::string_view argument { arguments[i] };
+
+        if (not argument.starts_with("--")) {
+            files.push_back(argument);
+            continue;
+        }
+
+        if (i + 1 == arguments.size()) {
+            return std::unexpected { std::format("Missing value of {}", argument) };
+        }
+
+        const std::string_view value { arguments[++i] };
+
+        if (argument == "--threshold" or argument == "--alpha") {
+            const auto fraction { parseFraction(value) };
+
+            if (not fraction.has_value()) {
+                return std::unexpected { std::format("Invalid {} {}", argument, value) };
+            }
+
+            (argument == "--threshold" ? options.m_settings.m_threshold : options.m_settings.m_alpha) = *fraction;
+        } else if (argument == "--fail-on") {
+            try {
+                options.m_failOn.emplace(std::string { value }, std::regex::ECMAScript);
+            } catch (const std::regex_error&) {
+                return std::unexpected { std::format("Invalid --fail-on {}", value) };
+            }
+        } else {
+            return std::unexpected { std::format("Unknown option {}", argument) };
+        }
+    }
+
+    if (files.size() != 2) {
+        return std::unexpected { std::string { usage } };
+    }
+
+    options.m_baseline = files[0];
+    options.m_contender = files[1];
+
+    return options;
+}
+
+// In the largest unit keeping at least one
+[[nodiscard]] auto formatTime(const double nanoseconds) -> std::string {
+    if (nanoseconds >= 1e9) return std::format("{:.3f} s", nanoseconds / 1e9);
+    if (nanoseconds >= 1e6) return std::format("{:.3f} ms", nanoseconds / 1e6);
+    if (nanoseconds >= 1e3) return std::format("{:.3f} us", nanoseconds / 1e3);
+    return std::format("{:.3f} ns", nanoseconds);
+}
+
+}
+
+auto main(const int argc, char** argv) -> int {
+    const auto options { parseOptions(std::span { argv, static_cast<std::size_t>(argc) }.subspan(1)) };
+
+    if (not options.has_value()) {
+        std::println("{}", options.error());
+        return 1;
+    }
+
+    const auto baseline { readBenchmarkRuns(options->m_baseline) };
+    const auto contender { readBenchmarkRuns(options->m_contender) };
+
+    for (const auto* runs: { &baseline, &contender }) {
+        if (not runs->has_value()) {
+            std::println("{}", runs->error());
+            return 1;
+        }
+    }
+
+    const auto comparisons { compare(*baseline, *contender, options->m_settings) };
+
+    if (comparisons.empty()) {
+        std::println("No benchmark in common between {} and {}", options->m_baseline.string(), options->m_contender.string());
+        return 1;
+    }
+
+    const auto nameWidth { std::ranges::max(comparisons | std::views::transform([] (const Comparison& comparison) { return comparison.m_name.size(); })) };
+    std::size_t failures { 0 };
+
+    std::println("{:<{}}  {:>14}  {:>14}  {:>8}  {:>7}", "Benchmark", nameWidth, "Baseline", "Contender", "Change", "p-value");
+
+    for (const auto& comparison: comparisons) {
+        const auto fails { comparison.m_regressed and options->m_failOn.has_value() and std::regex_search(comparison.m_name, *options->m_failOn) };
+
+        if (fails) {
+            ++failures;
+        }
+
+        std::println("{:<{}}  {:>14}  {:>14}  {:>+7.1f}%  {:>7.4f}{}", comparison.m_name, nameWidth, formatTime(comparison.m_baselineMedian),
+            formatTime(comparison.m_contenderMedian), 100.0 * comparison.m_change, comparison.m_pValue,
+            fails ? "  REGRESSION" : comparison.m_regressed ? "  regression" : "");
+    }
+
+    const auto regressions { std::ranges::count_if(comparisons, &Comparison::m_regressed) };
+
+    std::println("{} of {} benchmarks regressed beyond {:.1f}% at p < {}, {} failing", regressions, comparisons.size(),
+        100.0 * options->m_settings.m_threshold, options->m_settings.m_alpha, failures);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,392 @@
+module benchmark_comparison;
+
+namespace benchmark_comparison {
+
+namespace {
+
+// Strings, numbers, booleans and null. Nested arrays and objects are skipped, none of the fields read holds one
+using JsonScalar = std::variant<std::monostate, std::string, double, bool>;
+
+// Reads JSON as it goes instead of building a tree, throws std::runtime_error on malformed input
+class JsonReader final {
+public:
+    explicit JsonReader(const std::string_view json) : m_json { json }, m_position { 0 } {}
+
+    // Calls the visitor with every key, which then reads or skips the value
+    template <typename Visitor>
+    auto object(Visitor&& visitor) -> void {
+        expect('{');
+
+        if (peek() == '}') {
+            ++m_position;
+            return;
+        }
+
+        do {
+            auto key { string() };
+            expect(':');
+            visitor(std::as_const(key));
+        } while (next(',', '}'));
+    }
+
+    // Calls the visitor for every element, which then reads or skips it
+    template <typename Visitor>
+    auto array(Visitor&& visitor) -> void {
+        expect('[');
+
+        if (peek() == ']') {
+            ++m_position;
+            return;
+        }
+
+        do {
+            visitor();
+        } while (next(',', ']'));
+    }
+
+    auto scalar() -> JsonScalar {
+        switch (peek()) {
+            case '{':
+                object([this] (const std::string&) { skip(); });
+                return {};
+            case '[':
+                array([this] () { skip(); });
+                return {};
+            case '"':
+                return string();
+            default:
+                return literal();
+        }
+    }
+
+    auto skip() -> void { std::ignore = scalar(); }
+
+    auto end() -> void {
+        if (peek() != '\0') {
+            fail("Unexpected content");
+        }
+    }
+
+private:
+    // Past whitespace, '\0' at the end
+    auto peek() -> char {
+        while (m_position < m_json.size() and std::isspace(static_cast<unsigned char>(m_json[m_position]))) {
+            ++m_position;
+        }
+
+        return m_position < m_json.size() ? m_json[m_position] : '\0';
+    }
+
+    auto expect(const char expected) -> void {
+        if (peek() != expected) {
+            fail(std::format("Expected '{}'", expected));
+        }
+
+        ++m_position;
+    }
+
+    // After an element, true when another one follows
+    auto next(const char separator, const char closing) -> bool {
+        if (const auto character { peek() }; character == separator or character == closing) {
+            ++m_position;
+            return character == separator;
+        }
+
+        fail(std::format("Expected '{}' or '{}'", separator, closing));
+    }
+
+    auto string() -> std::string {
+        expect('"');
+
+        std::string value {};
+
+        while (m_position < m_json.size() and m_json[m_position] != '"') {
+            if (const auto character { m_json[m_position++] }; character != '\\') {
+                value.push_back(character);
+            } else if (m_position == m_json.size()) {
+                break;
+            } else {
+                switch (const auto escaped { m_json[m_position++] }) {
+                    case 'b': value.push_back('\b'); break;
+                    case 'f': value.push_back('\f'); break;
+                    case 'n': value.push_back('\n'); break;
+                    case 'r': value.push_back('\r'); break;
+                    case 't': value.push_back('\t'); break;
+                    case 'u': appendCodePoint(value); break;
+                    default: value.push_back(escaped); break;
+                }
+            }
+        }
+
+        if (m_position == m_json.size()) {
+            fail("Unterminated string");
+        }
+
+        ++m_position;
+        return value;
+    }
+
+    // Of a \u escape, as UTF-8. Names are ASCII, surrogate pairs are not joined
+    auto appendCodePoint(std::string& value) -> void {
+        std::uint32_t codePoint { 0 };
+
+        if (m_position + 4 > m_json.size()
+            or std::from_chars(m_json.data() + m_position, m_json.data() + m_position + 4, codePoint, 16).ptr != m_json.data() + m_position + 4) {
+            fail("Invalid unicode escape");
+        }
+
+        m_position += 4;
+
+        if (codePoint < 0x80) {
+            value.push_back(static_cast<char>(codePoint));
+        } else if (codePoint < 0x800) {
+            value.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+            value.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+        } else {
+            value.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+            value.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+            value.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+        }
+    }
+
+    // Numbers, true, false and null. Google Benchmark also writes NaN and Infinity for counters out of range
+    auto literal() -> JsonScalar {
+        const auto start { m_position };
+
+        while (m_position < m_json.size()
+            and (std::isalnum(static_cast<unsigned char>(m_json[m_position])) or std::string_view { "+-." }.contains(m_json[m_position]))) {
+            ++m_position;
+        }
+
+        const auto token { m_json.substr(start, m_position - start) };
+
+        if (token == "true" or token == "false") {
+            return token == "true";
+        }
+
+        if (token == "null") {
+            return {};
+        }
+
+        double value { 0.0 };
+
+        if (token.empty() or std::from_chars(token.data(), token.data() + token.size(), value).ptr != token.data() + token.size()) {
+            m_position = start;
+            fail("Invalid value");
+        }
+
+        return value;
+    }
+
+    [[noreturn]] auto fail(const std::string_view message) const -> void {
+        throw std::runtime_error { std::format("{} at offset {}", message, m_position) };
+    }
+
+    std::string_view m_json;
+    std::size_t m_position;
+};
+
+[[nodiscard]] auto nanosecondsPer(const std::string_view timeUnit) -> std::optional<double> {
+    if (timeUnit == "ns") return 1.0;
+    if (timeUnit == "us") return 1e3;
+    if (timeUnit == "ms") return 1e6;
+    if (timeUnit == "s") return 1e9;
+    return std::nullopt;
+}
+
+// Number of orderings of the baseline and contender times giving each U, contender times above baseline ones counting
+// for one, among the (n + m)! / (n! m!) equally likely when both come from the same distribution. The largest time is
+// either a contender one, above all baseline ones, or a baseline one, above none
+[[nodiscard]] auto uDistribution(const std::size_t baselineCount, const std::size_t contenderCount) -> std::vector<double> {
+    std::vector<std::vector<std::vector<double>>> counts(baselineCount + 1, std::vector<std::vector<double>>(contenderCount + 1));
+
+    for (std::size_t n { 0 }; n <= baselineCount; ++n) {
+        for (std::size_t m { 0 }; m <= contenderCount; ++m) {
+            auto& distribution { counts[n][m] };
+            distribution.assign(n * m + 1, 0.0);
+
+            if (n == 0 or m == 0) {
+                distribution[0] = 1.0;
+                continue;
+            }
+
+            for (std::size_t u { 0 }; u < counts[n - 1][m].size(); ++u) {
+                distribution[u] += counts[n - 1][m][u];
+            }
+
+            for (std::size_t u { 0 }; u < counts[n][m - 1].size(); ++u) {
+                distribution[u + n] += counts[n][m - 1][u];
+            }
+        }
+    }
+
+    return std::move(counts[baselineCount][contenderCount]);
+}
+
+// Beyond, the normal approximation is close enough
+constexpr std::size_t largestExactProduct { 400 };
+
+}
+
+auto parseBenchmarkRuns(const std::string_view json) -> std::expected<BenchmarkRuns, std::string> {
+    BenchmarkRuns runs {};
+    JsonReader reader { json };
+
+    try {
+        reader.object([&runs, &reader] (const std::string& key) {
+            if (key != "benchmarks") {
+                reader.skip();
+                return;
+            }
+
+            reader.array([&runs, &reader] () {
+                std::map<std::string, JsonScalar, std::less<>> fields {};
+                reader.object([&fields, &reader] (const std::string& field) { fields[field] = reader.scalar(); });
+
+                const auto text { [&fields] (const std::string_view field) -> std::string {
+                    const auto found { fields.find(field) };
+                    return found != fields.end() and std::holds_alternative<std::string>(found->second) ? std::get<std::string>(found->second) : std::string {};
+                } };
+
+                const auto errorOccurred { fields.find("error_occurred") };
+
+                // Aggregates only summarize the repetitions, skipped benchmarks have no time
+                if (text("run_type") == "aggregate"
+                    or (errorOccurred != fields.end() and std::holds_alternative<bool>(errorOccurred->second) and std::get<bool>(errorOccurred->second))) {
+                    return;
+                }
+
+                const auto realTime { fields.find("real_time") };
+                const auto unit { nanosecondsPer(text("time_unit")) };
+                auto name { text("run_name") };
+
+                // Outputs of older versions have no run name, but neither do they repeat
+                if (name.empty()) {
+                    name = text("name");
+                }
+
+                if (name.empty() or realTime == fields.end() or not std::holds_alternative<double>(realTime->second) or not unit.has_value()) {
+                    throw std::runtime_error { std::format("Benchmark {} has no name, real time or known time unit", name) };
+                }
+
+                runs[name].push_back(std::get<double>(realTime->second) * *unit);
+            });
+        });
+
+        reader.end();
+    } catch (const std::runtime_error& error) {
+        return std::unexpected { std::format("Invalid benchmark output: {}", error.what()) };
+    }
+
+    return runs;
+}
+
+auto readBenchmarkRuns(const std::filesystem::path& path) -> std::expected<BenchmarkRuns, std::string> {
+    std::ifstream file { path, std::ios::binary };
+
+    if (not file.is_open()) {
+        return std::unexpected { std::format("Cannot open {}", path.string()) };
+    }
+
+    const std::string json { std::istreambuf_iterator<char> { file }, std::istreambuf_iterator<char> {} };
+
+    auto runs { parseBenchmarkRuns(json) };
+
+    if (not runs.has_value()) {
+        return std::unexpected { std::format("{}: {}", path.string(), runs.error()) };
+    }
+
+    return runs;
+}
+
+auto median(std::vector<double> values) -> double {
+    if (values.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    const auto middle { values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2) };
+    std::ranges::nth_element(values, middle);
+
+    if (values.size() % 2 == 1) {
+        return *middle;
+    }
+
+    return (*middle + *std::ranges::max_element(values.begin(), middle)) / 2.0;
+}
+
+auto mannWhitneyPValue(const std::span<const double> baseline, const std::span<const double> contender) -> double {
+    if (baseline.empty() or contender.empty()) {
+        return 1.0;
+    }
+
+    // Pairs where the contender is slower, ties counting for half
+    double u { 0.0 };
+
+    for (const auto contenderTime: contender) {
+        for (const auto baselineTime: baseline) {
+            u += contenderTime > baselineTime ? 1.0 : contenderTime == baselineTime ? 0.5 : 0.0;
+        }
+    }
+
+    const auto n { baseline.size() };
+    const auto m { contender.size() };
+
+    if (n * m <= largestExactProduct) {
+        const auto distribution { uDistribution(n, m) };
+        const auto total { std::ranges::fold_left(distribution, 0.0, std::plus {}) };
+        const auto first { static_cast<std::size_t>(std::ceil(u)) };
+
+        return std::ranges::fold_left(distribution | std::views::drop(first), 0.0, std::plus {}) / total;
+    }
+
+    // Ties narrow the spread of U
+    std::vector<double> times { baseline.begin(), baseline.end() };
+    times.insert(times.end(), contender.begin(), contender.end());
+    std::ranges::sort(times);
+
+    double tieCorrection { 0.0 };
+
+    for (auto tie { times.begin() }; tie != times.end(); ) {
+        const auto tieEnd { std::ranges::upper_bound(tie, times.end(), *tie) };
+        const auto tied { static_cast<double>(tieEnd - tie) };
+
+        tieCorrection += tied * tied * tied - tied;
+        tie = tieEnd;
+    }
+
+    const auto count { static_cast<double>(n + m) };
+    const auto pairs { static_cast<double>(n * m) };
+    const auto deviation { std::sqrt(pairs / 12.0 * ((count + 1.0) - tieCorrection / (count * (count - 1.0)))) };
+
+    if (deviation == 0.0) {
+        return 1.0;
+    }
+
+    // With continuity correction
+    const auto z { (u - pairs / 2.0 - 0.5) / deviation };
+
+    return 0.5 * std::erfc(z / std::numbers::sqrt2);
+}
+
+auto compare(const BenchmarkRuns& baseline, const BenchmarkRuns& contender, const ComparisonSettings settings) -> std::vector<Comparison> {
+    std::vector<Comparison> comparisons {};
+
+    for (const auto& [name, baselineTimes]: baseline) {
+        const auto contenderTimes { contender.find(name) };
+
+        if (contenderTimes == contender.end()) {
+            continue;
+        }
+
+        const auto baselineMedian { median(baselineTimes) };
+        const auto contenderMedian { median(contenderTimes->second) };
+        const auto change { baselineMedian > 0.0 ? contenderMedian / baselineMedian - 1.0 : 0.0 };
+        const auto pValue { mannWhitneyPValue(baselineTimes, contenderTimes->second) };
+
+        comparisons.emplace_back(name, baselineMedian, contenderMedian, change, pValue, change > settings.m_threshold and pValue < settings.m_alpha);
+    }
+
+    return comparisons;
+}
+
+}
@@ -0,0 +1,42 @@
+export module benchmark_comparison;
+
+import std;
+
+namespace benchmark_comparison {
+
+// Real times of the repetitions of every benchmark of a Google Benchmark JSON output, in nanoseconds, by run name.
+// Aggregates are left out, statistics are computed again from the repetitions
+export using BenchmarkRuns = std::map<std::string, std::vector<double>>;
+
+export [[nodiscard]] auto parseBenchmarkRuns(std::string_view json) -> std::expected<BenchmarkRuns, std::string>;
+export [[nodiscard]] auto readBenchmarkRuns(const std::filesystem::path& path) -> std::expected<BenchmarkRuns, std::string>;
+
+export [[nodiscard]] auto median(std::vector<double> values) -> double;
+
+// Probability of the contender times being as much above the baseline ones by chance alone, from a one sided Mann-Whitney
+// U test. Exact for a few repetitions, from the normal approximation beyond. With three repetitions or less on each side
+// it never goes below 0.05
+export [[nodiscard]] auto mannWhitneyPValue(std::span<const double> baseline, std::span<const double> contender) -> double;
+
+export struct ComparisonSettings final {
+    // Relative slow down of the median from which a benchmark regressed, 0.05 for 5 %
+    double m_threshold;
+    // Significance level of the test, timings being noisy a slow down is only a regression when it is significant
+    double m_alpha;
+};
+
+export struct Comparison final {
+    std::string m_name;
+    double m_baselineMedian;
+    double m_contenderMedian;
+    // Relative to the baseline median, positive when slower
+    double m_change;
+    double m_pValue;
+    bool m_regressed;
+};
+
+// Of the benchmarks found in both runs, by name
+export [[nodiscard]] auto compare(const BenchmarkRuns& baseline, const BenchmarkRuns& contender, ComparisonSettings settings)
+    -> std::vector<Comparison>;
+
+}
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#if defined(__GNUC__) and not defined(__clang__)
+    // Once the replacing operator delete is inlined, GCC sees it free what it takes for the default operator new
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+import std;
+import async_task_scheduler;
+import task_manager;
+
+using namespace async_task_scheduler;
+
+namespace {
+
+constexpr unsigned int numberOfExecutors { 2 };
+// Runs before counting, until the pool and the queues have grown to fit
+constexpr std::size_t warmUpIterations { 10'000 };
+
+// Every thread, executors included
+std::atomic<std::uint64_t> allocations { 0 };
+
+// What a manager call captures: the manager, a few values
+struct Settings {
+    std::uint32_t m_sampleRate;
+    std::uint16_t m_channelCount;
+    bool m_enabled;
+};
+
+}
+
+auto operator new(const std::size_t size) -> void* {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* block { std::malloc(std::max<std::size_t>(size, 1)) }) {
+        return block;
+    }
+
+    throw std::bad_alloc {};
+}
+
+auto operator delete(void* block) noexcept -> void { std::free(block); }
+auto operator delete(void* block, std::size_t) noexcept -> void { std::free(block); }
+
+// Argument: tasks per call, enqueued the way managers do and waited for. Counts heap allocations per call
+auto BM_EnqueueAllocations(benchmark::State& state) -> void {
+    const auto taskCount { static_cast<std::size_t>(state.range(0)) };
+
+    auto scheduler { makeAsyncTaskScheduler(numberOfExecutors).value() };
+    auto manager { makeTaskManager(*scheduler) };
+    const Settings settings { 48000, 2, true };
+    std::atomic<std::uint64_t> sum { 0 };
+
+    auto call { [&] () {
+        auto first { makeAtomicTask([&sum, settings] () {
+            sum.fetch_add(settings.m_sampleRate, std::memory_order_relaxed);
+            return settings.m_enabled;
+        }) };
+        const auto result { first->result() };
+
+        if (taskCount == 1) {
+            manager->enqueueTasks(Priority::Control, std::move(first));
+        } else {
+            auto second { makeAtomicTask([&sum, settings] () { sum.fetch_add(settings.m_channelCount, std::memory_order_relaxed); }) };
+            const auto secondDependency { second->dependency() };
+
+            manager->enqueueTasks(Priority::Control, std::move(first), std::move(second));
+            secondDependency.wait();
+        }
+
+        benchmark::DoNotOptimize(result.get());
+    } };
+
+    for (std::size_t i { 0 }; i < warmUpIterations; ++i) {
+        call();
+    }
+
+    const auto allocationsBefore { allocations.load(std::memory_order_relaxed) };
+
+    for ([[maybe_unused]] auto _: state) {
+        call();
+    }
+
+    state.counters["allocations"] = benchmark::Counter { static_cast<double>(allocations.load(std::memory_order_relaxed) - allocationsBefore),
+        benchmark::Counter::kAvgIterations };
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EnqueueAllocations)->Arg(1)->Arg(2)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+namespace {
+
+constexpr unsigned int numberOfExecutors { 4 };
+
+auto makeTasks(const std::size_t count, std::atomic<std::size_t>& remainingTasks) -> std::vector<std::unique_ptr<AsyncTask>> {
+    std::vector<std::unique_ptr<AsyncTask>> tasks {};
+    tasks.reserve(count);
+
+    for (std::size_t i { 0 }; i < count; ++i) {
+        tasks.push_back(makeAtomicTask([&remainingTasks] () {
+            if (remainingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                remainingTasks.notify_one();
+            }
+        }));
+    }
+
+    return tasks;
+}
+
+auto waitForTasks(const std::atomic<std::size_t>& remainingTasks) -> void {
+    for (auto remaining { remainingTasks.load(std::memory_order_acquire) }; remaining != 0; remaining = remainingTasks.load(std::memory_order_acquire)) {
+        remainingTasks.wait(remaining, std::memory_order_acquire);
+    }
+}
+
+}
+
+// Argument: tasks submitted at once. Submission is timed apart from running the tasks, which are built beforehand
+template <bool Batch>
+auto BM_SubmitTasks(benchmark::State& state) -> void {
+    const auto taskCount { static_cast<std::size_t>(state.range(0)) };
+
+    auto scheduler { makeAsyncTaskScheduler(numberOfExecutors).value() };
+    double submission { 0.0 };
+
+    for ([[maybe_unused]] auto _: state) {
+        state.PauseTiming();
+        std::atomic<std::size_t> remainingTasks { taskCount };
+        auto tasks { makeTasks(taskCount, remainingTasks) };
+        state.ResumeTiming();
+
+        const auto start { std::chrono::steady_clock::now() };
+
+        if constexpr (Batch) {
+            scheduler->enqueueTasks(std::move(tasks));
+        } else {
+            // As TaskManager did, one lock and one notification per task
+            unsigned int threadId { 0 };
+
+            for (auto& task: tasks) {
+                scheduler->enqueueTask(std::move(task), threadId++ % numberOfExecutors);
+            }
+        }
+
+        submission += std::chrono::duration<double, std::micro> { std::chrono::steady_clock::now() - start }.count();
+        waitForTasks(remainingTasks);
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0));
+    state.counters["submit_us"] = submission / static_cast<double>(state.iterations());
+}
+
+BENCHMARK(BM_SubmitTasks<true>)->Arg(1'000)->Arg(10'000)->Arg(100'000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SubmitTasks<false>)->Arg(1'000)->Arg(10'000)->Arg(100'000)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+// Previous AtomicTask: its result goes through a packaged task and its completion through a promise, each with a heap
+// allocated state, a mutex and a condition variable. The state of its base stands for the continuation list Signal allocated
+template <typename Res>
+class ReferenceTask final : public AsyncTask {
+public:
+    template <typename Callable>
+    explicit ReferenceTask(Callable&& callable)
+     :  m_task { std::forward<Callable>(callable) },
+        m_result { m_task.get_future().share() },
+        m_signal {},
+        m_completion { m_signal.get_future().share() } {}
+
+    auto operator()() -> void override {
+        if (not areDependenciesMet())
+            return;
+
+        m_task();
+        m_signal.set_value();
+        signalCompletion();
+    }
+
+    [[nodiscard]] auto done() const -> bool override { return m_result.wait_for(std::chrono::milliseconds::zero()) == std::future_status::ready; }
+    [[nodiscard]] auto result() const -> std::shared_future<Res> { return m_result; }
+
+private:
+    std::packaged_task<Res()> m_task;
+    std::shared_future<Res> m_result;
+    std::promise<void> m_signal;
+    std::shared_future<void> m_completion;
+};
+
+auto makeTask() -> auto { return makeAtomicTask([] () { return 42; }); }
+auto makeReferenceTask() -> auto { return std::make_unique<ReferenceTask<int>>([] () { return 42; }); }
+
+// Creation, completion and result of a task on a single thread
+template <auto MakeTask>
+auto BM_CompleteTask(benchmark::State& state) -> void {
+    for ([[maybe_unused]] auto _: state) {
+        auto task { MakeTask() };
+        const auto result { task->result() };
+
+        (*task)();
+        benchmark::DoNotOptimize(result.get());
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+// From enqueueing a task to an idle executor until its result is read on the calling thread
+template <auto MakeTask>
+auto BM_EnqueueToResult(benchmark::State& state) -> void {
+    auto scheduler { makeAsyncTaskScheduler(1).value() };
+
+    for ([[maybe_unused]] auto _: state) {
+        auto task { MakeTask() };
+        const auto result { task->result() };
+
+        scheduler->enqueueTask(std::move(task));
+        benchmark::DoNotOptimize(result.get());
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_CompleteTask<makeTask>);
+BENCHMARK(BM_CompleteTask<makeReferenceTask>);
+BENCHMARK(BM_EnqueueToResult<makeTask>)->UseRealTime();
+BENCHMARK(BM_EnqueueToResult<makeReferenceTask>)->UseRealTime();
@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+import task_graph;
+
+using namespace async_task_scheduler;
+
+namespace {
+
+constexpr unsigned int numberOfExecutors { 4 };
+constexpr std::size_t layerCount { 16 };
+
+// Node i of a layer runs after nodes i and i + 1 of the previous one
+auto predecessors(const std::size_t node, const std::size_t width) -> std::array<std::size_t, 2> {
+    return { node, (node + 1) % width };
+}
+
+}
+
+// Argument: nodes per layer. The graph is built once and replayed
+auto BM_TaskGraph(benchmark::State& state) -> void {
+    const auto width { static_cast<std::size_t>(state.range(0)) };
+
+    auto scheduler { makeAsyncTaskScheduler(numberOfExecutors).value() };
+    TaskGraph graph {};
+
+    for (std::size_t layer { 0 }; layer < layerCount; ++layer) {
+        for (std::size_t i { 0 }; i < width; ++i) {
+            const auto node { graph.node([] () {}) };
+
+            if (layer > 0) {
+                for (const auto predecessor: predecessors(i, width)) {
+                    std::ignore = graph.edge((layer - 1) * width + predecessor, node);
+                }
+            }
+        }
+    }
+
+    for ([[maybe_unused]] auto _: state) {
+        graph.run(*scheduler)->wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(layerCount * width));
+}
+
+// The same graph wired edge by edge with dependencies, every run building its tasks again
+auto BM_DependencyTasks(benchmark::State& state) -> void {
+    const auto width { static_cast<std::size_t>(state.range(0)) };
+
+    auto scheduler { makeAsyncTaskScheduler(numberOfExecutors).value() };
+
+    for ([[maybe_unused]] auto _: state) {
+        std::vector<std::unique_ptr<AsyncTask>> tasks {};
+        tasks.reserve(layerCount * width);
+
+        for (std::size_t layer { 0 }; layer < layerCount; ++layer) {
+            for (std::size_t i { 0 }; i < width; ++i) {
+                auto task { makeAtomicTask([] () {}) };
+
+                if (layer > 0) {
+                    for (const auto predecessor: predecessors(i, width)) {
+                        task->dependency(*tasks[(layer - 1) * width + predecessor]);
+                    }
+                }
+
+                tasks.push_back(std::move(task));
+            }
+        }
+
+        std::vector<Dependency> sinks {};
+
+        for (std::size_t i { 0 }; i < width; ++i) {
+            sinks.push_back(tasks[(layerCount - 1) * width + i]->dependency());
+        }
+
+        scheduler->enqueueTasks(std::move(tasks));
+
+        for (const auto& sink: sinks) {
+            sink.wait();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(layerCount * width));
+}
+
+BENCHMARK(BM_TaskGraph)->Arg(4)->Arg(64)->Arg(1'024)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DependencyTasks)->Arg(4)->Arg(64)->Arg(1'024)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct NamedPolicy {
+    std::string_view m_name;
+    IdlePolicy m_policy;
+};
+
+const std::array<NamedPolicy, 4> policies { {
+    { "park", IdlePolicy {} },
+    { "spin", IdlePolicy { 100us, 0ns } },
+    { "yield", IdlePolicy { 0ns, 100us } },
+    { "spin then yield", IdlePolicy { 20us, 200us } }
+} };
+
+auto makeExecutor(const IdlePolicy policy) -> std::unique_ptr<TaskExecutor> {
+    return makeTaskExecutor(Priority::Background, ThreadConfiguration { "idle", {}, std::nullopt, std::nullopt, std::nullopt, policy });
+}
+
+// Enqueues a task flipping the flag and waits for it without sleeping, so that only the wake up of the executor is timed
+auto pingPong(TaskExecutor& executor, std::atomic<std::uint64_t>& rounds) -> std::chrono::steady_clock::duration {
+    const auto round { rounds.load(std::memory_order_relaxed) };
+    const auto enqueuedAt { std::chrono::steady_clock::now() };
+
+    executor.enqueueTask(makeAtomicTask([&rounds] () { rounds.fetch_add(1, std::memory_order_release); }));
+
+    while (rounds.load(std::memory_order_acquire) == round) {
+        std::this_thread::yield();
+    }
+
+    return std::chrono::steady_clock::now() - enqueuedAt;
+}
+
+}
+
+// Arguments: the idle policy, then the microseconds between commands. Latency is from enqueueing a task until it ran,
+// commands closer together than the spinning find the executor awake
+auto BM_PingPongLatency(benchmark::State& state) -> void {
+    const auto& policy { policies[static_cast<std::size_t>(state.range(0))] };
+    const std::chrono::microseconds gap { state.range(1) };
+
+    auto executor { makeExecutor(policy.m_policy) };
+    std::atomic<std::uint64_t> rounds { 0 };
+
+    for ([[maybe_unused]] auto _: state) {
+        std::this_thread::sleep_for(gap);
+        state.SetIterationTime(std::chrono::duration<double> { pingPong(*executor, rounds) }.count());
+    }
+
+    state.SetLabel(std::string { policy.m_name });
+}
+
+// Argument: the idle policy. A command every millisecond, as control commands come while recording. The CPU time is
+// the one of the whole process, the executor thread included: over the time elapsed, the load idling costs
+auto BM_IdleCpu(benchmark::State& state) -> void {
+    const auto& policy { policies[static_cast<std::size_t>(state.range(0))] };
+
+    auto executor { makeExecutor(policy.m_policy) };
+    std::atomic<std::uint64_t> rounds { 0 };
+
+    for ([[maybe_unused]] auto _: state) {
+        std::ignore = pingPong(*executor, rounds);
+        std::this_thread::sleep_for(1ms);
+    }
+
+    state.SetLabel(std::string { policy.m_name });
+}
+
+BENCHMARK(BM_PingPongLatency)->ArgsProduct({ { 0, 1, 2, 3 }, { 0, 50, 500 } })->UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_IdleCpu)->DenseRange(0, 3)->MeasureProcessCPUTime()->UseRealTime()->Unit(benchmark::kMillisecond);
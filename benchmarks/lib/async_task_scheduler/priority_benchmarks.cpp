@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+namespace {
+
+constexpr unsigned int numberOfExecutors { 4 };
+constexpr std::chrono::milliseconds writeLength { 5 };
+
+auto percentile(std::vector<double>& values, const double ratio) -> double {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    const auto index { static_cast<std::size_t>(ratio * static_cast<double>(values.size() - 1)) };
+    std::ranges::nth_element(values, values.begin() + static_cast<std::ptrdiff_t>(index));
+
+    return values[index];
+}
+
+// Stands for the recording writer blocked on a slow disk: enqueues itself again as soon as it is done, until stopped
+auto enqueueWrite(AsyncTaskScheduler& scheduler, const std::atomic_bool& stop, const unsigned int threadId) -> void {
+    scheduler.enqueueTask(makeAtomicTask([&scheduler, &stop, threadId] () {
+        std::this_thread::sleep_for(writeLength);
+
+        if (not stop.load(std::memory_order_relaxed)) {
+            enqueueWrite(scheduler, stop, threadId);
+        }
+    }), threadId);
+}
+
+}
+
+// Arguments: background writes kept in flight, then 0 when control tasks have no priority, 1 when they have one and 2
+// when an executor is also reserved to them. Latency is from enqueueing a control task until its result is read
+auto BM_ControlTaskLatency(benchmark::State& state) -> void {
+    const auto writes { static_cast<unsigned int>(state.range(0)) };
+    const auto lane { state.range(1) };
+
+    auto scheduler { makeAsyncTaskScheduler(numberOfExecutors, lane == 2 ? 1 : 0).value() };
+    std::atomic_bool stop { false };
+    std::vector<double> latencies {};
+
+    for (unsigned int i { 0 }; i < writes; ++i) {
+        enqueueWrite(*scheduler, stop, i % numberOfExecutors);
+    }
+
+    unsigned int threadId { 0 };
+
+    for ([[maybe_unused]] auto _: state) {
+        auto task { makeAtomicTask([] () { return std::chrono::steady_clock::now(); }) };
+        const auto result { task->result() };
+
+        if (lane != 0) {
+            task->priority(Priority::Control);
+        }
+
+        const auto start { std::chrono::steady_clock::now() };
+        scheduler->enqueueTask(std::move(task), threadId++ % numberOfExecutors);
+
+        latencies.push_back(std::chrono::duration<double, std::micro> { result.get() - start }.count());
+    }
+
+    stop = true;
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    state.counters["p50_us"] = percentile(latencies, 0.5);
+    state.counters["p99_us"] = percentile(latencies, 0.99);
+    state.counters["max_us"] = percentile(latencies, 1.0);
+}
+
+BENCHMARK(BM_ControlTaskLatency)->ArgNames({ "writes", "lane" })->ArgsProduct({ { 0, 8, 32 }, { 0, 1, 2 } })
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
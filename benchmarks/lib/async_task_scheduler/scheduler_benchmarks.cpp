@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+namespace {
+
+// 1, 2, 4... executors up to one per core, along with each of the other arguments given
+template <std::int64_t... arguments>
+auto executorCounts(benchmark::internal::Benchmark* benchmark) -> void {
+    const auto cores { std::max(std::thread::hardware_concurrency(), 1u) };
+
+    for (unsigned int executors { 1 }; ; executors = std::min(2 * executors, cores)) {
+        if constexpr (sizeof...(arguments) == 0) {
+            benchmark->Arg(executors);
+        } else {
+            (benchmark->Args({ executors, arguments }), ...);
+        }
+
+        if (executors == cores) {
+            break;
+        }
+    }
+}
+
+auto makeScheduler(const benchmark::State& state) -> std::unique_ptr<AsyncTaskScheduler> {
+    return makeAsyncTaskScheduler(static_cast<unsigned int>(state.range(0))).value();
+}
+
+ResumableTask<void> yieldTimes(const std::int64_t count) {
+    for (std::int64_t i { 0 }; i < count; ++i) {
+        co_await std::suspend_always {};
+    }
+}
+
+// Waits for each task it enqueues, resumed once the task is done
+ResumableTask<void> awaitTasks(AsyncTaskScheduler& scheduler, const std::int64_t count) {
+    for (std::int64_t i { 0 }; i < count; ++i) {
+        auto task { makeAtomicTask([] () {}) };
+        const auto dependency { task->dependency() };
+
+        scheduler.enqueueTask(std::move(task), static_cast<unsigned int>(i) % scheduler.concurrencyLevel());
+        co_await dependency;
+    }
+}
+
+}
+
+// Arguments: executors, then tasks enqueued one by one from a single thread, spread round robin as TaskManager does.
+// Timed until the last one ran
+auto BM_EnqueueThroughput(benchmark::State& state) -> void {
+    const auto taskCount { state.range(1) };
+
+    auto scheduler { makeScheduler(state) };
+
+    for ([[maybe_unused]] auto _: state) {
+        std::latch done { taskCount };
+
+        for (std::int64_t i { 0 }; i < taskCount; ++i) {
+            scheduler->enqueueTask(makeAtomicTask([&done] () { done.count_down(); }),
+                static_cast<unsigned int>(i) % scheduler->concurrencyLevel());
+        }
+
+        done.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * taskCount);
+}
+
+// Argument: executors, idle. From enqueueing a task until its result is read on the calling thread
+auto BM_EnqueueToCompletion(benchmark::State& state) -> void {
+    auto scheduler { makeScheduler(state) };
+
+    for ([[maybe_unused]] auto _: state) {
+        auto task { makeAtomicTask([] () { return 1; }) };
+        const auto result { task->result() };
+
+        scheduler->enqueueTask(std::move(task));
+        benchmark::DoNotOptimize(result.get());
+    }
+}
+
+// Arguments: executors, then length of a chain of tasks, each depending on the previous one. They are enqueued at
+// once, last first, so that most of them wait for their dependency
+auto BM_DependencyChain(benchmark::State& state) -> void {
+    const auto depth { static_cast<std::size_t>(state.range(1)) };
+
+    auto scheduler { makeScheduler(state) };
+    std::vector<std::unique_ptr<AsyncTask>> tasks {};
+
+    for ([[maybe_unused]] auto _: state) {
+        for (std::size_t i { 0 }; i < depth; ++i) {
+            auto task { makeAtomicTask([] () {}) };
+
+            if (i > 0) {
+                task->dependency(*tasks.back());
+            }
+
+            tasks.push_back(std::move(task));
+        }
+
+        const auto last { tasks.back()->dependency() };
+
+        std::ranges::reverse(tasks);
+        scheduler->enqueueTasks(std::span { tasks });
+        tasks.clear();
+
+        last.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// Arguments: executors, then times a coroutine is resumed. 0 when it yields, its executor resuming it on its next round,
+// 1 when it awaits a task it enqueued, the task waking it up
+template <bool awaits>
+auto BM_CoroutineResume(benchmark::State& state) -> void {
+    const auto resumeCount { state.range(1) };
+
+    auto scheduler { makeScheduler(state) };
+
+    for ([[maybe_unused]] auto _: state) {
+        auto task { makeResumableTask(awaits ? awaitTasks(*scheduler, resumeCount) : yieldTimes(resumeCount)) };
+        const auto dependency { task->dependency() };
+
+        scheduler->enqueueTask(std::move(task));
+        dependency.wait();
+    }
+
+    state.SetItemsProcessed(state.iterations() * resumeCount);
+}
+
+// Arguments: executors, then tasks a root task fans out to, joined by a last task depending on all of them
+auto BM_FanOutFanIn(benchmark::State& state) -> void {
+    const auto width { static_cast<std::size_t>(state.range(1)) };
+
+    auto scheduler { makeScheduler(state) };
+    std::vector<std::unique_ptr<AsyncTask>> tasks {};
+    std::atomic<std::uint64_t> sum { 0 };
+
+    for ([[maybe_unused]] auto _: state) {
+        auto root { makeAtomicTask([] () {}) };
+        auto join { makeAtomicTask([] () {}) };
+        const auto joined { join->dependency() };
+
+        for (std::size_t i { 0 }; i < width; ++i) {
+            auto task { makeAtomicTask([&sum, i] () { sum.fetch_add(i, std::memory_order_relaxed); }) };
+
+            task->dependency(*root);
+            join->dependency(*task);
+            tasks.push_back(std::move(task));
+        }
+
+        tasks.push_back(std::move(root));
+        tasks.push_back(std::move(join));
+        scheduler->enqueueTasks(std::span { tasks });
+        tasks.clear();
+
+        joined.wait();
+    }
+
+    benchmark::DoNotOptimize(sum.load(std::memory_order_relaxed));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+BENCHMARK(BM_EnqueueThroughput)->ArgNames({ "executors", "tasks" })->Apply(executorCounts<1'000, 10'000>)
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EnqueueToCompletion)->ArgName("executors")->Apply(executorCounts<>)->UseRealTime();
+BENCHMARK(BM_DependencyChain)->ArgNames({ "executors", "depth" })->Apply(executorCounts<16, 256>)
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CoroutineResume<false>)->ArgNames({ "executors", "resumes" })->Apply(executorCounts<1'000>)
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CoroutineResume<true>)->ArgNames({ "executors", "resumes" })->Apply(executorCounts<1'000>)
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FanOutFanIn)->ArgNames({ "executors", "width" })->Apply(executorCounts<16, 256>)
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+// Previous Timer, a multimap ordered by deadline, given identifiers so that its timers can be cancelled
+class ReferenceTimer final {
+public:
+    ReferenceTimer()
+     :  m_timerAccess {},
+        m_timerChanged {},
+        m_timers {},
+        m_timerIds {},
+        m_nextTimerId { 1 },
+        m_timerThread { [this] (std::stop_token stopHandle) { runTimers(stopHandle); } } {}
+
+    auto schedule(const std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration,
+            std::move_only_function<void()> function) -> TimerId_t {
+        TimerId_t timerId { 0 };
+
+        {
+            std::lock_guard lock { m_timerAccess };
+
+            timerId = m_nextTimerId++;
+            m_timerIds.emplace(timerId, m_timers.emplace(deadline, std::move(function)));
+        }
+
+        m_timerChanged.notify_one();
+        return timerId;
+    }
+
+    auto cancel(const TimerId_t timerId) -> bool {
+        std::lock_guard lock { m_timerAccess };
+
+        const auto timer { m_timerIds.find(timerId) };
+
+        if (timer == m_timerIds.end()) {
+            return false;
+        }
+
+        m_timers.erase(timer->second);
+        m_timerIds.erase(timer);
+
+        return true;
+    }
+
+private:
+    using Timers_t = std::multimap<std::chrono::steady_clock::time_point, std::move_only_function<void()>>;
+
+    auto runTimers(const std::stop_token& stopHandle) -> void {
+        std::unique_lock lock { m_timerAccess };
+
+        while (not stopHandle.stop_requested()) {
+            if (m_timers.empty()) {
+                m_timerChanged.wait(lock, stopHandle, [this] () { return not m_timers.empty(); });
+                continue;
+            }
+
+            const auto deadline { m_timers.begin()->first };
+
+            if (std::chrono::steady_clock::now() < deadline) {
+                m_timerChanged.wait_until(lock, stopHandle, deadline, [this, deadline] () { return m_timers.begin()->first < deadline; });
+                continue;
+            }
+
+            auto function { std::move(m_timers.begin()->second) };
+            std::erase_if(m_timerIds, [this] (const auto& timer) { return timer.second == m_timers.begin(); });
+            m_timers.erase(m_timers.begin());
+
+            lock.unlock();
+            function();
+            lock.lock();
+        }
+    }
+
+    std::mutex m_timerAccess;
+    std::condition_variable_any m_timerChanged;
+    Timers_t m_timers;
+    std::unordered_map<TimerId_t, Timers_t::iterator> m_timerIds;
+    TimerId_t m_nextTimerId;
+    std::jthread m_timerThread;
+};
+
+// Scheduling then cancelling a timer while as many timers as the argument are pending, as a task timing out would
+template <typename TimerType>
+auto BM_ScheduleCancel(benchmark::State& state) -> void {
+    TimerType timer {};
+    std::mt19937 generator { 42 };
+    std::uniform_int_distribution delays { 1, 3'600'000 };
+
+    const auto now { std::chrono::steady_clock::now() };
+
+    for (std::int64_t i { 0 }; i < state.range(0); ++i) {
+        timer.schedule(now + std::chrono::milliseconds { delays(generator) }, std::chrono::steady_clock::duration::zero(), [] () {});
+    }
+
+    for ([[maybe_unused]] auto _: state) {
+        const auto timerId { timer.schedule(now + std::chrono::milliseconds { delays(generator) },
+            std::chrono::steady_clock::duration::zero(), [] () {}) };
+
+        benchmark::DoNotOptimize(timer.cancel(timerId));
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_ScheduleCancel<Timer>)->RangeMultiplier(8)->Range(64, 1 << 18);
+BENCHMARK(BM_ScheduleCancel<ReferenceTimer>)->RangeMultiplier(8)->Range(64, 1 << 18);
@@ -0,0 +1,151 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+constexpr unsigned int numberOfExecutors { 4 };
+constexpr std::size_t numberOfShortTasks { 400 };
+
+// Previous TaskExecutor implementation: every executor runs the tasks enqueued to it and nothing else
+class RoundRobinExecutor final {
+public:
+    RoundRobinExecutor()
+     :  m_tasks {},
+        m_pendingTasks {},
+        m_taskAccess {},
+        m_taskAvailable {},
+        m_taskExecutor { [this] (std::stop_token stopHandle) { executeTasks(stopHandle); } } {}
+
+    auto enqueueTask(std::unique_ptr<AsyncTask> task) -> void {
+        {
+            std::lock_guard lock(m_taskAccess);
+            m_tasks.emplace_back(std::move(task));
+        }
+
+        m_taskAvailable.notify_one();
+    }
+
+private:
+    auto executeTasks(const std::stop_token& stopHandle) -> void {
+        do {
+            {
+                std::unique_lock lock(m_taskAccess);
+
+                if (m_tasks.empty()) {
+                    m_taskAvailable.wait(lock, stopHandle, [this, &stopHandle] () { return not m_tasks.empty() || stopHandle.stop_requested(); });
+                }
+
+                m_pendingTasks.swap(m_tasks);
+            }
+
+            for (auto& task : m_pendingTasks) {
+                (*task)();
+            }
+
+            std::erase_if(m_pendingTasks, [] (const std::unique_ptr<AsyncTask>& task) { return task->done(); });
+
+            {
+                std::unique_lock lock(m_taskAccess);
+
+                m_tasks.insert(std::ranges::end(m_tasks),
+                    std::make_move_iterator(std::ranges::begin(m_pendingTasks)),
+                    std::make_move_iterator(std::ranges::end(m_pendingTasks)));
+            }
+
+            m_pendingTasks.clear();
+        } while (not stopHandle.stop_requested());
+    }
+
+    std::vector<std::unique_ptr<AsyncTask>> m_tasks;
+    std::vector<std::unique_ptr<AsyncTask>> m_pendingTasks;
+    std::mutex m_taskAccess;
+    std::condition_variable_any m_taskAvailable;
+    std::jthread m_taskExecutor;
+};
+
+class RoundRobinScheduler final {
+public:
+    explicit RoundRobinScheduler(const unsigned int concurrencyLevel) :  m_executors {} {
+        for (unsigned int i { 0 }; i < concurrencyLevel; ++i) {
+            m_executors.push_back(std::make_unique<RoundRobinExecutor>());
+        }
+    }
+
+    auto enqueueTask(std::unique_ptr<AsyncTask> task, const unsigned int threadId) -> void {
+        m_executors[threadId]->enqueueTask(std::move(task));
+    }
+
+private:
+    std::vector<std::unique_ptr<RoundRobinExecutor>> m_executors;
+};
+
+auto spinFor(const std::chrono::nanoseconds duration) -> void {
+    const auto end { std::chrono::steady_clock::now() + duration };
+
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+auto percentile(std::vector<double>& values, const double ratio) -> double {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    const auto index { static_cast<std::size_t>(ratio * static_cast<double>(values.size() - 1)) };
+    std::ranges::nth_element(values, values.begin() + static_cast<std::ptrdiff_t>(index));
+
+    return values[index];
+}
+
+// Arguments: length of the long task in microseconds, 0 for none. Short tasks are spread round robin as TaskManager does,
+// so a quarter of them is queued behind the long task
+template <typename Scheduler>
+auto BM_SkewedWorkload(benchmark::State& state) -> void {
+    const auto longTaskLength { std::chrono::microseconds { state.range(0) } };
+
+    Scheduler scheduler { numberOfExecutors };
+    std::vector<double> latencies {};
+
+    for ([[maybe_unused]] auto _: state) {
+        std::vector<std::chrono::steady_clock::time_point> completions(numberOfShortTasks);
+        std::vector<Dependency> dependencies {};
+        dependencies.reserve(numberOfShortTasks + 1);
+
+        unsigned int threadId { 0 };
+
+        if (longTaskLength.count() != 0) {
+            auto longTask { makeAtomicTask([longTaskLength] () { spinFor(longTaskLength); }) };
+            dependencies.push_back(longTask->dependency());
+            scheduler.enqueueTask(std::move(longTask), threadId++ % numberOfExecutors);
+        }
+
+        const auto start { std::chrono::steady_clock::now() };
+
+        for (std::size_t i { 0 }; i < numberOfShortTasks; ++i) {
+            auto task { makeAtomicTask([&completions, i] () {
+                spinFor(std::chrono::microseconds { 5 });
+                completions[i] = std::chrono::steady_clock::now();
+            }) };
+
+            dependencies.push_back(task->dependency());
+            scheduler.enqueueTask(std::move(task), threadId++ % numberOfExecutors);
+        }
+
+        for (const auto& dependency: dependencies) {
+            dependency.wait();
+        }
+
+        for (const auto completion: completions) {
+            latencies.push_back(std::chrono::duration<double, std::micro> { completion - start }.count());
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(numberOfShortTasks));
+    state.counters["p50_us"] = percentile(latencies, 0.5);
+    state.counters["p99_us"] = percentile(latencies, 0.99);
+    state.counters["max_us"] = percentile(latencies, 1.0);
+}
+
+BENCHMARK(BM_SkewedWorkload<AsyncTaskScheduler>)->Arg(0)->Arg(2000)->Arg(20000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SkewedWorkload<RoundRobinScheduler>)->Arg(0)->Arg(2000)->Arg(20000)->UseRealTime()->Unit(benchmark::kMicrosecond);
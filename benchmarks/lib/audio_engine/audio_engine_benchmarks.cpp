@@ -0,0 +1,275 @@
+#include <benchmark/benchmark.h>
+
+import std;
+import audio_engine;
+import audio_writer;
+
+using namespace audio_engine;
+
+namespace {
+
+constexpr audio_device::SampleRate_t sampleRate { 48000 };
+
+auto makeSamples(const std::size_t count) -> std::vector<float> {
+    std::mt19937 generator { 42 };
+    std::uniform_real_distribution distribution { -1.0f, 1.0f };
+
+    std::vector<float> samples(count);
+    std::ranges::generate(samples, [&] () { return distribution(generator); });
+
+    return samples;
+}
+
+auto makeFilledBuffer(const audio_device::ChannelCount_t channels, const audio_stream_params::BufferLength_t frames) -> std::unique_ptr<audio_buffer::AudioBuffer<float>> {
+    auto buffer { audio_buffer::makeAudioBuffer<float>(channels, frames) };
+    const auto samples { makeSamples(std::size_t { channels } * frames) };
+
+    buffer->copyFromRawBuffer(samples.data(), channels, frames, false);
+
+    return buffer;
+}
+
+auto channelCount(const benchmark::State& state) -> audio_device::ChannelCount_t {
+    return static_cast<audio_device::ChannelCount_t>(state.range(0));
+}
+
+auto frameCount(const benchmark::State& state) -> audio_stream_params::BufferLength_t {
+    return static_cast<audio_stream_params::BufferLength_t>(state.range(1));
+}
+
+// Time per frame whatever the buffer length, and how many times faster than the audio plays at 48 kHz: the callback
+// path has to stay well above 1
+auto reportFrames(benchmark::State& state) -> void {
+    const auto frames { static_cast<double>(state.range(1)) };
+
+    state.counters["ns/frame"] = benchmark::Counter { frames * 1e-9, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert };
+    state.counters["realtime"] = benchmark::Counter { frames / sampleRate, benchmark::Counter::kIsIterationInvariantRate };
+}
+
+// Arguments: channel count, frames per buffer
+template <std::int64_t... channelCounts>
+auto audioArguments(benchmark::internal::Benchmark* benchmark) -> void {
+    benchmark->ArgNames({ "channels", "frames" });
+
+    for (const auto channels: { channelCounts... }) {
+        for (const auto frames: { 256, 1024, 4096 }) {
+            benchmark->Args({ channels, frames });
+        }
+    }
+}
+
+// Stands for the device: gives the engine an input of 2 and one of 8 channels, and a stereo output, the benchmark
+// calling the engine in place of the audio thread
+class BenchmarkAudioLibraryWrapper final: public audio_library_wrapper::AudioLibraryWrapper {
+public:
+    BenchmarkAudioLibraryWrapper(const audio_library_wrapper::LogCallback& logCallback, [[maybe_unused]] const audio_driver::AudioDriver audioDriver)
+     :  AudioLibraryWrapper { logCallback } {}
+
+    auto probeDevices() -> std::expected<std::vector<std::unique_ptr<const audio_device::AudioDevice>>, std::string> override {
+        std::vector<std::unique_ptr<const audio_device::AudioDevice>> devices {};
+
+        for (const audio_device::ChannelCount_t channels: { 2u, 8u }) {
+            devices.push_back(makeDevice(static_cast<int>(channels), inputName(channels), audio_device::AudioDeviceType::Input, channels));
+        }
+
+        devices.push_back(makeDevice(0, "output", audio_device::AudioDeviceType::Output, 2));
+
+        return devices;
+    }
+
+    auto audioDriver() const -> std::expected<audio_driver::AudioDriver, std::string> override { return audio_driver::availableAudioDrivers[0]; }
+    auto openStream([[maybe_unused]] const audio_stream_params::AudioStreamParams& audioStreamParams,
+        [[maybe_unused]] const audio_library_wrapper::AudioCallback& audioCallback) -> bool override { return true; }
+    auto closeStream() -> void override {}
+    auto startStream() -> bool override { return true; }
+    auto stopStream() -> bool override { return true; }
+    auto isStreamOpen() const -> bool override { return false; }
+    auto isStreamRunning() const -> bool override { return false; }
+
+    [[nodiscard]] static auto inputName(const audio_device::ChannelCount_t channels) -> std::string { return std::format("input {}", channels); }
+
+private:
+    [[nodiscard]] static auto makeDevice(const int id, std::string name, const audio_device::AudioDeviceType type,
+            const audio_device::ChannelCount_t channels) -> std::unique_ptr<const audio_device::AudioDevice> {
+        return audio_device::makeAudioDevice(audio_device::DeviceId { id }, std::move(name), false, type,
+            std::vector { audio_device::NativeDataFormat { audio_format::AudioFormat::Float32, channels, sampleRate, 0 } }).value();
+    }
+};
+
+class BenchmarkAudioEngine final: public AudioEngine<BenchmarkAudioLibraryWrapper> {
+public:
+    BenchmarkAudioEngine() : AudioEngine { nullptr } {}
+
+    using AudioEngine::process;
+};
+
+}
+
+auto BM_AudioBufferCopy(benchmark::State& state) -> void {
+    const auto source { makeFilledBuffer(channelCount(state), frameCount(state)) };
+    auto destination { audio_buffer::makeAudioBuffer<float>(channelCount(state), frameCount(state)) };
+
+    for ([[maybe_unused]] auto _: state) {
+        *destination = *source;
+        benchmark::ClobberMemory();
+    }
+
+    reportFrames(state);
+}
+
+// Both ways, as the ring buffers do
+auto BM_AudioBufferInterleave(benchmark::State& state) -> void {
+    const auto channels { channelCount(state) };
+    const auto frames { frameCount(state) };
+
+    const auto source { makeFilledBuffer(channels, frames) };
+    auto destination { audio_buffer::makeAudioBuffer<float>(channels, frames) };
+    std::vector<float> interleaved(std::size_t { channels } * frames);
+
+    for ([[maybe_unused]] auto _: state) {
+        source->writeToRawBuffer(interleaved.data(), channels, frames, true);
+        destination->copyFromRawBuffer(interleaved.data(), channels, frames, true);
+        benchmark::ClobberMemory();
+    }
+
+    reportFrames(state);
+}
+
+// Minimum, maximum and RMS of every channel, as the callback computes them for the meters
+auto BM_AudioBufferStats(benchmark::State& state) -> void {
+    const auto buffer { makeFilledBuffer(channelCount(state), frameCount(state)) };
+
+    for ([[maybe_unused]] auto _: state) {
+        for (audio_device::ChannelCount_t channel { 0 }; channel < buffer->numberOfChannels(); ++channel) {
+            benchmark::DoNotOptimize(buffer->computeStats(channel));
+        }
+    }
+
+    reportFrames(state);
+}
+
+// Channels: 1 for a mono channel, 2 for a stereo one
+auto BM_MixerChannelProcess(benchmark::State& state) -> void {
+    const auto input { makeFilledBuffer(channelCount(state), frameCount(state)) };
+    auto processed { audio_buffer::makeAudioBuffer<float>(2, frameCount(state)) };
+    auto mixerChannel { audio_mixer::makeMixerChannel<float>("benchmark", 0.5f) };
+
+    const auto inputView { input->view(0, channelCount(state) == 2 ? std::optional<audio_device::ChannelCount_t> { 1 } : std::nullopt) };
+    const auto processedView { processed->view(0, 1) };
+
+    for ([[maybe_unused]] auto _: state) {
+        mixerChannel->process(inputView, processedView);
+        benchmark::ClobberMemory();
+    }
+
+    reportFrames(state);
+}
+
+// Channels: 1 for a mono input, 2 for a stereo one, mixed into a stereo output
+auto BM_AudioMixerMix(benchmark::State& state) -> void {
+    const auto input { makeFilledBuffer(channelCount(state), frameCount(state)) };
+    auto output { audio_buffer::makeAudioBuffer<float>(2, frameCount(state)) };
+
+    const auto inputView { input->view(0, channelCount(state) == 2 ? std::optional<audio_device::ChannelCount_t> { 1 } : std::nullopt) };
+    const auto outputView { output->view(0, 1) };
+
+    for ([[maybe_unused]] auto _: state) {
+        audio_mixer::AudioMixer<float>::mix(inputView, outputView);
+        benchmark::ClobberMemory();
+    }
+
+    reportFrames(state);
+}
+
+// A buffer in and out each time, the ring never filling up
+auto BM_RingAudioBuffer(benchmark::State& state) -> void {
+    const auto source { makeFilledBuffer(channelCount(state), frameCount(state)) };
+    auto destination { audio_buffer::makeAudioBuffer<float>(channelCount(state), frameCount(state)) };
+    auto ring { ring_audio_buffer::makeRingAudioBuffer<float>(channelCount(state), sampleRate).value() };
+
+    for ([[maybe_unused]] auto _: state) {
+        benchmark::DoNotOptimize(ring->enqueue(*source));
+        benchmark::DoNotOptimize(ring->dequeue(*destination));
+    }
+
+    reportFrames(state);
+}
+
+// Into a file of the temporary directory, encoding and disk writes included
+template <audio_format::AudioFormat format, audio_format::EncodingFormat encoding>
+auto BM_AudioWriter(benchmark::State& state) -> void {
+    const auto channels { channelCount(state) };
+    const auto fileName { (std::filesystem::temp_directory_path() / std::format("audio-writer-benchmark-{}", std::to_underlying(format))).string() };
+
+    const auto buffer { makeFilledBuffer(channels, frameCount(state)) };
+    const auto view { buffer->view(0, channels == 2 ? std::optional<audio_device::ChannelCount_t> { 1 } : std::nullopt) };
+
+    {
+        auto writer { audio_recorder::makeAudioWriter<format>(fileName, sampleRate, channels, encoding).value() };
+        writer->reserve(frameCount(state));
+
+        for ([[maybe_unused]] auto _: state) {
+            benchmark::DoNotOptimize(writer->write(view));
+        }
+    }
+
+    for (const auto extension: { ".wav", ".flac" }) {
+        std::filesystem::remove(fileName + extension);
+    }
+
+    reportFrames(state);
+}
+
+// Channels: 2 or 8 input channels, each routed to the stereo output. What the audio thread runs on each callback,
+// with the pre-roll capturing into the ring buffers
+auto BM_AudioEngineProcess(benchmark::State& state) -> void {
+    constexpr std::size_t callbacksPerTrim { 16 };
+
+    const auto channels { channelCount(state) };
+    const auto frames { frameCount(state) };
+
+    BenchmarkAudioEngine engine {};
+
+    if (not engine.probeDevices().has_value() or not engine.preRoll(std::chrono::seconds { 1 }).has_value()
+            or not engine.startStream(BenchmarkAudioLibraryWrapper::inputName(channels), "output", frames).has_value()) {
+        state.SkipWithError("Could not start the stream");
+        return;
+    }
+
+    for (audio_device::ChannelCount_t channel { 0 }; channel < channels; ++channel) {
+        engine.audioMixer()->inputRouting({ audio_mixer::ChannelRouting { static_cast<audio_mixer::Routing_t>(channel) }, audio_mixer::ChannelRouting { 0, 1 } }, channel);
+    }
+
+    engine.audioMixer()->outputRouting(audio_mixer::ChannelRouting { 0, 1 }, 0);
+
+    const auto input { makeFilledBuffer(channels, frames) };
+    auto output { audio_buffer::makeAudioBuffer<float>(2, frames) };
+    std::size_t callbacks { 0 };
+
+    for ([[maybe_unused]] auto _: state) {
+        output->clear();
+        engine.process(*input, *output);
+
+        // As the consumer does, so that the rings never overrun
+        if (++callbacks % callbacksPerTrim == 0) {
+            std::ignore = engine.trimPreRoll();
+        }
+    }
+
+    reportFrames(state);
+}
+
+BENCHMARK(BM_AudioBufferCopy)->Apply(audioArguments<1, 2, 8>);
+BENCHMARK(BM_AudioBufferInterleave)->Apply(audioArguments<1, 2, 8>);
+BENCHMARK(BM_AudioBufferStats)->Apply(audioArguments<1, 2, 8>);
+BENCHMARK(BM_MixerChannelProcess)->Apply(audioArguments<1, 2>);
+BENCHMARK(BM_AudioMixerMix)->Apply(audioArguments<1, 2>);
+BENCHMARK(BM_RingAudioBuffer)->Apply(audioArguments<1, 2, 8>);
+
+BENCHMARK(BM_AudioWriter<audio_format::AudioFormat::SignedInt16, audio_format::EncodingFormat::Wav>)->Apply(audioArguments<1, 2>);
+BENCHMARK(BM_AudioWriter<audio_format::AudioFormat::SignedInt24, audio_format::EncodingFormat::Wav>)->Apply(audioArguments<1, 2>);
+BENCHMARK(BM_AudioWriter<audio_format::AudioFormat::Float32, audio_format::EncodingFormat::Wav>)->Apply(audioArguments<1, 2>);
+BENCHMARK(BM_AudioWriter<audio_format::AudioFormat::SignedInt16, audio_format::EncodingFormat::Flac>)->Apply(audioArguments<1, 2>);
+BENCHMARK(BM_AudioWriter<audio_format::AudioFormat::SignedInt24, audio_format::EncodingFormat::Flac>)->Apply(audioArguments<1, 2>);
+
+BENCHMARK(BM_AudioEngineProcess)->ArgNames({ "channels", "frames" })->ArgsProduct({ { 2, 8 }, { 1024, 4096 } });
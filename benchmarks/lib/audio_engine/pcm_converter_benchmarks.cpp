@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <miniaudio.h>
+
+import std;
+import audio_format;
+import audio_buffer;
+import pcm_converter;
+
+using namespace audio_engine;
+
+auto makeSamples(const std::size_t count) -> std::vector<float> {
+    std::mt19937 generator { 42 };
+    std::uniform_real_distribution distribution { -1.0f, 1.0f };
+
+    std::vector<float> samples(count);
+    std::ranges::generate(samples, [&] () { return distribution(generator); });
+
+    return samples;
+}
+
+// Arguments: channel count (1 or 2), frames per write
+auto pcmConverterArguments(benchmark::internal::Benchmark* benchmark) -> void {
+    for (const auto channels: { 1, 2 }) {
+        for (const auto frames: { 256, 2048, 16384 }) {
+            benchmark->Args({ channels, frames });
+        }
+    }
+}
+
+template <audio_format::AudioFormat format>
+auto BM_PcmConverter(benchmark::State& state) -> void {
+    const auto channels { static_cast<std::size_t>(state.range(0)) };
+    const auto frames { static_cast<std::size_t>(state.range(1)) };
+
+    const auto left { makeSamples(frames) };
+    const auto right { channels == 2 ? makeSamples(frames) : std::vector<float> {} };
+    const audio_buffer::ReadOnlyAudioBufferView<float> view { audio_buffer::AudioChannel<const float> { left }, audio_buffer::AudioChannel<const float> { right } };
+
+    std::vector<pcm_converter::PcmSample_t<format>> output(pcm_converter::outputSize<format>(frames, channels));
+    pcm_converter::TpdfDither dither {};
+
+    for ([[maybe_unused]] auto _: state) {
+        benchmark::DoNotOptimize(pcm_converter::convert<format>(view, output, dither));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(frames));
+}
+
+// Previous AudioWriterWithFormat implementation: clear, interleave, clear, convert with miniaudio
+template <audio_format::AudioFormat format>
+auto BM_PcmConverterMiniaudioReference(benchmark::State& state) -> void {
+    const auto channels { static_cast<std::size_t>(state.range(0)) };
+    const auto frames { static_cast<std::size_t>(state.range(1)) };
+
+    const auto left { makeSamples(frames) };
+    const auto right { channels == 2 ? makeSamples(frames) : std::vector<float> {} };
+
+    std::vector<float> interleaved {};
+    std::vector<pcm_converter::PcmSample_t<format>> output {};
+
+    for ([[maybe_unused]] auto _: state) {
+        interleaved.resize(frames * channels);
+        std::ranges::fill(interleaved, 0.0f);
+
+        if (channels == 1) {
+            std::ranges::copy(left, std::ranges::begin(interleaved));
+        } else {
+            for (std::size_t i { 0 }; i < frames; ++i) {
+                interleaved[i * 2] = left[i];
+                interleaved[i * 2 + 1] = right[i];
+            }
+        }
+
+        output.resize(pcm_converter::outputSize<format>(frames, channels));
+        std::ranges::fill(output, static_cast<pcm_converter::PcmSample_t<format>>(0));
+
+        ma_convert_pcm_frames_format(output.data(), audio_format::toMaFormat(format).value(), interleaved.data(), ma_format_f32,
+            frames, static_cast<ma_uint32>(channels), ma_dither_mode_triangle);
+
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(frames));
+}
+
+BENCHMARK(BM_PcmConverter<audio_format::AudioFormat::SignedInt16>)->Apply(pcmConverterArguments);
+BENCHMARK(BM_PcmConverter<audio_format::AudioFormat::SignedInt24>)->Apply(pcmConverterArguments);
+BENCHMARK(BM_PcmConverter<audio_format::AudioFormat::Float32>)->Apply(pcmConverterArguments);
+
+BENCHMARK(BM_PcmConverterMiniaudioReference<audio_format::AudioFormat::SignedInt16>)->Apply(pcmConverterArguments);
+BENCHMARK(BM_PcmConverterMiniaudioReference<audio_format::AudioFormat::SignedInt24>)->Apply(pcmConverterArguments);
+BENCHMARK(BM_PcmConverterMiniaudioReference<audio_format::AudioFormat::Float32>)->Apply(pcmConverterArguments);
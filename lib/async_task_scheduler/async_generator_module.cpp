@@ -0,0 +1,316 @@
+export module async_generator;
+
+import std;
+
+import shared_state;
+import async_task;
+import result;
+import awaitables;
+
+namespace async_task_scheduler {
+
+// Bounded queue between a generator and the coroutine reading its stream, one of each. Either side waiting is suspended
+// and woken up by the other, no thread blocks. The producer finding the queue full leaves its value to be queued by the
+// consumer making room, so that it goes on without queuing again
+template <typename T>
+class Channel final {
+public:
+    Channel()
+     :  m_mutex {},
+        m_values {},
+        m_pending { std::nullopt },
+        m_capacity { 1 },
+        m_receiving { false },
+        m_closed { false },
+        m_exception {},
+        m_producer { nullptr },
+        m_consumer { nullptr } {}
+
+    auto capacity(const std::size_t capacity) -> void {
+        std::lock_guard lock { m_mutex };
+        m_capacity = std::max<std::size_t>(capacity, 1);
+    }
+
+    auto receive(const bool receiving) -> void {
+        std::unique_lock lock { m_mutex };
+        m_receiving = receiving;
+
+        if (receiving) {
+            return;
+        }
+
+        // Nobody reads any more, a waiting producer goes on to find it out
+        m_consumer = nullptr;
+        m_values.clear();
+        m_pending.reset();
+        const auto producer { std::exchange(m_producer, nullptr) };
+        lock.unlock();
+
+        if (producer != nullptr) {
+            producer->wake();
+        }
+    }
+
+    [[nodiscard]] auto receiving() const -> bool {
+        std::lock_guard lock { m_mutex };
+        return m_receiving;
+    }
+
+    // True when the producer has to wait for room, it is then suspended. Values nobody reads are dropped
+    [[nodiscard]] auto push(T&& value, AsyncTask& producer) -> bool {
+        std::unique_lock lock { m_mutex };
+
+        if (not m_receiving) {
+            return false;
+        }
+
+        if (m_values.size() >= m_capacity) {
+            producer.suspend();
+            m_pending.emplace(std::move(value));
+            m_producer = &producer;
+            return true;
+        }
+
+        m_values.push_back(std::move(value));
+        const auto consumer { std::exchange(m_consumer, nullptr) };
+        lock.unlock();
+
+        if (consumer != nullptr) {
+            consumer->wake();
+        }
+
+        return false;
+    }
+
+    // Once closed, the consumer takes what is left then the end, or the exception ending the producer
+    auto close(std::exception_ptr exception = {}) -> void {
+        std::unique_lock lock { m_mutex };
+
+        if (m_closed) {
+            return;
+        }
+
+        m_closed = true;
+        m_producer = nullptr;
+        m_pending.reset();
+        m_exception = std::move(exception);
+        const auto consumer { std::exchange(m_consumer, nullptr) };
+        lock.unlock();
+
+        if (consumer != nullptr) {
+            consumer->wake();
+        }
+    }
+
+    // True when the consumer has to wait for a value or the end, it is then suspended
+    [[nodiscard]] auto wait(AsyncTask& consumer) -> bool {
+        std::lock_guard lock { m_mutex };
+
+        if (not m_values.empty() or m_closed) {
+            return false;
+        }
+
+        consumer.suspend();
+        m_consumer = &consumer;
+        return true;
+    }
+
+    [[nodiscard]] auto take() -> std::optional<T> {
+        std::unique_lock lock { m_mutex };
+
+        if (m_values.empty()) {
+            if (m_exception) {
+                const auto exception { m_exception };
+                lock.unlock();
+                std::rethrow_exception(exception);
+            }
+
+            return std::nullopt;
+        }
+
+        std::optional<T> value { std::move(m_values.front()) };
+        m_values.pop_front();
+
+        const auto producer { std::exchange(m_producer, nullptr) };
+
+        if (producer != nullptr) {
+            m_values.push_back(std::move(*m_pending));
+            m_pending.reset();
+        }
+
+        lock.unlock();
+
+        if (producer != nullptr) {
+            producer->wake();
+        }
+
+        return value;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::deque<T> m_values;
+    std::optional<T> m_pending;
+    std::size_t m_capacity;
+    bool m_receiving;
+    bool m_closed;
+    std::exception_ptr m_exception;
+    AsyncTask* m_producer;
+    AsyncTask* m_consumer;
+};
+
+template <typename T>
+class YieldAwaiter final {
+public:
+    YieldAwaiter(Channel<T>& channel, T&& value) :  m_channel { channel }, m_value { std::move(value) } {}
+
+    static auto await_ready() -> bool { return false; }
+
+    template <TaskPromise Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> bool {
+        return m_channel.push(std::move(m_value), *handle.promise().m_task);
+    }
+
+    // False once nobody reads the stream, the generator should end
+    auto await_resume() const -> bool { return m_channel.receiving(); }
+
+private:
+    Channel<T>& m_channel;
+    T m_value;
+};
+
+export template <typename T>
+class NextAwaiter final {
+public:
+    explicit NextAwaiter(Channel<T>& channel) :  m_channel { channel } {}
+
+    static auto await_ready() -> bool { return false; }
+
+    template <TaskPromise Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> bool {
+        return m_channel.wait(*handle.promise().m_task);
+    }
+
+    auto await_resume() const -> std::optional<T> { return m_channel.take(); }
+
+private:
+    Channel<T>& m_channel;
+};
+
+// Values of a generator, read by one coroutine running as a task. Destroying it tells the generator nobody reads any more
+export template <typename T>
+class AsyncStream final {
+public:
+    explicit AsyncStream(std::shared_ptr<Channel<T>> channel) :  m_channel { std::move(channel) } { m_channel->receive(true); }
+    AsyncStream(AsyncStream&& other) noexcept :  m_channel { std::move(other.m_channel) } {}
+    ~AsyncStream() { if (m_channel) m_channel->receive(false); }
+
+    AsyncStream(const AsyncStream&) = delete;
+    AsyncStream& operator=(const AsyncStream&) = delete;
+    AsyncStream& operator=(AsyncStream&&) = delete;
+
+    // The next value, empty once the generator returned. Rethrows the exception ending it, an operation cancelled or
+    // timed out error when it was stopped
+    [[nodiscard]] auto next() const -> NextAwaiter<T> { return NextAwaiter<T> { *m_channel }; }
+
+private:
+    std::shared_ptr<Channel<T>> m_channel;
+};
+
+template <typename T>
+struct async_generator_promise;
+
+// Coroutine task handing what it yields to the coroutine reading its stream, usually on another executor. It runs ahead
+// by at most capacity values, then waits for the reader to take one, so a slow stage holds back the ones before it.
+// Stages are chained by generators reading the stream of the previous one, e.g. taken as a parameter.
+// co_yield is false once nobody reads the stream, or before it is taken, the generator should then end
+export template <typename T>
+class AsyncGenerator final: public AsyncTask {
+public:
+    using promise_type = async_generator_promise<T>;
+
+    explicit AsyncGenerator(std::coroutine_handle<promise_type> handle) :  AsyncTask { handle.promise().m_state }, m_handle { handle } {}
+    AsyncGenerator(AsyncGenerator&& other) noexcept :  AsyncTask { std::move(other) }, m_handle { std::exchange(other.m_handle, nullptr) } {}
+
+    // Destroyed before its end, e.g. never run, its stream ends with an operation cancelled error
+    ~AsyncGenerator() {
+        if (m_handle) {
+            stop(std::errc::operation_canceled);
+        }
+    }
+
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(AsyncGenerator&&) = delete;
+
+    [[nodiscard]] auto done() const -> bool override { return not m_handle or m_handle.done(); };
+
+    auto operator()() -> void override {
+        if (done() or not areDependenciesMet() or suspended())
+            return;
+
+        if (const auto reason { stopReason() }) {
+            stop(*reason);
+            signalStop(*reason);
+            return;
+        }
+
+        m_handle.promise().m_task = this;
+
+        m_handle.resume();
+
+        if (m_handle.done()) {
+            m_handle.promise().m_channel->close(m_handle.promise().m_exception);
+            signalCompletion();
+        }
+    }
+
+    // Before the task is enqueued, at least one
+    auto capacity(const std::size_t capacity) const -> void { m_handle.promise().m_channel->capacity(capacity); }
+
+    // Once, before the task is enqueued
+    [[nodiscard]] auto stream() const -> AsyncStream<T> { return AsyncStream<T> { m_handle.promise().m_channel }; }
+
+    [[nodiscard]] auto result() const -> Result<void> { return Result<void> { m_handle.promise().m_state }; };
+
+private:
+    // The frame goes before the reader goes on, as what its locals refer to may go along with the reader
+    auto stop(const std::errc reason) -> void {
+        const auto channel { m_handle.promise().m_channel };
+        std::exchange(m_handle, nullptr).destroy();
+
+        channel->close(std::make_exception_ptr(std::system_error { std::make_error_code(reason) }));
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+template <typename T>
+struct async_generator_promise {
+    async_generator_promise() :  m_state { makeSharedState<void>() }, m_channel { std::make_shared<Channel<T>>() }, m_exception {}, m_task { nullptr } {}
+
+    auto get_return_object() noexcept -> AsyncGenerator<T> { return AsyncGenerator<T> { std::coroutine_handle<async_generator_promise>::from_promise(*this) }; }
+
+    static auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+    static auto final_suspend() noexcept -> std::suspend_always { return {}; }
+
+    auto unhandled_exception() noexcept -> void {
+        m_exception = std::current_exception();
+        m_state->setException(m_exception);
+    }
+
+    static auto return_void() -> void {}
+
+    auto yield_value(T value) -> YieldAwaiter<T> { return YieldAwaiter<T> { *m_channel, std::move(value) }; }
+
+    StateReference<SharedState<void>> m_state;
+    std::shared_ptr<Channel<T>> m_channel;
+    std::exception_ptr m_exception;
+    AsyncTask* m_task;
+};
+
+export template <typename T>
+[[nodiscard]] auto makeAsyncGenerator(AsyncGenerator<T>&& generator) -> auto {
+    return std::make_unique<AsyncGenerator<T>>(std::forward<AsyncGenerator<T>>(generator));
+}
+
+}
@@ -2,41 +2,200 @@ export module async_task;
 
 import std;
 
+import shared_state;
 import signal;
 import dependency;
+import task_pool;
 
 namespace async_task_scheduler {
 
+// Control tasks, such as the ones answering the user, run before background tasks such as writing recordings
+export enum class Priority : std::uint8_t { Control, Background };
+
 export class AsyncTask {
 public:
-    AsyncTask() :  m_signal {}, m_dependencies {} {}
-    AsyncTask(AsyncTask&&) = default;
+    AsyncTask() :  AsyncTask { Signal {} } {}
+    explicit AsyncTask(StateReference<SharedStateBase> state) :  AsyncTask { Signal { std::move(state) } } {}
+
+    AsyncTask(AsyncTask&& other) noexcept
+     :  m_signal { std::move(other.m_signal) },
+        m_dependencies { std::move(other.m_dependencies) },
+        m_priority { other.m_priority },
+        m_enqueuedAt { other.m_enqueuedAt },
+        m_stopToken { std::move(other.m_stopToken) },
+        m_deadline { other.m_deadline },
+        m_metDependencies { other.m_metDependencies },
+        m_suspension { other.m_suspension.load(std::memory_order_relaxed) },
+        m_onReady {},
+        m_handOver { std::move(other.m_handOver) },
+        m_dependencyContinuation { *this } {}
 
     AsyncTask(const AsyncTask&) = delete;
     AsyncTask& operator=(const AsyncTask&) = delete;
 
     virtual ~AsyncTask() = default;
 
+    // Usually made on one thread and destroyed on an executor, recycled rather than going back to the heap
+    [[nodiscard]] static auto operator new(const std::size_t size) -> void* { return TaskPool::allocate(size); }
+    [[nodiscard]] static auto operator new(const std::size_t size, const std::align_val_t alignment) -> void* { return TaskPool::allocate(size, alignment); }
+    static auto operator delete(void* task, const std::size_t size) noexcept -> void { TaskPool::deallocate(task, size); }
+    static auto operator delete(void* task, const std::size_t size, const std::align_val_t alignment) noexcept -> void {
+        TaskPool::deallocate(task, size, alignment);
+    }
+
     virtual auto operator()() -> void = 0;
     [[nodiscard]] virtual auto done() const -> bool = 0;
 
     [[nodiscard]] auto dependency() const -> Dependency { return Dependency { m_signal }; }
     auto dependency(const AsyncTask& task) -> void { m_dependencies.push_back(task.dependency()); }
 
+    // Before the task is enqueued
+    auto priority(const Priority priority) -> void { m_priority = priority; }
+    [[nodiscard]] auto priority() const -> Priority { return m_priority; }
+
+    // Set by executors each time it is queued to run, for telemetry
+    auto enqueuedAt(const std::chrono::steady_clock::time_point timePoint) -> void { m_enqueuedAt = timePoint; }
+    [[nodiscard]] auto enqueuedAt() const -> std::chrono::steady_clock::time_point { return m_enqueuedAt; }
+
+    // Before the task is enqueued. Checked each time it is about to run: once stop is requested, past the deadline or
+    // when a dependency was stopped, the task completes with an operation cancelled or timed out error instead.
+    // A coroutine is stopped at a suspension point, its frame destroyed without being resumed
+    auto cancellation(std::stop_token stopToken) -> void { m_stopToken = std::move(stopToken); }
+    [[nodiscard]] auto cancellation() const -> const std::stop_token& { return m_stopToken; }
+
+    auto deadline(const std::chrono::steady_clock::time_point deadline) -> void { m_deadline = deadline; }
+    [[nodiscard]] auto deadline() const -> std::optional<std::chrono::steady_clock::time_point> { return m_deadline; }
+
     [[nodiscard]] auto areDependenciesMet() const -> bool {
-        for (const auto& dependency: m_dependencies) {
-            if (not dependency.waitFor(std::chrono::milliseconds::zero()))
-                return false;
+        return std::ranges::all_of(m_dependencies, &Dependency::ready);
+    };
+
+    // Running it now would do nothing: dependencies are not met or it is suspended until something completes
+    [[nodiscard]] auto waiting() const -> bool { return suspended() or not areDependenciesMet(); }
+
+    // Calls onReady once, from the thread meeting the last dependency or waking the task up. False when it is not waiting,
+    // onReady is then not called. Dependencies can not be added once it is waiting
+    [[nodiscard]] auto whenReady(std::function<void()> onReady) -> bool {
+        m_onReady = std::move(onReady);
+
+        if (waitForNextDependency()) {
+            return true;
         }
 
-        return true;
-    };
+        auto suspension { Suspension::Suspended };
+        return m_suspension.compare_exchange_strong(suspension, Suspension::Parked, std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+
+    // For awaitables: suspend before adding the continuation that wakes the task up, from any thread, once what it waits for completes
+    auto suspend() -> void { m_suspension.store(Suspension::Suspended, std::memory_order_release); }
+
+    auto wake() -> void {
+        // Not set aside yet, it runs again as soon as its executor is done with it
+        if (auto suspension { Suspension::Suspended }; m_suspension.compare_exchange_strong(suspension, Suspension::Woken,
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return;
+        }
+
+        m_suspension.store(Suspension::Woken, std::memory_order_relaxed);
+        handOverReadyTask();
+    }
+
+    // For a task that will not run, as one left when its executor stops. Whoever waits for it is released with a broken
+    // promise error, tasks depending on it are stopped
+    auto abandon() -> void { m_signal.abandon(); }
+
+    // For awaitables moving the task elsewhere: the executor gives the task to the function once it suspends
+    auto handOver(std::function<void(std::unique_ptr<AsyncTask>)> destination) -> void { m_handOver = std::move(destination); }
+    [[nodiscard]] auto takeHandOver() -> std::function<void(std::unique_ptr<AsyncTask>)> { return std::exchange(m_handOver, nullptr); }
 
 protected:
     auto signalCompletion() -> void { m_signal.signalCompletion(); }
 
+    // Once dependencies are met
+    [[nodiscard]] auto stopReason() const -> std::optional<std::errc> {
+        if (m_stopToken.stop_requested() or std::ranges::any_of(m_dependencies, &Dependency::cancelled)) {
+            return std::errc::operation_canceled;
+        }
+
+        if (m_deadline.has_value() and std::chrono::steady_clock::now() >= *m_deadline) {
+            return std::errc::timed_out;
+        }
+
+        return std::nullopt;
+    }
+
+    auto signalStop(const std::errc reason) -> void {
+        m_signal.state()->cancel(std::make_exception_ptr(std::system_error { std::make_error_code(reason) }));
+        signalCompletion();
+    }
+
+    [[nodiscard]] auto suspended() const -> bool {
+        const auto suspension { m_suspension.load(std::memory_order_acquire) };
+        return suspension == Suspension::Suspended or suspension == Suspension::Parked;
+    }
+
     Signal m_signal;
     std::vector<Dependency> m_dependencies;
+
+private:
+    // Woken up before its executor set it aside, it is then run again rather than parked
+    enum class Suspension : std::uint8_t { Running, Suspended, Parked, Woken };
+
+    class DependencyContinuation final : public Continuation {
+    public:
+        explicit DependencyContinuation(AsyncTask& task) :  m_task { task } {}
+
+        auto run() -> void override {
+            if (not m_task.waitForNextDependency()) {
+                m_task.handOverReadyTask();
+            }
+        }
+
+    private:
+        AsyncTask& m_task;
+    };
+
+    explicit AsyncTask(Signal signal)
+     :  m_signal { std::move(signal) },
+        m_dependencies {},
+        m_priority { Priority::Background },
+        m_enqueuedAt {},
+        m_stopToken {},
+        m_deadline {},
+        m_metDependencies { 0 },
+        m_suspension { Suspension::Running },
+        m_onReady {},
+        m_handOver {},
+        m_dependencyContinuation { *this } {}
+
+    [[nodiscard]] auto waitForNextDependency() -> bool {
+        while (m_metDependencies < m_dependencies.size()) {
+            // Counted before the continuation is added, it may run on another thread right away
+            const auto& dependency { m_dependencies[m_metDependencies++] };
+
+            if (dependency.onCompletion(m_dependencyContinuation)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto handOverReadyTask() -> void {
+        // The task may be run and destroyed as soon as it is handed over
+        const auto onReady { std::move(m_onReady) };
+        onReady();
+    }
+
+    Priority m_priority;
+    std::chrono::steady_clock::time_point m_enqueuedAt;
+    std::stop_token m_stopToken;
+    std::optional<std::chrono::steady_clock::time_point> m_deadline;
+    std::size_t m_metDependencies;
+    std::atomic<Suspension> m_suspension;
+    std::function<void()> m_onReady;
+    std::function<void(std::unique_ptr<AsyncTask>)> m_handOver;
+    DependencyContinuation m_dependencyContinuation;
 };
 
-}
\ No newline at end of file
+}
@@ -2,25 +2,171 @@ module async_task_scheduler;
 
 namespace async_task_scheduler {
 
-AsyncTaskScheduler::AsyncTaskScheduler(const unsigned int concurrencyLevel)
- :  m_executors(concurrencyLevel) {}
+namespace {
+
+// Tasks of a batch sorted by executor, kept by each thread for its next batch
+thread_local std::vector<std::vector<std::unique_ptr<AsyncTask>>> executorTasks {};
+
+}
+
+AsyncTaskScheduler::AsyncTaskScheduler(const unsigned int concurrencyLevel, const unsigned int controlConcurrencyLevel,
+        std::vector<ThreadConfiguration> configurations)
+ :  m_timer {},
+    m_concurrencyLevel { concurrencyLevel },
+    m_executors {},
+    m_tracers {} {
+    const auto executorCount { concurrencyLevel + controlConcurrencyLevel };
+
+    configurations.resize(std::max<std::size_t>(configurations.size(), executorCount));
+    m_executors.reserve(executorCount);
+
+    for (unsigned int i { 0 }; i < executorCount; ++i) {
+        // In the same group, idle executors steal control tasks from the reserved ones
+        const auto reserved { i >= concurrencyLevel };
+        auto& configuration { configurations[i] };
+
+        if (configuration.m_name.empty()) {
+            configuration.m_name = reserved ? std::format("ats-control-{}", i - concurrencyLevel) : std::format("ats-executor-{}", i);
+        }
+
+        m_executors.push_back(makeTaskExecutor(reserved ? Priority::Control : Priority::Background, std::move(configuration)));
+    }
+
+    for (const auto& executor: m_executors) {
+        executor->group(&m_executors);
+        executor->timer(&m_timer);
+    }
+}
+
+AsyncTaskScheduler::~AsyncTaskScheduler() {
+    // Pending timers point into tasks destroyed along with the executors, tasks they would enqueue are dropped
+    // while the executors of the tasks waiting for them are still there
+    m_timer.stop();
+
+    // Executors may still be stealing from each other until all of them are stopped
+    for (const auto& executor: m_executors) {
+        executor->stop();
+    }
+
+    // Tasks of an executor may wait for tasks of another
+    for (const auto& executor: m_executors) {
+        executor->abandonTasks();
+    }
+}
 
 auto AsyncTaskScheduler::concurrencyLevel() const -> unsigned int {
-    return static_cast<unsigned int>(m_executors.size());
+    return m_concurrencyLevel;
+}
+
+auto AsyncTaskScheduler::configured() const -> std::expected<void, std::string> {
+    for (const auto& executor: m_executors) {
+        if (auto configured { executor->configured() }; not configured.has_value()) {
+            return configured;
+        }
+    }
+
+    return {};
 }
 
 auto AsyncTaskScheduler::enqueueTask(std::unique_ptr<AsyncTask> task, const unsigned int threadId) -> void {
-    if (threadId >= m_executors.size())
+    if (threadId >= m_concurrencyLevel)
+        return;
+
+    m_executors[executorIndex(*task, threadId)]->enqueueTask(std::move(task));
+}
+
+auto AsyncTaskScheduler::enqueueTasks(std::vector<std::unique_ptr<AsyncTask>> tasks, const unsigned int threadId) -> void {
+    enqueueTasks(std::span { tasks }, threadId);
+}
+
+auto AsyncTaskScheduler::enqueueTasks(const std::span<std::unique_ptr<AsyncTask>> tasks, unsigned int threadId) -> void {
+    if (threadId >= m_concurrencyLevel)
         return;
 
-    m_executors[threadId].enqueueTask(std::move(task));
+    executorTasks.resize(std::max(executorTasks.size(), m_executors.size()));
+
+    for (auto& task: tasks) {
+        executorTasks[executorIndex(*task, threadId)].push_back(std::move(task));
+        threadId = (threadId + 1) % m_concurrencyLevel;
+    }
+
+    for (std::size_t i { 0 }; i < m_executors.size(); ++i) {
+        m_executors[i]->enqueueTasks(std::span { executorTasks[i] });
+        executorTasks[i].clear();
+    }
+}
+
+auto AsyncTaskScheduler::executorIndex(const AsyncTask& task, const unsigned int threadId) const -> std::size_t {
+    if (const auto controlConcurrencyLevel { m_executors.size() - m_concurrencyLevel };
+            task.priority() == Priority::Control and controlConcurrencyLevel > 0) {
+        return m_concurrencyLevel + threadId % controlConcurrencyLevel;
+    }
+
+    return threadId;
+}
+
+auto AsyncTaskScheduler::enqueueAfter(std::unique_ptr<AsyncTask> task, const std::chrono::steady_clock::duration delay,
+        const unsigned int threadId) -> TimerId_t {
+    return m_timer.schedule(std::chrono::steady_clock::now() + delay, std::chrono::steady_clock::duration::zero(),
+        [this, task = std::move(task), threadId] () mutable { enqueueTask(std::move(task), threadId); });
+}
+
+auto AsyncTaskScheduler::enqueueEvery(std::function<void()> job, const std::chrono::steady_clock::duration period,
+        const unsigned int threadId) -> TimerId_t {
+    return m_timer.schedule(std::chrono::steady_clock::now() + period, period,
+        [this, job = std::move(job), threadId, previousRun = std::optional<Dependency> {}] () mutable {
+            if (previousRun.has_value() and not previousRun->ready()) {
+                return;
+            }
+
+            auto task { makeAtomicTask(job) };
+            previousRun = task->dependency();
+            enqueueTask(std::move(task), threadId);
+        });
+}
+
+auto AsyncTaskScheduler::cancelTimer(const TimerId_t timerId) -> bool {
+    return m_timer.cancel(timerId);
 }
 
-auto makeAsyncTaskScheduler(const unsigned int concurrencyLevel) -> std::expected<std::unique_ptr<AsyncTaskScheduler>, std::string> {
-    if (concurrencyLevel > 0)
-        return std::make_unique<AsyncTaskScheduler>(concurrencyLevel);
+auto AsyncTaskScheduler::statistics() const -> std::vector<ExecutorStatistics> {
+    std::vector<ExecutorStatistics> statistics {};
+    statistics.reserve(m_executors.size());
+
+    for (const auto& executor: m_executors) {
+        statistics.push_back(executor->statistics());
+    }
+
+    return statistics;
+}
+
+auto AsyncTaskScheduler::traceTasks(TaskTracer tracer) -> void {
+    const TaskTracer* executorTracer { nullptr };
+
+    if (tracer) {
+        m_tracers.push_back(std::make_unique<TaskTracer>(std::move(tracer)));
+        executorTracer = m_tracers.back().get();
+    }
+
+    for (const auto& executor: m_executors) {
+        executor->tracer(executorTracer);
+    }
+}
+
+auto makeAsyncTaskScheduler(const unsigned int concurrencyLevel, const unsigned int controlConcurrencyLevel,
+        std::vector<ThreadConfiguration> configurations) -> std::expected<std::unique_ptr<AsyncTaskScheduler>, std::string> {
+    if (concurrencyLevel == 0)
+        return std::unexpected { std::string { "Concurrency level must be greater than 0" } };
+
+    if (configurations.size() > concurrencyLevel + controlConcurrencyLevel)
+        return std::unexpected { std::string { "More thread configurations than executors" } };
+
+    auto scheduler { std::make_unique<AsyncTaskScheduler>(concurrencyLevel, controlConcurrencyLevel, std::move(configurations)) };
+
+    if (auto configured { scheduler->configured() }; not configured.has_value())
+        return std::unexpected { configured.error() };
 
-    return std::unexpected { std::string { "Concurrency level must be greater than 0" } };
+    return scheduler;
 }
 
 }
\ No newline at end of file
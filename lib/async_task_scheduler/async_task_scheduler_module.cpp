@@ -4,25 +4,76 @@ export import task_executor;
 export import async_task;
 export import atomic_task;
 export import dependency;
+export import shared_state;
 export import signal;
 export import result;
+export import combinators;
 export import resumable_task;
+export import timer;
+export import thread_configuration;
+export import executor_statistics;
+export import awaitables;
+export import async_generator;
 
 import std;
 
 namespace async_task_scheduler {
 
+// Executors steal tasks from each other, threadId only tells where a task starts. Executors reserved to control tasks
+// come on top of the concurrency level, so that control tasks never wait behind background tasks already running.
+// Thread configurations go to the executors in order, reserved ones last. Executors without one are only named
 export class AsyncTaskScheduler final {
 public:
-    explicit AsyncTaskScheduler(unsigned int concurrencyLevel);
+    explicit AsyncTaskScheduler(unsigned int concurrencyLevel, unsigned int controlConcurrencyLevel = 0,
+        std::vector<ThreadConfiguration> configurations = {});
+    ~AsyncTaskScheduler();
 
+    AsyncTaskScheduler(const AsyncTaskScheduler&) = delete;
+    AsyncTaskScheduler& operator=(const AsyncTaskScheduler&) = delete;
+    AsyncTaskScheduler(AsyncTaskScheduler&&) = delete;
+    AsyncTaskScheduler& operator=(AsyncTaskScheduler&&) = delete;
+
+    // Executors a task can be enqueued to, reserved ones excepted
     [[nodiscard]] auto concurrencyLevel() const -> unsigned int;
+
+    // First executor that could not apply its configuration
+    [[nodiscard]] auto configured() const -> std::expected<void, std::string>;
+
+    // Control tasks go to the reserved executors, if any, through threadId
     auto enqueueTask(std::unique_ptr<AsyncTask> task, unsigned int threadId = 0) -> void;
 
+    // Placed round robin from threadId as one by one, but every executor gets its share under a single lock and is woken once
+    auto enqueueTasks(std::vector<std::unique_ptr<AsyncTask>> tasks, unsigned int threadId = 0) -> void;
+    // Moves the tasks out without allocating once the thread enqueued a batch as large
+    auto enqueueTasks(std::span<std::unique_ptr<AsyncTask>> tasks, unsigned int threadId = 0) -> void;
+
+    // Enqueues the task once the delay has passed, unless the timer is cancelled first
+    auto enqueueAfter(std::unique_ptr<AsyncTask> task, std::chrono::steady_clock::duration delay, unsigned int threadId = 0) -> TimerId_t;
+
+    // Enqueues a task running the job every period, the first one after a period. A period is skipped while the previous
+    // run is not done, so that a slow job does not pile up
+    auto enqueueEvery(std::function<void()> job, std::chrono::steady_clock::duration period, unsigned int threadId = 0) -> TimerId_t;
+
+    // False when the timer is unknown or already enqueued its last task
+    auto cancelTimer(TimerId_t timerId) -> bool;
+
+    // One per executor, in the order of the thread configurations
+    [[nodiscard]] auto statistics() const -> std::vector<ExecutorStatistics>;
+
+    // Traces every run of a task, an empty tracer stops tracing. Tracers are kept along with the scheduler,
+    // so that one can be replaced while executors call it
+    auto traceTasks(TaskTracer tracer) -> void;
+
 private:
-    std::vector<TaskExecutor> m_executors;
+    [[nodiscard]] auto executorIndex(const AsyncTask& task, unsigned int threadId) const -> std::size_t;
+
+    Timer m_timer;
+    unsigned int m_concurrencyLevel;
+    std::vector<std::unique_ptr<TaskExecutor>> m_executors;
+    std::vector<std::unique_ptr<TaskTracer>> m_tracers;
 };
 
-export auto makeAsyncTaskScheduler(unsigned int concurrencyLevel) -> std::expected<std::unique_ptr<AsyncTaskScheduler>, std::string>;
+export auto makeAsyncTaskScheduler(unsigned int concurrencyLevel, unsigned int controlConcurrencyLevel = 0,
+    std::vector<ThreadConfiguration> configurations = {}) -> std::expected<std::unique_ptr<AsyncTaskScheduler>, std::string>;
 
 }
\ No newline at end of file
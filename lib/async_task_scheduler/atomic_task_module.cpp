@@ -2,9 +2,11 @@ export module atomic_task;
 
 import std;
 
+import shared_state;
 import async_task;
 import dependency;
 import result;
+import task_pool;
 
 namespace async_task_scheduler {
 
@@ -13,28 +15,48 @@ class AtomicTask final : public AsyncTask {
 public:
     template <typename Callable> requires std::is_invocable_r_v<Res, Callable, ArgTypes...>
     explicit AtomicTask(Callable&& callable, ArgTypes&&... args)
-     :  m_task { std::forward<Callable>(callable) },
-        m_args { std::forward<ArgTypes>(args)... },
-        m_result { m_task.get_future().share() } {}
+     :  AtomicTask { makeSharedState<Res>(), std::forward<Callable>(callable), std::forward<ArgTypes>(args)... } {}
 
     auto operator()() -> void override {
-        if (not areDependenciesMet())
+        if (done() or not areDependenciesMet())
+            return;
+
+        if (const auto reason { stopReason() }) {
+            signalStop(*reason);
             return;
+        }
+
+        try {
+            if constexpr (std::is_void_v<Res>) {
+                std::apply(m_task, m_args);
+            } else {
+                m_state->setValue(std::apply(m_task, m_args));
+            }
+        } catch (...) {
+            m_state->setException(std::current_exception());
+        }
 
-        std::apply(m_task, m_args);
         signalCompletion();
     }
 
     [[nodiscard]] auto done() const -> bool override {
-        return m_result.ready();
+        return m_state->ready();
     }
 
-    [[nodiscard]] auto result() const -> Result<Res> { return m_result; }
+    [[nodiscard]] auto result() const -> Result<Res> { return Result<Res> { m_state }; }
 
 private:
-    std::packaged_task<Res(ArgTypes...)> m_task;
+    // The task signals completion through the state holding its result
+    template <typename Callable>
+    AtomicTask(StateReference<SharedState<Res>> state, Callable&& callable, ArgTypes&&... args)
+     :  AsyncTask { state },
+        m_task { std::forward<Callable>(callable) },
+        m_args { std::forward<ArgTypes>(args)... },
+        m_state { std::move(state) } {}
+
+    TaskFunction<Res(ArgTypes...)> m_task;
     std::tuple<ArgTypes...> m_args;
-    Result<Res> m_result;
+    StateReference<SharedState<Res>> m_state;
 };
 
 export template<typename Callable, typename... ArgTypes>
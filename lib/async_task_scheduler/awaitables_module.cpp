@@ -0,0 +1,163 @@
+export module awaitables;
+
+import std;
+
+import shared_state;
+import async_task;
+import dependency;
+import result;
+import task_executor;
+import timer;
+
+namespace async_task_scheduler {
+
+// Coroutines awaiting these are set aside by their executor and enqueued again, once, by whatever completes what they wait for.
+// A coroutine resumed directly rather than by an executor does nothing until then
+export template <typename Promise>
+concept TaskPromise = requires (Promise promise) { { promise.m_task } -> std::convertible_to<AsyncTask*>; };
+
+class WakeUp : public Continuation {
+public:
+    WakeUp() :  m_task { nullptr } {}
+
+    auto run() -> void override { m_task->wake(); }
+
+protected:
+    template <TaskPromise Promise>
+    auto suspend(const std::coroutine_handle<Promise> handle) -> AsyncTask& {
+        m_task = handle.promise().m_task;
+        m_task->suspend();
+
+        return *m_task;
+    }
+
+    // Completed before the wake up was added, the coroutine goes on
+    auto cancel() -> bool {
+        m_task->wake();
+        return false;
+    }
+
+private:
+    AsyncTask* m_task;
+};
+
+export template <typename Res>
+class ResultAwaiter final : public WakeUp {
+public:
+    explicit ResultAwaiter(const Result<Res>& result) :  m_result { result } {}
+
+    [[nodiscard]] auto await_ready() const -> bool { return m_result.ready(); }
+
+    template <TaskPromise Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> bool {
+        suspend(handle);
+        return m_result.onCompletion(*this) or cancel();
+    }
+
+    auto await_resume() const -> auto { return m_result.get(); }
+
+private:
+    Result<Res> m_result;
+};
+
+export class DependencyAwaiter final : public WakeUp {
+public:
+    explicit DependencyAwaiter(const Dependency& dependency) :  m_dependency { dependency } {}
+
+    [[nodiscard]] auto await_ready() const -> bool { return m_dependency.ready(); }
+
+    template <TaskPromise Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> bool {
+        suspend(handle);
+        return m_dependency.onCompletion(*this) or cancel();
+    }
+
+    static auto await_resume() -> void {}
+
+private:
+    Dependency m_dependency;
+};
+
+// Woken up early, once, when its task is stopped or reaches its deadline, so that it is stopped without waiting for the delay
+export class TimerAwaiter final : public WakeUp {
+public:
+    explicit TimerAwaiter(const std::chrono::steady_clock::duration delay)
+     :  m_deadline { std::chrono::steady_clock::now() + delay }, m_timerId { 0 }, m_cancellation {} {}
+
+    TimerAwaiter(const TimerAwaiter&) = delete;
+    TimerAwaiter& operator=(const TimerAwaiter&) = delete;
+
+    [[nodiscard]] auto await_ready() const -> bool { return std::chrono::steady_clock::now() >= m_deadline; }
+
+    // Without the timer of a scheduler the calling thread sleeps
+    template <TaskPromise Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> bool {
+        auto* executor { TaskExecutor::current() };
+        auto* timer { executor != nullptr ? executor->timer() : nullptr };
+
+        if (timer == nullptr) {
+            std::this_thread::sleep_until(m_deadline);
+            return false;
+        }
+
+        const auto& task { suspend(handle) };
+        const auto deadline { task.deadline().has_value() ? std::min(m_deadline, *task.deadline()) : m_deadline };
+
+        m_timerId = timer->schedule(deadline, *this);
+
+        // A timer already running wakes the task up itself
+        if (task.cancellation().stop_possible()) {
+            m_cancellation.emplace(task.cancellation(), [this, timer] () {
+                if (timer->cancel(m_timerId)) {
+                    run();
+                }
+            });
+        }
+
+        return true;
+    }
+
+    static auto await_resume() -> void {}
+
+private:
+    std::chrono::steady_clock::time_point m_deadline;
+    TimerId_t m_timerId;
+    // Unregistered along with the frame, waiting for a wake up under way
+    std::optional<std::stop_callback<std::function<void()>>> m_cancellation;
+};
+
+// Moves the coroutine to the given executor of any scheduler
+export template <typename Scheduler>
+class ScheduleOnAwaiter final {
+public:
+    ScheduleOnAwaiter(Scheduler& scheduler, const unsigned int threadId) :  m_scheduler { scheduler }, m_threadId { threadId } {}
+
+    static auto await_ready() -> bool { return false; }
+
+    template <TaskPromise Promise>
+    auto await_suspend(const std::coroutine_handle<Promise> handle) -> void {
+        handle.promise().m_task->handOver([&scheduler = m_scheduler, threadId = m_threadId] (std::unique_ptr<AsyncTask> task) {
+            scheduler.enqueueTask(std::move(task), threadId);
+        });
+    }
+
+    static auto await_resume() -> void {}
+
+private:
+    Scheduler& m_scheduler;
+    unsigned int m_threadId;
+};
+
+export template <typename Res>
+[[nodiscard]] auto operator co_await(const Result<Res>& result) -> ResultAwaiter<Res> { return ResultAwaiter<Res> { result }; }
+
+export [[nodiscard]] auto operator co_await(const Dependency& dependency) -> DependencyAwaiter { return DependencyAwaiter { dependency }; }
+
+export [[nodiscard]] auto after(const std::chrono::steady_clock::duration delay) -> TimerAwaiter { return TimerAwaiter { delay }; }
+
+export template <typename Scheduler>
+[[nodiscard]] auto scheduleOn(Scheduler& scheduler, const unsigned int threadId) -> ScheduleOnAwaiter<Scheduler> {
+    return ScheduleOnAwaiter<Scheduler> { scheduler, threadId };
+}
+
+}
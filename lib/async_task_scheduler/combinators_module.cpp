@@ -0,0 +1,136 @@
+export module combinators;
+
+import std;
+
+import shared_state;
+import result;
+
+namespace async_task_scheduler {
+
+// Adds a continuation to every input and completes its own state from them, on the thread completing the input.
+// Continuations can not be removed, so it deletes itself once every one of them ran. The builder holds a count of
+// its own while adding them, as inputs already complete run their continuation right away
+template <bool Any>
+class Join final {
+public:
+    using Res = std::conditional_t<Any, std::size_t, void>;
+
+    explicit Join(const std::size_t inputCount)
+     :  m_arrivals { std::make_unique<Arrival[]>(inputCount) },
+        m_remaining { inputCount + 1 },
+        m_decided { false },
+        m_state { makeSharedState<Res>() } {
+        // Nothing would decide
+        if (Any and inputCount == 0) {
+            m_state->setException(std::make_exception_ptr(std::invalid_argument { "No result to wait for" }));
+            m_state->complete();
+        }
+    }
+
+    [[nodiscard]] auto result() const -> Result<Res> { return Result<Res> { m_state }; }
+
+    template <typename Input>
+    auto add(const Result<Input>& input, const std::size_t index) -> void {
+        m_arrivals[index].m_join = this;
+        m_arrivals[index].m_index = index;
+
+        if (not input.onCompletion(m_arrivals[index])) {
+            arrive(index);
+        }
+    }
+
+    // Once every input is added, the join may be deleted on return
+    auto release() -> void { leave(); }
+
+private:
+    class Arrival final : public Continuation {
+    public:
+        Arrival() :  m_join { nullptr }, m_index { 0 } {}
+
+        auto run() -> void override { m_join->arrive(m_index); }
+
+        Join* m_join;
+        std::size_t m_index;
+    };
+
+    auto arrive(const std::size_t index) -> void {
+        if constexpr (Any) {
+            if (not m_decided.exchange(true, std::memory_order_acq_rel)) {
+                m_state->setValue(index);
+                m_state->complete();
+            }
+        }
+
+        leave();
+    }
+
+    auto leave() -> void {
+        if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+
+        if constexpr (not Any) {
+            m_state->complete();
+        }
+
+        delete this;
+    }
+
+    std::unique_ptr<Arrival[]> m_arrivals;
+    std::atomic<std::size_t> m_remaining;
+    std::atomic_bool m_decided;
+    StateReference<SharedState<Res>> m_state;
+};
+
+template <bool Any, typename AddInputs>
+[[nodiscard]] auto join(const std::size_t inputCount, AddInputs addInputs) -> Result<typename Join<Any>::Res> {
+    auto* join { new Join<Any> { inputCount } };
+    auto result { join->result() };
+
+    addInputs(*join);
+    join->release();
+
+    return result;
+}
+
+// Combinators complete on the thread completing the input that decides, no thread waits for them. Awaited like any result.
+// Errors stay with the inputs, read them from there. A task destroyed before running counts as complete, with a broken
+// promise error
+
+// Completes once every result is complete
+export template <typename... Res> requires (sizeof...(Res) > 0)
+[[nodiscard]] auto whenAll(const Result<Res>&... results) -> Result<void> {
+    return join<false>(sizeof...(Res), [&results...] (Join<false>& join) {
+        std::size_t index { 0 };
+        (join.add(results, index++), ...);
+    });
+}
+
+export template <typename Res>
+[[nodiscard]] auto whenAll(const std::vector<Result<Res>>& results) -> Result<void> {
+    return join<false>(results.size(), [&results] (Join<false>& join) {
+        for (std::size_t i { 0 }; i < results.size(); ++i) {
+            join.add(results[i], i);
+        }
+    });
+}
+
+// Completes with the index of the first result complete, an invalid argument error without results
+export template <typename... Res> requires (sizeof...(Res) > 0)
+[[nodiscard]] auto whenAny(const Result<Res>&... results) -> Result<std::size_t> {
+    return join<true>(sizeof...(Res), [&results...] (Join<true>& join) {
+        std::size_t index { 0 };
+        (join.add(results, index++), ...);
+    });
+}
+
+export template <typename Res>
+[[nodiscard]] auto whenAny(const std::vector<Result<Res>>& results) -> Result<std::size_t> {
+    return join<true>(results.size(), [&results] (Join<true>& join) {
+        for (std::size_t i { 0 }; i < results.size(); ++i) {
+            join.add(results[i], i);
+        }
+    });
+}
+
+}
@@ -2,19 +2,26 @@ export module dependency;
 
 import std;
 
+import shared_state;
 import signal;
 
 namespace async_task_scheduler {
 
 export class Dependency final {
 public:
-    explicit Dependency(const Signal& signal) :  m_dependency { signal.getFuture() } {}
+    explicit Dependency(const Signal& signal) :  m_dependency { signal.state() } {}
 
-    auto wait() const -> void { m_dependency.wait(); }
-    [[nodiscard]] auto waitFor(const std::chrono::milliseconds timeout) const -> bool { return m_dependency.wait_for(timeout) == std::future_status::ready; }
+    auto wait() const -> void { m_dependency->wait(); }
+    [[nodiscard]] auto waitFor(const std::chrono::milliseconds timeout) const -> bool { return m_dependency->waitFor(timeout); }
+    [[nodiscard]] auto ready() const -> bool { return m_dependency->ready(); }
+    // Once ready, the task was stopped rather than run
+    [[nodiscard]] auto cancelled() const -> bool { return m_dependency->cancelled(); }
+
+    // Runs the continuation on the thread completing the dependency. False when it is already complete, the continuation is then not run
+    [[nodiscard]] auto onCompletion(Continuation& continuation) const -> bool { return m_dependency->addContinuation(continuation); }
 
 private:
-    std::shared_future<void> m_dependency;
+    StateReference<SharedStateBase> m_dependency;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,126 @@
+export module executor_statistics;
+
+import std;
+
+import async_task;
+
+namespace async_task_scheduler {
+
+// Counts of durations in buckets doubling in width, the first one holding durations under a nanosecond
+export struct Histogram {
+    static constexpr std::size_t bucketCount { 40 };
+
+    [[nodiscard]] auto count() const -> std::uint64_t { return std::ranges::fold_left(m_counts, std::uint64_t { 0 }, std::plus {}); }
+
+    // Upper bound of the bucket holding the percentile, zero when nothing was recorded
+    [[nodiscard]] auto percentile(const double percentile) const -> std::chrono::nanoseconds {
+        const auto total { count() };
+
+        if (total == 0) {
+            return std::chrono::nanoseconds::zero();
+        }
+
+        const auto rank { std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total)))) };
+        std::uint64_t counted { 0 };
+
+        for (std::size_t i { 0 }; i < bucketCount; ++i) {
+            counted += m_counts[i];
+
+            if (counted >= rank) {
+                return std::chrono::nanoseconds { std::int64_t { 1 } << i };
+            }
+        }
+
+        return std::chrono::nanoseconds { std::int64_t { 1 } << (bucketCount - 1) };
+    }
+
+    // Recorded after the earlier snapshot
+    [[nodiscard]] auto since(const Histogram& earlier) const -> Histogram {
+        Histogram histogram {};
+
+        for (std::size_t i { 0 }; i < bucketCount; ++i) {
+            histogram.m_counts[i] = m_counts[i] - earlier.m_counts[i];
+        }
+
+        return histogram;
+    }
+
+    std::array<std::uint64_t, bucketCount> m_counts;
+};
+
+// Recorded by one thread, read by any without locking. Counts read together may be a few records apart
+export class AtomicHistogram final {
+public:
+    AtomicHistogram() :  m_counts {} {}
+
+    auto record(const std::chrono::steady_clock::duration duration) -> void {
+        const auto nanoseconds { std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() };
+        const auto bucket { std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(static_cast<std::uint64_t>(std::max<std::int64_t>(nanoseconds, 0)))),
+            Histogram::bucketCount - 1) };
+
+        m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto snapshot() const -> Histogram {
+        Histogram histogram {};
+
+        for (std::size_t i { 0 }; i < Histogram::bucketCount; ++i) {
+            histogram.m_counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        }
+
+        return histogram;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, Histogram::bucketCount> m_counts;
+};
+
+// Counted since the executor started
+export struct ExecutorStatistics {
+    // Counted after the earlier snapshot of the same executor, the queue depth is the current one
+    [[nodiscard]] auto since(const ExecutorStatistics& earlier) const -> ExecutorStatistics {
+        return ExecutorStatistics {
+            m_name,
+            m_lowestPriority,
+            m_queueDepth,
+            m_tasksRun - earlier.m_tasksRun,
+            m_tasksStolen - earlier.m_tasksStolen,
+            m_busyTime - earlier.m_busyTime,
+            m_idleTime - earlier.m_idleTime,
+            m_queueLatency.since(earlier.m_queueLatency),
+            m_runTime.since(earlier.m_runTime)
+        };
+    }
+
+    // Busy share of the time it was either running tasks or waiting for some
+    [[nodiscard]] auto utilization() const -> double {
+        const auto total { m_busyTime + m_idleTime };
+        return total > std::chrono::nanoseconds::zero() ? static_cast<double>(m_busyTime.count()) / static_cast<double>(total.count()) : 0.0;
+    }
+
+    std::string m_name;
+    Priority m_lowestPriority;
+    // Enqueued to it and not taken yet, by it or by a thief
+    std::size_t m_queueDepth;
+    std::uint64_t m_tasksRun;
+    std::uint64_t m_tasksStolen;
+    std::chrono::nanoseconds m_busyTime;
+    std::chrono::nanoseconds m_idleTime;
+    // From the task being enqueued, or ready again once it yielded or was woken up, to it starting
+    Histogram m_queueLatency;
+    Histogram m_runTime;
+};
+
+// One run of a task. A coroutine has a run for each time it is resumed
+export struct TaskTrace {
+    std::size_t m_executor;
+    Priority m_priority;
+    std::chrono::steady_clock::time_point m_enqueuedAt;
+    std::chrono::steady_clock::time_point m_startedAt;
+    std::chrono::steady_clock::time_point m_finishedAt;
+};
+
+// Called on the executor threads, it has to be thread safe and fast, as the executor waits for it
+export using TaskTracer = std::function<void(const TaskTrace& trace)>;
+
+}
@@ -0,0 +1,203 @@
+export module parallel_algorithms;
+
+import std;
+
+import async_task_scheduler;
+
+namespace async_task_scheduler {
+
+// Chunks of grain elements, split in halves: each split hands one half to the executors and keeps the other, down to
+// a single chunk. Shared by its tasks, the last chunk done completes the result
+template <typename Res, typename RunChunk, typename Finish>
+class ParallelWork final : public std::enable_shared_from_this<ParallelWork<Res, RunChunk, Finish>> {
+public:
+    ParallelWork(AsyncTaskScheduler& scheduler, const std::size_t chunkCount, RunChunk runChunk, Finish finish)
+     :  m_scheduler { scheduler },
+        m_chunkCount { chunkCount },
+        m_remainingChunks { chunkCount },
+        m_runChunk { std::move(runChunk) },
+        m_finish { std::move(finish) },
+        m_failed { false },
+        m_nextThreadId { 0 },
+        m_state { makeSharedState<Res>() } {}
+
+    [[nodiscard]] auto result() const -> Result<Res> { return Result<Res> { m_state }; }
+
+    // On the calling thread, which runs the first chunk
+    auto start() -> void {
+        if (m_chunkCount == 0) {
+            finish();
+        } else {
+            run(0, m_chunkCount);
+        }
+    }
+
+private:
+    auto run(std::size_t firstChunk, std::size_t lastChunk) -> void {
+        while (lastChunk - firstChunk > 1) {
+            const auto middleChunk { firstChunk + (lastChunk - firstChunk) / 2 };
+            handOver(middleChunk, lastChunk);
+            lastChunk = middleChunk;
+        }
+
+        runChunk(firstChunk);
+    }
+
+    auto handOver(const std::size_t firstChunk, const std::size_t lastChunk) -> void {
+        auto task { makeAtomicTask([work { this->shared_from_this() }, firstChunk, lastChunk] () { work->run(firstChunk, lastChunk); }) };
+
+        // Split again by the executor running it, so that the other ones steal the biggest halves left
+        if (auto* executor { TaskExecutor::current() }) {
+            executor->enqueueTask(std::move(task));
+        } else {
+            m_scheduler.enqueueTask(std::move(task), m_nextThreadId.fetch_add(1, std::memory_order_relaxed) % m_scheduler.concurrencyLevel());
+        }
+    }
+
+    auto runChunk(const std::size_t chunk) -> void {
+        // Chunks left once one failed are skipped
+        if (not m_failed.load(std::memory_order_relaxed)) {
+            try {
+                m_runChunk(chunk);
+            } catch (...) {
+                if (not m_failed.exchange(true, std::memory_order_relaxed)) {
+                    m_state->setException(std::current_exception());
+                }
+            }
+        }
+
+        if (m_remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            finish();
+        }
+    }
+
+    auto finish() -> void {
+        if (not m_failed.load(std::memory_order_relaxed)) {
+            try {
+                if constexpr (std::is_void_v<Res>) {
+                    m_finish();
+                } else {
+                    m_state->setValue(m_finish());
+                }
+            } catch (...) {
+                m_state->setException(std::current_exception());
+            }
+        }
+
+        m_state->complete();
+    }
+
+    AsyncTaskScheduler& m_scheduler;
+    std::size_t m_chunkCount;
+    std::atomic<std::size_t> m_remainingChunks;
+    const RunChunk m_runChunk;
+    Finish m_finish;
+    std::atomic_bool m_failed;
+    std::atomic<unsigned int> m_nextThreadId;
+    StateReference<SharedState<Res>> m_state;
+};
+
+// At least one element, at most the whole range, so that chunk bounds never overflow
+[[nodiscard]] auto chunkGrain(const std::size_t size, const std::size_t grain) -> std::size_t {
+    return std::clamp<std::size_t>(grain, 1, std::max<std::size_t>(size, 1));
+}
+
+[[nodiscard]] auto chunkCount(const std::size_t size, const std::size_t grain) -> std::size_t {
+    return size / grain + (size % grain != 0 ? 1 : 0);
+}
+
+template <typename Res, typename RunChunk, typename Finish>
+[[nodiscard]] auto runParallel(AsyncTaskScheduler& scheduler, const std::size_t size, const std::size_t grain,
+        RunChunk runChunk, Finish finish) -> Result<Res> {
+    auto work { std::make_shared<ParallelWork<Res, RunChunk, Finish>>(scheduler, chunkCount(size, grain), std::move(runChunk), std::move(finish)) };
+    auto result { work->result() };
+
+    work->start();
+    return result;
+}
+
+// Calls function with the index and the element of every element of the chunk
+template <typename Iterator, typename Function>
+auto forEachInChunk(const Iterator first, const std::size_t size, const std::size_t grain, const std::size_t chunk, Function&& function) -> void {
+    const auto begin { chunk * grain };
+    const auto last { begin + std::min(grain, size - begin) };
+
+    for (auto i { begin }; i < last; ++i) {
+        function(i, first[static_cast<std::iter_difference_t<Iterator>>(i)]);
+    }
+}
+
+template <typename Range>
+concept ParallelRange = std::ranges::random_access_range<Range> and std::ranges::sized_range<Range> and std::ranges::borrowed_range<Range>;
+
+// The algorithms split the range in chunks of grain elements, zero counting as one and more than the range as all of it, run by the executors and the calling thread.
+// Elements have to outlive the result, and functions may be called from several threads at once. The first exception
+// thrown is the one of the result, chunks not started by then are skipped. Waiting on the result from a task blocks
+// its executor, which may run the remaining chunks: await it instead
+
+export template <ParallelRange Range, typename Function> requires std::invocable<const Function&, std::ranges::range_reference_t<Range>>
+[[nodiscard]] auto parallelFor(AsyncTaskScheduler& scheduler, Range&& range, std::size_t grain, Function function) -> Result<void> {
+    const auto size { static_cast<std::size_t>(std::ranges::size(range)) };
+    grain = chunkGrain(size, grain);
+
+    return runParallel<void>(scheduler, size, grain,
+        [first { std::ranges::begin(range) }, size, grain, function { std::move(function) }] (const std::size_t chunk) {
+            forEachInChunk(first, size, grain, chunk, [&function] (std::size_t, auto&& element) {
+                std::invoke(function, std::forward<decltype(element)>(element));
+            });
+        }, [] () {});
+}
+
+// Reduces every chunk from its first element, then init with the chunks in order, so that reduce only has to be associative
+export template <ParallelRange Range, typename T, typename Reduce, typename Transform = std::identity>
+    requires std::invocable<const Transform&, std::ranges::range_reference_t<Range>>
+        and std::is_invocable_r_v<T, const Reduce&, T, std::invoke_result_t<const Transform&, std::ranges::range_reference_t<Range>>>
+        and std::is_invocable_r_v<T, const Reduce&, T, T>
+[[nodiscard]] auto parallelReduce(AsyncTaskScheduler& scheduler, Range&& range, std::size_t grain, T init, Reduce reduce,
+        Transform transform = {}) -> Result<T> {
+    const auto size { static_cast<std::size_t>(std::ranges::size(range)) };
+    grain = chunkGrain(size, grain);
+
+    // Written once per chunk, chunks do not share cache lines while reducing
+    auto partials { std::make_shared<std::vector<std::optional<T>>>(chunkCount(size, grain)) };
+
+    return runParallel<T>(scheduler, size, grain,
+        [first { std::ranges::begin(range) }, size, grain, partials, reduce, transform { std::move(transform) }] (const std::size_t chunk) {
+            std::optional<T> partial {};
+
+            forEachInChunk(first, size, grain, chunk, [&partial, &reduce, &transform] (std::size_t, auto&& element) {
+                if (partial.has_value()) {
+                    partial = std::invoke(reduce, std::move(*partial), std::invoke(transform, std::forward<decltype(element)>(element)));
+                } else {
+                    partial.emplace(std::invoke(transform, std::forward<decltype(element)>(element)));
+                }
+            });
+
+            (*partials)[chunk] = std::move(partial);
+        },
+        [partials, init { std::move(init) }, reduce] () mutable -> T {
+            for (auto& partial: *partials) {
+                init = std::invoke(reduce, std::move(init), std::move(*partial));
+            }
+
+            return std::move(init);
+        });
+}
+
+// Output has room for as many elements as the range
+export template <ParallelRange Range, std::random_access_iterator Output, typename Function>
+    requires std::indirectly_writable<Output, std::invoke_result_t<const Function&, std::ranges::range_reference_t<Range>>>
+[[nodiscard]] auto parallelTransform(AsyncTaskScheduler& scheduler, Range&& range, const Output output, std::size_t grain,
+        Function function) -> Result<void> {
+    const auto size { static_cast<std::size_t>(std::ranges::size(range)) };
+    grain = chunkGrain(size, grain);
+
+    return runParallel<void>(scheduler, size, grain,
+        [first { std::ranges::begin(range) }, output, size, grain, function { std::move(function) }] (const std::size_t chunk) {
+            forEachInChunk(first, size, grain, chunk, [&output, &function] (const std::size_t i, auto&& element) {
+                output[static_cast<std::iter_difference_t<Output>>(i)] = std::invoke(function, std::forward<decltype(element)>(element));
+            });
+        }, [] () {});
+}
+
+}
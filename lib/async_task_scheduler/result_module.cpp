@@ -2,18 +2,39 @@ export module result;
 
 import std;
 
+import shared_state;
+
 namespace async_task_scheduler {
 
 export template <typename Res>
 class Result {
 public:
-    explicit Result(const std::shared_future<Res>& result) : m_result { result } {}
+    explicit Result(const StateReference<SharedState<Res>>& result) : m_result { result } {}
+
+    [[nodiscard]] auto get() const -> auto { return m_result->get(); }
+    [[nodiscard]] auto ready() const -> bool { return m_result->ready(); }
+    auto wait() const -> void { m_result->wait(); }
+    [[nodiscard]] auto waitFor(const std::chrono::milliseconds timeout) const -> bool { return m_result->waitFor(timeout); }
+
+    // Timed out when the task did not complete in time, it goes on regardless. Errors of the task are thrown as get() does
+    [[nodiscard]] auto getFor(const std::chrono::milliseconds timeout) const -> std::expected<Res, std::errc> {
+        if (not waitFor(timeout)) {
+            return std::unexpected { std::errc::timed_out };
+        }
+
+        if constexpr (std::is_void_v<Res>) {
+            m_result->get();
+            return {};
+        } else {
+            return m_result->get();
+        }
+    }
 
-    [[nodiscard]] auto get() const -> auto { return m_result.get(); }
-    [[nodiscard]] auto ready() const -> bool { return m_result.wait_for(std::chrono::milliseconds::zero()) == std::future_status::ready; }
+    // Runs the continuation on the thread completing the result. False when it is already complete, the continuation is then not run
+    [[nodiscard]] auto onCompletion(Continuation& continuation) const -> bool { return m_result->addContinuation(continuation); }
 
 private:
-    std::shared_future<Res> m_result;
+    StateReference<SharedState<Res>> m_result;
 };
 
-}
\ No newline at end of file
+}
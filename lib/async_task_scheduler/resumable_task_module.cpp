@@ -2,6 +2,7 @@ export module resumable_task;
 
 import std;
 
+import shared_state;
 import async_task;
 import result;
 
@@ -15,28 +16,39 @@ class ResumableTask final: public AsyncTask {
 public:
     using promise_type = resumable_task_promise<Res>;
 
-    explicit ResumableTask(std::coroutine_handle<promise_type> handle): m_handle { handle } {}
-    ResumableTask(ResumableTask&& other) noexcept :  m_handle { std::move(other.m_handle) } { other.m_handle = nullptr; }
+    // The task signals completion through the state holding the coroutine result
+    explicit ResumableTask(std::coroutine_handle<promise_type> handle) :  AsyncTask { handle.promise().m_state }, m_handle { handle } {}
+    ResumableTask(ResumableTask&& other) noexcept :  AsyncTask { std::move(other) }, m_handle { std::exchange(other.m_handle, nullptr) } {}
     ~ResumableTask() { if (m_handle) m_handle.destroy(); }
 
     ResumableTask(const ResumableTask& other) = delete;
     ResumableTask& operator=(ResumableTask&& other) = delete;
 
-    [[nodiscard]] auto done() const -> bool override { return m_handle.done();};
+    // A stopped task has no frame left
+    [[nodiscard]] auto done() const -> bool override { return not m_handle or m_handle.done(); };
 
     auto operator()() -> void override {
-        if (not areDependenciesMet())
+        if (done() or not areDependenciesMet() or suspended())
             return;
 
-        if (not m_handle.done())
-            m_handle.resume();
+        if (const auto reason { stopReason() }) {
+            // Destroyed before waiters go on, as what its locals refer to may go along with the task
+            std::exchange(m_handle, nullptr).destroy();
+            signalStop(*reason);
+            return;
+        }
+
+        // Awaitables reach the task through its promise, the task may have moved since the last run
+        m_handle.promise().m_task = this;
+
+        m_handle.resume();
 
         if (m_handle.done()) {
             signalCompletion();
         }
     }
 
-    [[nodiscard]] auto result() const -> Result<Res> { return m_handle.promise().m_result; };
+    [[nodiscard]] auto result() const -> Result<Res> { return Result<Res> { m_handle.promise().m_state }; };
 
 private:
     std::coroutine_handle<promise_type> m_handle;
@@ -45,35 +57,35 @@ private:
 
 template <typename Res>
 struct resumable_task_promise {
-    resumable_task_promise() :  m_promise {}, m_result { m_promise.get_future().share() } {}
+    resumable_task_promise() :  m_state { makeSharedState<Res>() }, m_task { nullptr } {}
 
     auto get_return_object() noexcept -> ResumableTask<Res> { return ResumableTask<Res>{ std::coroutine_handle<resumable_task_promise>::from_promise(*this)}; }
 
     static auto initial_suspend() noexcept -> std::suspend_always { return {}; }
     static auto final_suspend() noexcept -> std::suspend_always { return {}; }
 
-    static auto unhandled_exception() noexcept -> void {}
+    auto unhandled_exception() noexcept -> void { m_state->setException(std::current_exception()); }
 
-    auto return_value(Res&& value) -> void { m_promise.set_value(std::forward<Res>(value));  }
+    auto return_value(Res&& value) -> void { m_state->setValue(std::forward<Res>(value));  }
 
-    std::promise<Res> m_promise;
-    Result<Res> m_result;
+    StateReference<SharedState<Res>> m_state;
+    AsyncTask* m_task;
 };
 
 template <>
 struct resumable_task_promise<void> {
-    resumable_task_promise() :  m_promise {}, m_result { m_promise.get_future().share() } {}
+    resumable_task_promise() :  m_state { makeSharedState<void>() }, m_task { nullptr } {}
 
     auto get_return_object() noexcept -> ResumableTask<void> { return ResumableTask { std::coroutine_handle<resumable_task_promise>::from_promise(*this)}; }
     static auto initial_suspend() noexcept -> std::suspend_always { return {}; }
     static auto final_suspend() noexcept -> std::suspend_always { return {}; }
 
-    static auto unhandled_exception() noexcept -> void {}
+    auto unhandled_exception() noexcept -> void { m_state->setException(std::current_exception()); }
 
-    auto return_void() -> void { m_promise.set_value();  }
+    static auto return_void() -> void {}
 
-    std::promise<void> m_promise;
-    Result<void> m_result;
+    StateReference<SharedState<void>> m_state;
+    AsyncTask* m_task;
 };
 
 export template<typename Res>
@@ -0,0 +1,231 @@
+export module shared_state;
+
+import std;
+
+import task_pool;
+
+namespace async_task_scheduler {
+
+// Run by the thread completing a shared state. Nodes belong to whoever waits, states only link them
+export class Continuation {
+public:
+    Continuation() :  m_next { nullptr } {}
+    Continuation(const Continuation&) :  m_next { nullptr } {}
+    Continuation& operator=(const Continuation&) = delete;
+
+    virtual ~Continuation() = default;
+
+    virtual auto run() -> void = 0;
+
+private:
+    friend class SharedStateBase;
+
+    Continuation* m_next;
+};
+
+// Wakes up a thread waiting for a state with a timeout. Shared by the thread and the state, as a wait timing out can not
+// remove the continuation
+class TimedWakeUp final : public Continuation {
+public:
+    TimedWakeUp() :  m_completed { 0 }, m_references { 2 } {}
+
+    auto run() -> void override {
+        m_completed.release();
+        release();
+    }
+
+    [[nodiscard]] auto waitFor(const std::chrono::milliseconds timeout) -> bool { return m_completed.try_acquire_for(timeout); }
+
+    auto release() -> void {
+        if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+private:
+    std::binary_semaphore m_completed;
+    std::atomic<std::uint32_t> m_references;
+};
+
+// Completion of a task, shared by the task and its dependencies and results. Completion is an atomic flag and
+// continuations form a lock free list, so neither mutex nor condition variable is needed
+export class SharedStateBase {
+public:
+    SharedStateBase() :  m_references { 1 }, m_ready { 0 }, m_continuations { nullptr }, m_exception {}, m_cancelled { false } {}
+    virtual ~SharedStateBase() = default;
+
+    SharedStateBase(const SharedStateBase&) = delete;
+    SharedStateBase& operator=(const SharedStateBase&) = delete;
+
+    // One for each task, recycled rather than going back to the heap
+    [[nodiscard]] static auto operator new(const std::size_t size) -> void* { return TaskPool::allocate(size); }
+    [[nodiscard]] static auto operator new(const std::size_t size, const std::align_val_t alignment) -> void* { return TaskPool::allocate(size, alignment); }
+    static auto operator delete(void* state, const std::size_t size) noexcept -> void { TaskPool::deallocate(state, size); }
+    static auto operator delete(void* state, const std::size_t size, const std::align_val_t alignment) noexcept -> void {
+        TaskPool::deallocate(state, size, alignment);
+    }
+
+    auto acquire() -> void { m_references.fetch_add(1, std::memory_order_relaxed); }
+
+    auto release() -> void {
+        if (m_references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    [[nodiscard]] auto ready() const -> bool { return m_ready.load(std::memory_order_acquire) != 0; }
+    auto wait() const -> void { m_ready.wait(0, std::memory_order_acquire); }
+
+    // Atomic waits have no timeout, a timed wait blocks on a continuation of its own instead
+    [[nodiscard]] auto waitFor(const std::chrono::milliseconds timeout) -> bool {
+        if (ready()) {
+            return true;
+        }
+
+        auto* wakeUp { new TimedWakeUp {} };
+
+        if (not addContinuation(*wakeUp)) {
+            delete wakeUp;
+            return true;
+        }
+
+        const auto woken { wakeUp->waitFor(timeout) };
+        wakeUp->release();
+
+        return woken or ready();
+    }
+
+    // False when the state is already complete, the continuation is then not kept and the caller goes on itself
+    [[nodiscard]] auto addContinuation(Continuation& continuation) -> bool {
+        auto* head { m_continuations.load(std::memory_order_acquire) };
+
+        do {
+            if (head == completed()) {
+                return false;
+            }
+
+            continuation.m_next = head;
+        } while (not m_continuations.compare_exchange_weak(head, &continuation, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        return true;
+    }
+
+    auto setException(std::exception_ptr exception) -> void { m_exception = std::move(exception); }
+
+    // Before completion, for a task stopped rather than run. Tasks depending on it are stopped in turn
+    auto cancel(std::exception_ptr exception) -> void {
+        setException(std::move(exception));
+        m_cancelled = true;
+    }
+
+    // Once ready
+    [[nodiscard]] auto cancelled() const -> bool { return m_cancelled; }
+
+    // Once, by the owner of a reference. Continuations run on the calling thread, in the order they were added
+    auto complete() -> void {
+        m_ready.store(1, std::memory_order_release);
+        m_ready.notify_all();
+
+        Continuation* continuations { nullptr };
+
+        for (auto* continuation { m_continuations.exchange(completed(), std::memory_order_acq_rel) }; continuation != nullptr;) {
+            auto* next { continuation->m_next };
+            continuation->m_next = continuations;
+            continuations = continuation;
+            continuation = next;
+        }
+
+        // A continuation may free its node
+        while (continuations != nullptr) {
+            auto* next { continuations->m_next };
+            continuations->run();
+            continuations = next;
+        }
+    }
+
+    // Instead of completion, for a state that would never complete otherwise, as a destroyed promise does. Waiters see
+    // a broken promise error and continuations run, tasks depending on it are stopped as for a cancelled one
+    auto abandon() -> void {
+        cancel(std::make_exception_ptr(std::future_error { std::future_errc::broken_promise }));
+        complete();
+    }
+
+protected:
+    auto rethrow() const -> void {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+private:
+    // Never dereferenced, only marks the list as run
+    [[nodiscard]] auto completed() -> Continuation* { return reinterpret_cast<Continuation*>(this); }
+
+    std::atomic<std::uint32_t> m_references;
+    // Waited on directly by the platform, where a flag of another size would go through a proxy
+    std::atomic<std::uint32_t> m_ready;
+    std::atomic<Continuation*> m_continuations;
+    std::exception_ptr m_exception;
+    bool m_cancelled;
+};
+
+export template <typename Res>
+class SharedState final : public SharedStateBase {
+public:
+    SharedState() :  m_value {} {}
+
+    // Before completion
+    auto setValue(Res value) -> void { m_value.emplace(std::move(value)); }
+
+    [[nodiscard]] auto get() const -> const Res& {
+        wait();
+        rethrow();
+        return *m_value;
+    }
+
+private:
+    std::optional<Res> m_value;
+};
+
+template <>
+class SharedState<void> final : public SharedStateBase {
+public:
+    auto get() const -> void {
+        wait();
+        rethrow();
+    }
+};
+
+// Counted reference to a shared state
+export template <typename State>
+class StateReference final {
+public:
+    // Adopts the reference the state was created with
+    explicit StateReference(State* state) :  m_state { state } {}
+
+    StateReference(const StateReference& other) :  m_state { other.m_state } { if (m_state) m_state->acquire(); }
+    StateReference(StateReference&& other) noexcept :  m_state { std::exchange(other.m_state, nullptr) } {}
+
+    template <typename Other> requires std::derived_from<Other, State>
+    StateReference(const StateReference<Other>& other) :  m_state { other.get() } { if (m_state) m_state->acquire(); }
+
+    StateReference& operator=(StateReference other) noexcept {
+        std::swap(m_state, other.m_state);
+        return *this;
+    }
+
+    ~StateReference() { if (m_state) m_state->release(); }
+
+    [[nodiscard]] auto get() const -> State* { return m_state; }
+    auto operator->() const -> State* { return m_state; }
+
+private:
+    State* m_state;
+};
+
+export template <typename Res>
+[[nodiscard]] auto makeSharedState() -> StateReference<SharedState<Res>> {
+    return StateReference { new SharedState<Res> {} };
+}
+
+}
@@ -2,19 +2,34 @@ export module signal;
 
 import std;
 
+import shared_state;
+
 namespace async_task_scheduler {
 
 export class Signal final {
 public:
-    Signal() :  m_signal {}, m_result { m_signal.get_future() } {}
+    Signal() :  m_state { makeSharedState<void>() } {}
+    explicit Signal(StateReference<SharedStateBase> state) :  m_state { std::move(state) } {}
+
+    Signal(Signal&&) = default;
+    Signal& operator=(Signal&&) = default;
+
+    // A task destroyed before completing releases whoever waits for it
+    ~Signal() { abandon(); }
 
-    auto signalCompletion() -> void { m_signal.set_value(); }
-    [[nodiscard]] auto getFuture() const -> const std::shared_future<void>& { return m_result; }
+    auto signalCompletion() -> void { m_state->complete(); }
+
+    // Unless already complete
+    auto abandon() -> void {
+        if (m_state.get() != nullptr and not m_state->ready()) {
+            m_state->abandon();
+        }
+    }
+
+    [[nodiscard]] auto state() const -> const StateReference<SharedStateBase>& { return m_state; }
 
 private:
-    std::promise<void> m_signal;
-    std::shared_future<void> m_result;
+    StateReference<SharedStateBase> m_state;
 };
 
 }
-
@@ -1,20 +1,73 @@
+module;
+#if defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+    #define TASK_EXECUTOR_PAUSE
+    #include <emmintrin.h>
+#endif
+#include "trace_macros.h"
 module task_executor;
 
+import tracing;
+
 namespace async_task_scheduler {
 
-TaskExecutor::TaskExecutor()
+namespace {
+
+thread_local TaskExecutor* currentExecutor { nullptr };
+
+auto index(const Priority priority) -> std::size_t {
+    return static_cast<std::size_t>(priority);
+}
+
+// Lets the other hardware thread of the core run, and saves power, while spinning
+auto pause() -> void {
+#if defined(TASK_EXECUTOR_PAUSE)
+    _mm_pause();
+#elif defined(__aarch64__) and (defined(__GNUC__) or defined(__clang__))
+    __asm__ __volatile__("yield");
+#endif
+}
+
+}
+
+TaskExecutor::TaskExecutor(const Priority lowestPriority, ThreadConfiguration configuration)
  :  m_tasks {},
     m_pendingTasks {},
+    m_deques {},
+    m_notDoneTasks {},
+    m_lowestPriority { lowestPriority },
+    m_controlStreak { 0 },
+    m_parkedTaskAccess {},
+    m_parkedTasks {},
     m_taskAccess {},
     m_taskAvailable {},
+    m_wakeRequested { false },
+    m_isIdle { false },
+    m_wakeUps { 0 },
+    m_controlTaskEnqueued { false },
+    m_configuration { std::move(configuration) },
+    m_configurationResult {},
+    m_configurationApplied { 1 },
+    m_queueDepth { 0 },
+    m_tasksRun { 0 },
+    m_tasksStolen { 0 },
+    m_busyNanoseconds { 0 },
+    m_idleNanoseconds { 0 },
+    m_queueLatency {},
+    m_runTime {},
+    m_tracer { nullptr },
+    m_group { nullptr },
+    m_timer { nullptr },
+    m_groupIndex { 0 },
+    m_random { std::random_device {}() },
     m_taskExecutor { [this] (std::stop_token stopHandle) { executeTasks(stopHandle); } },
     m_executionHandle { m_taskExecutor.get_stop_source() } {}
 
 TaskExecutor::~TaskExecutor() {
-    m_executionHandle.request_stop();
+    stop();
+    abandonTasks();
 
-    if (m_taskExecutor.joinable()) {
-        m_taskExecutor.join();
+    for (auto* task: m_parkedTasks) {
+        delete task;
     }
 }
 
@@ -23,46 +76,447 @@ TaskExecutor::~TaskExecutor() {
     __declspec(no_sanitize_address)
 #endif
 auto TaskExecutor::enqueueTask(std::unique_ptr<AsyncTask> task) -> void {
+    const auto priority { task->priority() };
+
+    task->enqueuedAt(std::chrono::steady_clock::now());
+    // Counted first, so that a thief taking the task never counts it out before
+    m_queueDepth.fetch_add(1, std::memory_order_relaxed);
+
     {
         std::lock_guard lock(m_taskAccess);
-        m_tasks.emplace_back(std::move(task));
+        m_tasks[index(priority)].emplace_back(std::move(task));
     }
 
-    m_taskAvailable.notify_one();
+    notifyEnqueued(priority, priority);
+}
+
+auto TaskExecutor::enqueueTasks(std::vector<std::unique_ptr<AsyncTask>> tasks) -> void {
+    enqueueTasks(std::span { tasks });
+}
+
+auto TaskExecutor::enqueueTasks(const std::span<std::unique_ptr<AsyncTask>> tasks) -> void {
+    if (tasks.empty()) {
+        return;
+    }
+
+    auto highestPriority { Priority::Background };
+    auto lowestPriority { Priority::Control };
+    const auto enqueuedAt { std::chrono::steady_clock::now() };
+
+    m_queueDepth.fetch_add(tasks.size(), std::memory_order_relaxed);
+
+    {
+        std::lock_guard lock(m_taskAccess);
+
+        for (auto& task: tasks) {
+            const auto priority { task->priority() };
+
+            highestPriority = std::min(highestPriority, priority);
+            lowestPriority = std::max(lowestPriority, priority);
+            task->enqueuedAt(enqueuedAt);
+            m_tasks[index(priority)].emplace_back(std::move(task));
+        }
+    }
+
+    notifyEnqueued(highestPriority, lowestPriority);
+}
+
+auto TaskExecutor::configured() const -> std::expected<void, std::string> {
+    m_configurationApplied.wait();
+    return m_configurationResult;
+}
+
+auto TaskExecutor::group(const std::vector<std::unique_ptr<TaskExecutor>>* executors) -> void {
+    if (executors == nullptr) {
+        return;
+    }
+
+    if (const auto executor { std::ranges::find(*executors, this, &std::unique_ptr<TaskExecutor>::get) }; executor != executors->end()) {
+        m_groupIndex = static_cast<std::size_t>(std::ranges::distance(executors->begin(), executor));
+        m_group.store(executors, std::memory_order_release);
+    }
+}
+
+auto TaskExecutor::stop() -> void {
+    m_executionHandle.request_stop();
+
+    if (m_taskExecutor.joinable()) {
+        m_taskExecutor.join();
+    }
+}
+
+auto TaskExecutor::abandonTasks() -> void {
+    std::vector<AsyncTask*> tasks {};
+
+    {
+        std::scoped_lock lock { m_taskAccess, m_parkedTaskAccess };
+
+        // Kept in the queues, which own them
+        for (auto& deque: m_deques) {
+            while (auto* task { deque.pop() }) {
+                m_tasks[index(task->priority())].emplace_back(task);
+            }
+        }
+
+        for (auto* task: std::exchange(m_notDoneTasks, {})) {
+            m_tasks[index(task->priority())].emplace_back(task);
+        }
+
+        for (const auto& queue: m_tasks) {
+            std::ranges::copy(queue | std::views::transform(&std::unique_ptr<AsyncTask>::get), std::back_inserter(tasks));
+        }
+
+        std::ranges::copy(m_parkedTasks, std::back_inserter(tasks));
+    }
+
+    // Tasks waiting for them may be unparked meanwhile, they only move to the queues
+    for (auto* task: tasks) {
+        task->abandon();
+    }
+}
+
+auto TaskExecutor::timer(Timer* timer) -> void {
+    m_timer.store(timer, std::memory_order_release);
+}
+
+auto TaskExecutor::timer() const -> Timer* {
+    return m_timer.load(std::memory_order_acquire);
+}
+
+auto TaskExecutor::statistics() const -> ExecutorStatistics {
+    return ExecutorStatistics {
+        m_configuration.m_name,
+        m_lowestPriority,
+        m_queueDepth.load(std::memory_order_relaxed),
+        m_tasksRun.load(std::memory_order_relaxed),
+        m_tasksStolen.load(std::memory_order_relaxed),
+        std::chrono::nanoseconds { m_busyNanoseconds.load(std::memory_order_relaxed) },
+        std::chrono::nanoseconds { m_idleNanoseconds.load(std::memory_order_relaxed) },
+        m_queueLatency.snapshot(),
+        m_runTime.snapshot()
+    };
+}
+
+auto TaskExecutor::tracer(const TaskTracer* tracer) -> void {
+    m_tracer.store(tracer, std::memory_order_release);
+}
+
+auto TaskExecutor::current() -> TaskExecutor* {
+    return currentExecutor;
 }
 
 auto TaskExecutor::executeTasks(const std::stop_token& stopHandle) -> void {
+    currentExecutor = this;
+
+    m_configurationResult = configureCurrentThread(m_configuration);
+    TRACE_THREAD_NAME(m_configuration.m_name);
+    m_configurationApplied.count_down();
+
     do {
-        {
-            std::unique_lock lock(m_taskAccess);
+        // Before the tasks are taken, so that spinning ends on any task enqueued after
+        const auto wakeUps { m_wakeUps.load(std::memory_order_acquire) };
 
-            if (m_tasks.empty()) {
-                m_taskAvailable.wait(lock, stopHandle, [this, &stopHandle] () { return not m_tasks.empty() || stopHandle.stop_requested(); });
-            }
+        takeEnqueuedTasks();
 
-            m_pendingTasks.swap(m_tasks);
+        auto ranTask { false };
+
+        while (auto* task { nextTask() }) {
+            m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+            runTask(task);
+            ranTask = true;
         }
 
-        for (auto& task : m_pendingTasks) {
-            (*task)();
+        if (not ranTask) {
+            // Checked again by thieves before sleeping, so that a wake up sent meanwhile is not missed
+            m_isIdle.store(true, std::memory_order_seq_cst);
+
+            if (auto* task { stealTask() }) {
+                m_isIdle.store(false, std::memory_order_relaxed);
+                runTask(task);
+                ranTask = true;
+            }
         }
 
-        m_pendingTasks.erase(std::remove_if(std::ranges::begin(m_pendingTasks), std::ranges::end(m_pendingTasks),
-            [] (const std::unique_ptr<AsyncTask>& task) { return task->done(); }), std::ranges::end(m_pendingTasks));
-        {
-            std::unique_lock lock(m_taskAccess);
+        // Coroutines that only yielded get another turn on the next round, and can be stolen meanwhile
+        const auto yieldedAt { std::chrono::steady_clock::now() };
+        m_queueDepth.fetch_add(m_notDoneTasks.size(), std::memory_order_relaxed);
 
-            m_tasks.insert(std::ranges::end(m_tasks),
-                std::make_move_iterator(std::ranges::begin(m_pendingTasks)),
-                std::make_move_iterator(std::ranges::end(m_pendingTasks)));
+        for (auto* task : m_notDoneTasks | std::views::reverse) {
+            task->enqueuedAt(yieldedAt);
+            m_deques[index(task->priority())].push(task);
         }
 
-        m_pendingTasks.clear();
+        m_notDoneTasks.clear();
+
+        if (not ranTask) {
+            const auto idleSince { std::chrono::steady_clock::now() };
+
+            if (not spin(wakeUps, stopHandle)) {
+                std::unique_lock lock(m_taskAccess);
+
+                m_taskAvailable.wait(lock, stopHandle, [this] () {
+                    return m_wakeRequested or std::ranges::any_of(m_tasks, [] (const auto& tasks) { return not tasks.empty(); });
+                });
+
+                m_wakeRequested = false;
+            }
+
+            m_isIdle.store(false, std::memory_order_relaxed);
+
+            m_idleNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - idleSince).count(),
+                std::memory_order_relaxed);
+        }
     } while (not stopHandle.stop_requested());
 }
 
-auto makeTaskExecutor() -> std::unique_ptr<TaskExecutor> {
-    return std::make_unique<TaskExecutor>();
+auto TaskExecutor::runTask(AsyncTask* task) -> void {
+    if (task->waiting()) {
+        park(task);
+        return;
+    }
+
+    const auto startedAt { std::chrono::steady_clock::now() };
+    (*task)();
+    recordRun(*task, startedAt, std::chrono::steady_clock::now());
+
+    if (task->done()) {
+        delete task;
+    } else if (auto handOver { task->takeHandOver() }) {
+        handOver(std::unique_ptr<AsyncTask> { task });
+    } else if (task->waiting()) {
+        park(task);
+    } else {
+        m_notDoneTasks.push_back(task);
+    }
+}
+
+auto TaskExecutor::recordRun(const AsyncTask& task, const std::chrono::steady_clock::time_point startedAt,
+        const std::chrono::steady_clock::time_point finishedAt) -> void {
+    m_tasksRun.fetch_add(1, std::memory_order_relaxed);
+    m_busyNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(finishedAt - startedAt).count(), std::memory_order_relaxed);
+    m_queueLatency.record(startedAt - task.enqueuedAt());
+    m_runTime.record(finishedAt - startedAt);
+    TRACE_COMPLETE("scheduler", task.priority() == Priority::Control ? "control task" : "background task", startedAt, finishedAt);
+
+    if (const auto* tracer { m_tracer.load(std::memory_order_acquire) }) {
+        (*tracer)(TaskTrace { m_groupIndex, task.priority(), task.enqueuedAt(), startedAt, finishedAt });
+    }
+}
+
+auto TaskExecutor::park(AsyncTask* task) -> void {
+    {
+        std::lock_guard lock { m_parkedTaskAccess };
+        m_parkedTasks.insert(task);
+    }
+
+    // Ready meanwhile
+    if (not task->whenReady([this, task] () { unpark(task); })) {
+        unpark(task);
+    }
+}
+
+auto TaskExecutor::unpark(AsyncTask* task) -> void {
+    {
+        std::lock_guard lock { m_parkedTaskAccess };
+
+        if (m_parkedTasks.erase(task) == 0) {
+            return;
+        }
+    }
+
+    enqueueTask(std::unique_ptr<AsyncTask> { task });
+}
+
+auto TaskExecutor::spin(const std::uint64_t wakeUps, const std::stop_token& stopHandle) const -> bool {
+    const auto& policy { m_configuration.m_idlePolicy };
+
+    if (policy.m_spinFor <= std::chrono::nanoseconds::zero() and policy.m_yieldFor <= std::chrono::nanoseconds::zero()) {
+        return false;
+    }
+
+    static const bool singleCore { std::thread::hardware_concurrency() == 1 };
+
+    const auto spinUntil { std::chrono::steady_clock::now() + policy.m_spinFor };
+    const auto yieldUntil { spinUntil + policy.m_yieldFor };
+
+    while (m_wakeUps.load(std::memory_order_acquire) == wakeUps and not stopHandle.stop_requested()) {
+        const auto now { std::chrono::steady_clock::now() };
+
+        if (now >= yieldUntil) {
+            return false;
+        }
+
+        // On a single core, spinning would only keep the thread about to enqueue from running
+        if (now < spinUntil and not singleCore) {
+            pause();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    return true;
+}
+
+auto TaskExecutor::takeEnqueuedTasks() -> void {
+    // Cleared first, a control task enqueued once the lock is released sets it again
+    m_controlTaskEnqueued.store(false, std::memory_order_relaxed);
+
+    {
+        std::unique_lock lock(m_taskAccess);
+
+        for (std::size_t i { 0 }; i < priorityCount; ++i) {
+            m_pendingTasks[i].swap(m_tasks[i]);
+        }
+
+        // Looking for tasks answers the wake ups sent so far, one left over would end the next spin or sleep early
+        m_wakeRequested = false;
+    }
+
+    for (std::size_t i { 0 }; i < priorityCount; ++i) {
+        // Newest first, so that tasks are popped in the order they were enqueued
+        for (auto& task : m_pendingTasks[i] | std::views::reverse) {
+            m_deques[i].push(task.release());
+        }
+
+        m_pendingTasks[i].clear();
+
+        // Tasks it does not run are left to the others
+        if (const auto priority { static_cast<Priority>(i) }; m_deques[i].size() > (runs(priority) ? 1u : 0u)) {
+            wakeIdleExecutor(priority);
+        }
+    }
+}
+
+auto TaskExecutor::nextTask() -> AsyncTask* {
+    // Control tasks enqueued meanwhile go before the tasks already in the deques
+    if (m_controlTaskEnqueued.exchange(false, std::memory_order_relaxed)) {
+        takeEnqueuedTasks();
+    }
+
+    auto& controlTasks { m_deques[index(Priority::Control)] };
+    auto& backgroundTasks { m_deques[index(Priority::Background)] };
+
+    if (m_controlStreak < maxControlStreak or not runs(Priority::Background) or backgroundTasks.empty()) {
+        if (auto* task { controlTasks.pop() }) {
+            ++m_controlStreak;
+            return task;
+        }
+    }
+
+    m_controlStreak = 0;
+
+    if (runs(Priority::Background)) {
+        if (auto* task { backgroundTasks.pop() }) {
+            return task;
+        }
+    }
+
+    // The background task was stolen meanwhile
+    return controlTasks.pop();
+}
+
+auto TaskExecutor::stealTask() -> AsyncTask* {
+    const auto* group { m_group.load(std::memory_order_acquire) };
+
+    if (group == nullptr or group->size() < 2) {
+        return nullptr;
+    }
+
+    // Random victims spread thieves over the busy executors
+    const auto first { static_cast<std::size_t>(m_random()) % group->size() };
+
+    // Control tasks of every executor first
+    for (const auto priority: { Priority::Control, Priority::Background }) {
+        if (not runs(priority)) {
+            continue;
+        }
+
+        for (std::size_t i { 0 }; i < group->size(); ++i) {
+            auto& executor { *(*group)[(first + i) % group->size()] };
+
+            if (&executor == this) {
+                continue;
+            }
+
+            auto* task { executor.m_deques[index(priority)].steal() };
+
+            if (task == nullptr) {
+                task = executor.takeEnqueuedTask(priority).release();
+            }
+
+            if (task != nullptr) {
+                executor.m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+                m_tasksStolen.fetch_add(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+auto TaskExecutor::takeEnqueuedTask(const Priority priority) -> std::unique_ptr<AsyncTask> {
+    std::unique_lock lock(m_taskAccess, std::try_to_lock);
+
+    auto& tasks { m_tasks[index(priority)] };
+
+    if (not lock.owns_lock() or tasks.empty()) {
+        return nullptr;
+    }
+
+    auto task { std::move(tasks.back()) };
+    tasks.pop_back();
+
+    return task;
 }
 
-}
\ No newline at end of file
+auto TaskExecutor::notifyEnqueued(const Priority highestPriority, const Priority lowestPriority) -> void {
+    // The tasks themselves go through the lock
+    if (highestPriority == Priority::Control) {
+        m_controlTaskEnqueued.store(true, std::memory_order_relaxed);
+    }
+
+    m_wakeUps.fetch_add(1, std::memory_order_release);
+    m_taskAvailable.notify_one();
+
+    // A busy executor, or one not running such tasks, would leave them waiting while another one may be idle
+    if (not runs(lowestPriority) or not m_isIdle.load(std::memory_order_seq_cst)) {
+        wakeIdleExecutor(lowestPriority);
+    }
+}
+
+auto TaskExecutor::runs(const Priority priority) const -> bool {
+    return priority <= m_lowestPriority;
+}
+
+auto TaskExecutor::wakeIdleExecutor(const Priority priority) -> void {
+    const auto* group { m_group.load(std::memory_order_acquire) };
+
+    if (group == nullptr) {
+        return;
+    }
+
+    for (std::size_t i { 1 }; i < group->size(); ++i) {
+        if (auto& executor { *(*group)[(m_groupIndex + i) % group->size()] };
+                executor.runs(priority) and executor.m_isIdle.load(std::memory_order_seq_cst)) {
+            executor.wake();
+            return;
+        }
+    }
+}
+
+auto TaskExecutor::wake() -> void {
+    {
+        std::lock_guard lock(m_taskAccess);
+        m_wakeRequested = true;
+    }
+
+    m_wakeUps.fetch_add(1, std::memory_order_release);
+    m_taskAvailable.notify_one();
+}
+
+auto makeTaskExecutor(const Priority lowestPriority, ThreadConfiguration configuration) -> std::unique_ptr<TaskExecutor> {
+    return std::make_unique<TaskExecutor>(lowestPriority, std::move(configuration));
+}
+
+}
@@ -3,29 +3,132 @@ export module task_executor;
 import std;
 
 import async_task;
+import executor_statistics;
+import thread_configuration;
+import timer;
+import work_stealing_deque;
 
 namespace async_task_scheduler {
 
+constexpr std::size_t priorityCount { 2 };
+
+// Runs its tasks on its own thread. Tasks enqueued from any thread land in m_tasks, the executor moves them to its deques,
+// where executors of the same group steal them once they run out of tasks of their own. The thread sleeps when no task is
+// ready to run, once it has spun for as long as its idle policy says. Each priority has its queue and deque, control tasks run first but a background task gets a turn after
+// a run of control tasks, so that it is not starved
 export class TaskExecutor final {
 public:
-    TaskExecutor();
+    // Executors reserved to control tasks leave background ones to the other executors of their group
+    explicit TaskExecutor(Priority lowestPriority = Priority::Background, ThreadConfiguration configuration = {});
     ~TaskExecutor();
 
+    // Waits for the thread to apply its configuration, it runs with the platform defaults when it could not
+    [[nodiscard]] auto configured() const -> std::expected<void, std::string>;
+
     auto enqueueTask(std::unique_ptr<AsyncTask> task) -> void;
+    // Under a single lock, waking the executor once
+    auto enqueueTasks(std::vector<std::unique_ptr<AsyncTask>> tasks) -> void;
+    // Moves the tasks out, the caller keeps the storage for its next batch
+    auto enqueueTasks(std::span<std::unique_ptr<AsyncTask>> tasks) -> void;
+
+    // Executors the executor steals from and wakes up when it has work to spare. The group must not change
+    // and every executor in it has to be stopped before any of them is destroyed
+    auto group(const std::vector<std::unique_ptr<TaskExecutor>>* executors) -> void;
+
+    // Tasks left are destroyed with the executor
+    auto stop() -> void;
+
+    // Once stopped, releases whoever waits for the tasks left before any of them is destroyed, so that no continuation
+    // runs on a destroyed task. Called by the destructor, every executor of a group has to call it before any is destroyed
+    auto abandonTasks() -> void;
+
+    // Timer awaitables of its tasks rely on, it has to outlive the executor
+    auto timer(Timer* timer) -> void;
+    [[nodiscard]] auto timer() const -> Timer*;
+
+    // Read without stopping the executor
+    [[nodiscard]] auto statistics() const -> ExecutorStatistics;
+
+    // Called after each run of a task, none when null. The tracer has to outlive the executor or its replacement
+    auto tracer(const TaskTracer* tracer) -> void;
+
+    // Executor running on the calling thread, if any
+    [[nodiscard]] static auto current() -> TaskExecutor*;
 
 protected:
     auto executeTasks(const std::stop_token& stopHandle) -> void;
+    auto runTask(AsyncTask* task) -> void;
+    auto recordRun(const AsyncTask& task, std::chrono::steady_clock::time_point startedAt,
+        std::chrono::steady_clock::time_point finishedAt) -> void;
+
+    // Tasks waiting for dependencies or for what they awaited are set aside until it completes
+    auto park(AsyncTask* task) -> void;
+    auto unpark(AsyncTask* task) -> void;
+
+    // Until anything is enqueued or a wake up is sent, false once the policy of the executor says to sleep instead
+    [[nodiscard]] auto spin(std::uint64_t wakeUps, const std::stop_token& stopHandle) const -> bool;
+
+    auto takeEnqueuedTasks() -> void;
+    [[nodiscard]] auto nextTask() -> AsyncTask*;
 
-    std::vector<std::unique_ptr<AsyncTask>> m_tasks;
-    std::vector<std::unique_ptr<AsyncTask>> m_pendingTasks;
+    [[nodiscard]] auto stealTask() -> AsyncTask*;
+    [[nodiscard]] auto takeEnqueuedTask(Priority priority) -> std::unique_ptr<AsyncTask>;
+
+    auto notifyEnqueued(Priority highestPriority, Priority lowestPriority) -> void;
+
+    [[nodiscard]] auto runs(Priority priority) const -> bool;
+    auto wakeIdleExecutor(Priority priority) -> void;
+    auto wake() -> void;
+
+    std::array<std::vector<std::unique_ptr<AsyncTask>>, priorityCount> m_tasks;
+    std::array<std::vector<std::unique_ptr<AsyncTask>>, priorityCount> m_pendingTasks;
+
+    // Owned by the executor while in there, tasks are released to be shared with thieves
+    std::array<WorkStealingDeque<AsyncTask*>, priorityCount> m_deques;
+    std::vector<AsyncTask*> m_notDoneTasks;
 
 private:
+    // Control tasks run in a row before a waiting background task gets its turn
+    static constexpr std::size_t maxControlStreak { 16 };
+
+    Priority m_lowestPriority;
+    std::size_t m_controlStreak;
+
+    std::mutex m_parkedTaskAccess;
+    std::unordered_set<AsyncTask*> m_parkedTasks;
+
     std::mutex m_taskAccess;
     std::condition_variable_any m_taskAvailable;
+    bool m_wakeRequested;
+    std::atomic_bool m_isIdle;
+    // Counts enqueues and wake ups, which an idle executor watches while spinning
+    std::atomic<std::uint64_t> m_wakeUps;
+    // Control tasks enqueued while it runs are taken before its next task rather than after its deques are empty
+    std::atomic_bool m_controlTaskEnqueued;
+
+    ThreadConfiguration m_configuration;
+    std::expected<void, std::string> m_configurationResult;
+    std::latch m_configurationApplied;
+
+    // Written by the executor thread alone, except for the queue depth
+    std::atomic<std::size_t> m_queueDepth;
+    std::atomic<std::uint64_t> m_tasksRun;
+    std::atomic<std::uint64_t> m_tasksStolen;
+    std::atomic<std::int64_t> m_busyNanoseconds;
+    std::atomic<std::int64_t> m_idleNanoseconds;
+    AtomicHistogram m_queueLatency;
+    AtomicHistogram m_runTime;
+    std::atomic<const TaskTracer*> m_tracer;
+
+    std::atomic<const std::vector<std::unique_ptr<TaskExecutor>>*> m_group;
+    std::atomic<Timer*> m_timer;
+    std::size_t m_groupIndex;
+    std::minstd_rand m_random;
+
     std::jthread m_taskExecutor;
     std::stop_source m_executionHandle;
 };
 
-export auto makeTaskExecutor() -> std::unique_ptr<TaskExecutor>;
+export auto makeTaskExecutor(Priority lowestPriority = Priority::Background, ThreadConfiguration configuration = {}) -> std::unique_ptr<TaskExecutor>;
 
-}
\ No newline at end of file
+}
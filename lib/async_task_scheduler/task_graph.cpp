@@ -0,0 +1,258 @@
+module task_graph;
+
+namespace async_task_scheduler {
+
+TaskGraph::TaskGraph()
+ :  m_nodes {},
+    m_sources {},
+    m_validated { true },
+    m_pendingPredecessors { nullptr },
+    m_pendingPredecessorCapacity { 0 },
+    m_scheduler { nullptr },
+    m_stopToken {},
+    m_remainingNodes { 0 },
+    m_failed { false },
+    m_nextThreadId { 0 },
+    m_state { std::nullopt },
+    m_lastRun { std::nullopt } {}
+
+TaskGraph::~TaskGraph() {
+    if (m_lastRun.has_value()) {
+        m_lastRun->wait();
+    }
+}
+
+auto TaskGraph::node(std::move_only_function<void()> function, const Priority priority) -> NodeId_t {
+    m_nodes.push_back(Node { std::move(function), priority, {}, 0 });
+    m_validated = false;
+
+    return m_nodes.size() - 1;
+}
+
+auto TaskGraph::edge(const NodeId_t from, const NodeId_t to) -> std::expected<void, std::string> {
+    if (from >= m_nodes.size() or to >= m_nodes.size())
+        return std::unexpected { std::string { "Unknown node" } };
+
+    m_nodes[from].m_successors.push_back(to);
+    m_validated = false;
+
+    return {};
+}
+
+auto TaskGraph::size() const -> std::size_t {
+    return m_nodes.size();
+}
+
+auto TaskGraph::validate() -> std::expected<void, std::string> {
+    if (m_validated) {
+        return {};
+    }
+
+    for (auto& node: m_nodes) {
+        node.m_predecessorCount = 0;
+    }
+
+    for (const auto& node: m_nodes) {
+        for (const auto successor: node.m_successors) {
+            ++m_nodes[successor].m_predecessorCount;
+        }
+    }
+
+    m_sources.clear();
+
+    for (NodeId_t i { 0 }; i < m_nodes.size(); ++i) {
+        if (m_nodes[i].m_predecessorCount == 0) {
+            m_sources.push_back(i);
+        }
+    }
+
+    // Nodes left once every node reachable from the sources is removed are on a cycle
+    std::vector<std::size_t> predecessorCounts(m_nodes.size());
+    std::ranges::transform(m_nodes, predecessorCounts.begin(), &Node::m_predecessorCount);
+
+    std::vector<NodeId_t> readyNodes { m_sources };
+    std::size_t visitedNodes { 0 };
+
+    while (not readyNodes.empty()) {
+        const auto nodeId { readyNodes.back() };
+        readyNodes.pop_back();
+        ++visitedNodes;
+
+        for (const auto successor: m_nodes[nodeId].m_successors) {
+            if (--predecessorCounts[successor] == 0) {
+                readyNodes.push_back(successor);
+            }
+        }
+    }
+
+    if (visitedNodes != m_nodes.size())
+        return std::unexpected { std::string { "Graph has a cycle" } };
+
+    if (m_pendingPredecessorCapacity < m_nodes.size()) {
+        m_pendingPredecessors = std::make_unique<std::atomic<std::size_t>[]>(m_nodes.size());
+        m_pendingPredecessorCapacity = m_nodes.size();
+    }
+
+    m_validated = true;
+    return {};
+}
+
+auto TaskGraph::run(AsyncTaskScheduler& scheduler, std::stop_token stopToken) -> std::expected<Result<void>, std::string> {
+    if (m_lastRun.has_value() and not m_lastRun->ready())
+        return std::unexpected { std::string { "Graph already running" } };
+
+    if (auto validated { validate() }; not validated.has_value())
+        return std::unexpected { validated.error() };
+
+    auto state { makeSharedState<void>() };
+    Result<void> result { state };
+    m_lastRun.emplace(result);
+
+    if (m_nodes.empty()) {
+        state->complete();
+        return result;
+    }
+
+    for (NodeId_t i { 0 }; i < m_nodes.size(); ++i) {
+        m_pendingPredecessors[i].store(m_nodes[i].m_predecessorCount, std::memory_order_relaxed);
+    }
+
+    m_scheduler = &scheduler;
+    m_stopToken = std::move(stopToken);
+    m_remainingNodes.store(m_nodes.size(), std::memory_order_relaxed);
+    m_failed.store(false, std::memory_order_relaxed);
+    m_state.emplace(std::move(state));
+
+    std::vector<std::unique_ptr<AsyncTask>> tasks {};
+    tasks.reserve(m_sources.size());
+
+    for (const auto source: m_sources) {
+        tasks.push_back(makeNodeTask(source));
+    }
+
+    scheduler.enqueueTasks(std::move(tasks), m_nextThreadId.fetch_add(static_cast<unsigned int>(m_sources.size()), std::memory_order_relaxed)
+        % scheduler.concurrencyLevel());
+
+    return result;
+}
+
+auto TaskGraph::runNode(NodeId_t nodeId) -> void {
+    while (true) {
+        auto& node { m_nodes[nodeId] };
+
+        if (m_stopToken.stop_requested()) {
+            fail(std::make_exception_ptr(std::system_error { std::make_error_code(std::errc::operation_canceled) }));
+        }
+
+        if (not m_failed.load(std::memory_order_relaxed)) {
+            try {
+                node.m_function();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        }
+
+        // Run next on this thread, saving a round through the queues. Only one of the same priority, so that
+        // control nodes do not wait behind background ones
+        std::optional<NodeId_t> nextNodeId {};
+
+        for (const auto successor: node.m_successors) {
+            if (m_pendingPredecessors[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                continue;
+            }
+
+            if (not nextNodeId.has_value() and m_nodes[successor].m_priority == node.m_priority) {
+                nextNodeId = successor;
+            } else {
+                enqueueNode(successor);
+            }
+        }
+
+        // The graph may be run again or destroyed once the last node is done
+        if (m_remainingNodes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            complete();
+            return;
+        }
+
+        if (not nextNodeId.has_value()) {
+            return;
+        }
+
+        nodeId = *nextNodeId;
+    }
+}
+
+auto TaskGraph::abandonNode(const NodeId_t nodeId) -> void {
+    fail(std::make_exception_ptr(std::future_error { std::future_errc::broken_promise }));
+
+    // Successors left waiting for it are skipped here as well, the executors may not take tasks anymore
+    std::vector<NodeId_t> skippedNodes { nodeId };
+
+    while (not skippedNodes.empty()) {
+        const auto skippedNodeId { skippedNodes.back() };
+        skippedNodes.pop_back();
+
+        for (const auto successor: m_nodes[skippedNodeId].m_successors) {
+            if (m_pendingPredecessors[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                skippedNodes.push_back(successor);
+            }
+        }
+
+        if (m_remainingNodes.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            complete();
+            return;
+        }
+    }
+}
+
+auto TaskGraph::enqueueNode(const NodeId_t nodeId) -> void {
+    auto task { makeNodeTask(nodeId) };
+
+    // Control nodes go through the scheduler, to the executors reserved to them
+    if (auto* executor { TaskExecutor::current() }; executor != nullptr and task->priority() == Priority::Background) {
+        executor->enqueueTask(std::move(task));
+    } else {
+        m_scheduler->enqueueTask(std::move(task), m_nextThreadId.fetch_add(1, std::memory_order_relaxed) % m_scheduler->concurrencyLevel());
+    }
+}
+
+auto TaskGraph::fail(std::exception_ptr exception) -> void {
+    if (not m_failed.exchange(true, std::memory_order_relaxed)) {
+        (*m_state)->setException(std::move(exception));
+    }
+}
+
+auto TaskGraph::complete() -> void {
+    // Once complete, the graph may be run again or destroyed: only the state is left to touch
+    const auto state { std::move(*m_state) };
+    m_state.reset();
+
+    state->complete();
+}
+
+auto TaskGraph::makeNodeTask(const NodeId_t nodeId) -> std::unique_ptr<AsyncTask> {
+    auto task { makeAtomicTask(NodeFunction { *this, nodeId }) };
+    task->priority(m_nodes[nodeId].m_priority);
+
+    return task;
+}
+
+TaskGraph::NodeFunction::NodeFunction(TaskGraph& graph, const NodeId_t nodeId)
+ :  m_graph { &graph },
+    m_nodeId { nodeId } {}
+
+TaskGraph::NodeFunction::~NodeFunction() {
+    if (m_graph != nullptr) {
+        m_graph->abandonNode(m_nodeId);
+    }
+}
+
+TaskGraph::NodeFunction::NodeFunction(NodeFunction&& other) noexcept
+ :  m_graph { std::exchange(other.m_graph, nullptr) },
+    m_nodeId { other.m_nodeId } {}
+
+auto TaskGraph::NodeFunction::operator()() -> void {
+    std::exchange(m_graph, nullptr)->runNode(m_nodeId);
+}
+
+}
@@ -0,0 +1,93 @@
+export module task_graph;
+
+import std;
+
+import async_task_scheduler;
+
+namespace async_task_scheduler {
+
+export using NodeId_t = std::size_t;
+
+// Nodes and the edges between them, built once and run as many times as needed. Every node counts the predecessors it
+// waits for, the node completing the last one dispatches it: it runs the first node it made ready itself and enqueues
+// the other ones. A run only allocates the tasks handed to executors and the state of its result.
+// The graph can not change while it runs
+export class TaskGraph final {
+public:
+    TaskGraph();
+    // Waits for the run under way. Nodes whose task is destroyed without running, e.g. by a scheduler shutting down,
+    // fail it with a broken promise error
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+    TaskGraph(TaskGraph&&) = delete;
+    TaskGraph& operator=(TaskGraph&&) = delete;
+
+    // Called once per run, on any executor
+    auto node(std::move_only_function<void()> function, Priority priority = Priority::Background) -> NodeId_t;
+
+    // `to` runs once `from` has run
+    auto edge(NodeId_t from, NodeId_t to) -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    // Checks the graph is acyclic and counts the predecessors of every node. Run does it when the graph changed since
+    [[nodiscard]] auto validate() -> std::expected<void, std::string>;
+
+    // Enqueues the nodes without predecessors in one batch. The first exception thrown is the one of the result, nodes not
+    // started by then are skipped, as they are once stop is requested
+    [[nodiscard]] auto run(AsyncTaskScheduler& scheduler, std::stop_token stopToken = {}) -> std::expected<Result<void>, std::string>;
+
+private:
+    struct Node {
+        std::move_only_function<void()> m_function;
+        Priority m_priority;
+        std::vector<NodeId_t> m_successors;
+        std::size_t m_predecessorCount;
+    };
+
+    // What a node task runs, it skips its node when destroyed without running so that the run still completes
+    class NodeFunction final {
+    public:
+        NodeFunction(TaskGraph& graph, NodeId_t nodeId);
+        ~NodeFunction();
+
+        NodeFunction(NodeFunction&& other) noexcept;
+        NodeFunction(const NodeFunction&) = delete;
+        NodeFunction& operator=(const NodeFunction&) = delete;
+        NodeFunction& operator=(NodeFunction&&) = delete;
+
+        auto operator()() -> void;
+
+    private:
+        TaskGraph* m_graph;
+        NodeId_t m_nodeId;
+    };
+
+    auto runNode(NodeId_t nodeId) -> void;
+    auto abandonNode(NodeId_t nodeId) -> void;
+    auto enqueueNode(NodeId_t nodeId) -> void;
+    auto fail(std::exception_ptr exception) -> void;
+    auto complete() -> void;
+
+    [[nodiscard]] auto makeNodeTask(NodeId_t nodeId) -> std::unique_ptr<AsyncTask>;
+
+    std::vector<Node> m_nodes;
+    std::vector<NodeId_t> m_sources;
+    bool m_validated;
+
+    // Counted down by every run, from the predecessor counts
+    std::unique_ptr<std::atomic<std::size_t>[]> m_pendingPredecessors;
+    std::size_t m_pendingPredecessorCapacity;
+
+    AsyncTaskScheduler* m_scheduler;
+    std::stop_token m_stopToken;
+    std::atomic<std::size_t> m_remainingNodes;
+    std::atomic_bool m_failed;
+    std::atomic<unsigned int> m_nextThreadId;
+    std::optional<StateReference<SharedState<void>>> m_state;
+    std::optional<Result<void>> m_lastRun;
+};
+
+}
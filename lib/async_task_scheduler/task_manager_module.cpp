@@ -13,20 +13,26 @@ public:
     auto enqueueTasks(Task&&... tasks) -> void {
 
         if constexpr (sizeof...(Task) == 1) {
-            m_scheduler.enqueueTask(std::move(tasks...), m_threadId);
-            updateThreadId();
+            m_scheduler.enqueueTask(std::move(tasks...), nextThreadId());
         } else {
-            std::vector<std::unique_ptr<AsyncTask>> taskVector {};
-            taskVector.reserve(sizeof...(tasks));
-            (taskVector.emplace_back(std::forward<Task>(tasks)), ...);
-
-            for (auto& task: taskVector) {
-                m_scheduler.enqueueTask(std::move(task), m_threadId);
-                updateThreadId();
-            }
+            std::array<std::unique_ptr<AsyncTask>, sizeof...(Task)> taskArray { std::forward<Task>(tasks)... };
+            m_scheduler.enqueueTasks(std::span { taskArray }, nextThreadId(taskArray.size()));
         }
     }
 
+    // Each executor is locked and woken once for the whole batch
+    auto enqueueTasks(std::vector<std::unique_ptr<AsyncTask>> tasks) -> void {
+        const auto threadId { nextThreadId(tasks.size()) };
+        m_scheduler.enqueueTasks(std::move(tasks), threadId);
+    }
+
+    // Tasks enqueued without a priority keep theirs, background unless set
+    template <typename... Task> requires (std::is_convertible_v<Task, std::unique_ptr<AsyncTask>> && ...) and (sizeof...(Task) > 0)
+    auto enqueueTasks(const Priority priority, Task&&... tasks) -> void {
+        (tasks->priority(priority), ...);
+        enqueueTasks(std::forward<Task>(tasks)...);
+    }
+
     explicit TaskManager(AsyncTaskScheduler& scheduler)
      :  m_scheduler { scheduler },
         m_concurrencyLevel { m_scheduler.concurrencyLevel() },
@@ -35,11 +41,15 @@ public:
     virtual ~TaskManager() = default;
 
 private:
-    auto updateThreadId() -> void { m_threadId = (m_threadId + 1) % m_scheduler.concurrencyLevel(); }
+    // Tasks may enqueue further tasks from executor threads, so the round robin counter is shared
+    // First of as many thread ids as tasks
+    auto nextThreadId(const std::size_t taskCount = 1) -> unsigned int {
+        return m_threadId.fetch_add(static_cast<unsigned int>(taskCount), std::memory_order_relaxed) % m_concurrencyLevel;
+    }
 
     AsyncTaskScheduler& m_scheduler;
     unsigned int m_concurrencyLevel;
-    unsigned int m_threadId;
+    std::atomic<unsigned int> m_threadId;
 };
 
 export [[nodiscard]] auto makeTaskManager(AsyncTaskScheduler& scheduler) -> std::unique_ptr<TaskManager> {
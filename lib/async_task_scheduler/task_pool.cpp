@@ -0,0 +1,181 @@
+module task_pool;
+
+namespace async_task_scheduler {
+
+namespace {
+
+constexpr std::size_t classCount { static_cast<std::size_t>(std::countr_zero(TaskPool::largestBlockSize / TaskPool::smallestBlockSize)) + 1 };
+// Blocks handed over to the depot, or taken from it, at once
+constexpr std::size_t batchSize { 32 };
+
+// Free blocks are linked through their first bytes, the first block of a batch in the depot links the next batch
+struct FreeBlock {
+    FreeBlock* m_next;
+    FreeBlock* m_nextBatch;
+};
+
+struct FreeList {
+    FreeBlock* m_head;
+    std::size_t m_count;
+};
+
+struct Depot {
+    std::mutex m_mutex;
+    FreeBlock* m_batches;
+};
+
+auto blockClass(const std::size_t size) -> std::size_t {
+    return static_cast<std::size_t>(std::bit_width((std::max(size, TaskPool::smallestBlockSize) - 1) / TaskPool::smallestBlockSize));
+}
+
+auto blockSize(const std::size_t blockClass) -> std::size_t {
+    return TaskPool::smallestBlockSize << blockClass;
+}
+
+auto depot(const std::size_t blockClass) -> Depot& {
+    static std::array<Depot, classCount> depots {};
+    return depots[blockClass];
+}
+
+// Takes a batch of blocks from the list, fewer when it holds fewer
+auto takeBatch(FreeList& list) -> FreeBlock* {
+    auto* batch { list.m_head };
+    auto* last { batch };
+
+    for (std::size_t i { 1 }; i < batchSize and last->m_next != nullptr; ++i) {
+        last = last->m_next;
+        --list.m_count;
+    }
+
+    --list.m_count;
+    list.m_head = last->m_next;
+    last->m_next = nullptr;
+
+    return batch;
+}
+
+auto pushBatch(const std::size_t blockClass, FreeBlock* batch) -> void {
+    auto& classDepot { depot(blockClass) };
+    std::lock_guard lock { classDepot.m_mutex };
+
+    batch->m_nextBatch = classDepot.m_batches;
+    classDepot.m_batches = batch;
+}
+
+auto popBatch(const std::size_t blockClass) -> FreeBlock* {
+    auto& classDepot { depot(blockClass) };
+    std::lock_guard lock { classDepot.m_mutex };
+
+    auto* batch { classDepot.m_batches };
+
+    if (batch != nullptr) {
+        classDepot.m_batches = batch->m_nextBatch;
+    }
+
+    return batch;
+}
+
+// Blocks freed on this thread, handed over to the depot when the thread ends
+class ThreadCache final {
+public:
+    ThreadCache() :  m_lists {} {}
+
+    ~ThreadCache() {
+        for (std::size_t i { 0 }; i < classCount; ++i) {
+            while (m_lists[i].m_head != nullptr) {
+                pushBatch(i, takeBatch(m_lists[i]));
+            }
+        }
+    }
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    [[nodiscard]] auto allocate(const std::size_t blockClass) -> void* {
+        auto& list { m_lists[blockClass] };
+
+        if (list.m_head == nullptr) {
+            list.m_head = popBatch(blockClass);
+
+            if (list.m_head == nullptr) {
+                return ::operator new(blockSize(blockClass));
+            }
+
+            for (auto* block { list.m_head }; block != nullptr; block = block->m_next) {
+                ++list.m_count;
+            }
+        }
+
+        auto* block { list.m_head };
+        list.m_head = block->m_next;
+        --list.m_count;
+
+        return block;
+    }
+
+    auto deallocate(void* block, const std::size_t blockClass) -> void {
+        auto& list { m_lists[blockClass] };
+
+        list.m_head = ::new (block) FreeBlock { list.m_head, nullptr };
+        ++list.m_count;
+
+        // Keeps the blocks freed last, the likeliest to still be cached, for the next tasks made on this thread
+        if (list.m_count >= 2 * batchSize) {
+            auto* last { list.m_head };
+
+            for (std::size_t i { 1 }; i < batchSize; ++i) {
+                last = last->m_next;
+            }
+
+            pushBatch(blockClass, std::exchange(last->m_next, nullptr));
+            list.m_count = batchSize;
+        }
+    }
+
+private:
+    std::array<FreeList, classCount> m_lists;
+};
+
+thread_local ThreadCache threadCache {};
+
+}
+
+auto TaskPool::allocate(const std::size_t size) -> void* {
+    if (size > largestBlockSize) {
+        return ::operator new(size);
+    }
+
+    return threadCache.allocate(blockClass(size));
+}
+
+auto TaskPool::allocate(const std::size_t size, const std::align_val_t alignment) -> void* {
+    if (static_cast<std::size_t>(alignment) > alignof(std::max_align_t)) {
+        return ::operator new(size, alignment);
+    }
+
+    return allocate(size);
+}
+
+auto TaskPool::deallocate(void* block, const std::size_t size) noexcept -> void {
+    if (block == nullptr) {
+        return;
+    }
+
+    if (size > largestBlockSize) {
+        ::operator delete(block, size);
+        return;
+    }
+
+    threadCache.deallocate(block, blockClass(size));
+}
+
+auto TaskPool::deallocate(void* block, const std::size_t size, const std::align_val_t alignment) noexcept -> void {
+    if (static_cast<std::size_t>(alignment) > alignof(std::max_align_t)) {
+        ::operator delete(block, size, alignment);
+        return;
+    }
+
+    deallocate(block, size);
+}
+
+}
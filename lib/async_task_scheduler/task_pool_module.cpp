@@ -0,0 +1,108 @@
+export module task_pool;
+
+import std;
+
+namespace async_task_scheduler {
+
+// Blocks for tasks, the states of their results and callables too large to be kept in place, in classes of sizes
+// doubling from 64 bytes. Tasks are usually made on one thread and destroyed on an executor: every thread keeps the
+// blocks it frees and hands them over to a shared depot in batches once it has enough, threads out of blocks take a batch
+// back from there. Blocks never go back to the heap, so once the pool has grown to fit the tasks alive at once, neither
+// making nor destroying a task allocates. Larger blocks come from the heap, as blocks aligned beyond std::max_align_t,
+// the alignment of every block of the pool
+export class TaskPool final {
+public:
+    static constexpr std::size_t smallestBlockSize { 64 };
+    static constexpr std::size_t largestBlockSize { 1024 };
+
+    [[nodiscard]] static auto allocate(std::size_t size) -> void*;
+    [[nodiscard]] static auto allocate(std::size_t size, std::align_val_t alignment) -> void*;
+    // With the size, and alignment, the block was allocated with
+    static auto deallocate(void* block, std::size_t size) noexcept -> void;
+    static auto deallocate(void* block, std::size_t size, std::align_val_t alignment) noexcept -> void;
+};
+
+// Move only callable kept in place when it fits, in a block of the pool otherwise, so that storing it never allocates
+export template <typename Signature>
+class TaskFunction;
+
+export template <typename Res, typename... Args>
+class TaskFunction<Res(Args...)> final {
+public:
+    // Most captures are a few pointers and values, or a string
+    static constexpr std::size_t inPlaceSize { 64 };
+
+    template <typename Callable> requires (not std::same_as<std::remove_cvref_t<Callable>, TaskFunction>)
+        and std::is_invocable_r_v<Res, std::decay_t<Callable>&, Args...>
+    explicit TaskFunction(Callable&& callable) :  m_storage {}, m_callable { nullptr }, m_operations { &operations<std::decay_t<Callable>> } {
+        using Stored = std::decay_t<Callable>;
+
+        if constexpr (fitsInPlace<Stored>) {
+            m_callable = ::new (static_cast<void*>(m_storage.data())) Stored(std::forward<Callable>(callable));
+        } else {
+            auto* block { TaskPool::allocate(sizeof(Stored), std::align_val_t { alignof(Stored) }) };
+
+            try {
+                m_callable = ::new (block) Stored(std::forward<Callable>(callable));
+            } catch (...) {
+                TaskPool::deallocate(block, sizeof(Stored), std::align_val_t { alignof(Stored) });
+                throw;
+            }
+        }
+    }
+
+    TaskFunction(TaskFunction&& other) noexcept
+     :  m_storage {},
+        m_callable { other.m_callable ? other.m_operations->m_move(std::exchange(other.m_callable, nullptr), m_storage.data()) : nullptr },
+        m_operations { other.m_operations } {}
+
+    ~TaskFunction() { if (m_callable) m_operations->m_destroy(m_callable); }
+
+    TaskFunction(const TaskFunction&) = delete;
+    TaskFunction& operator=(const TaskFunction&) = delete;
+    TaskFunction& operator=(TaskFunction&&) = delete;
+
+    auto operator()(Args... args) -> Res { return m_operations->m_invoke(m_callable, std::forward<Args>(args)...); }
+
+private:
+    struct Operations {
+        Res (*m_invoke)(void* callable, Args&&... args);
+        void (*m_destroy)(void* callable) noexcept;
+        // Into the storage of another function, returns where the callable is now
+        void* (*m_move)(void* callable, std::byte* storage) noexcept;
+    };
+
+    // Moved along with the task, so only when it can not throw
+    template <typename Stored>
+    static constexpr bool fitsInPlace { sizeof(Stored) <= inPlaceSize and alignof(Stored) <= alignof(std::max_align_t)
+        and std::is_nothrow_move_constructible_v<Stored> };
+
+    template <typename Stored>
+    static constexpr Operations operations {
+        [] (void* callable, Args&&... args) -> Res {
+            return std::invoke_r<Res>(*static_cast<Stored*>(callable), std::forward<Args>(args)...);
+        },
+        [] (void* callable) noexcept {
+            static_cast<Stored*>(callable)->~Stored();
+
+            if constexpr (not fitsInPlace<Stored>) {
+                TaskPool::deallocate(callable, sizeof(Stored), std::align_val_t { alignof(Stored) });
+            }
+        },
+        [] (void* callable, std::byte* storage) noexcept -> void* {
+            if constexpr (fitsInPlace<Stored>) {
+                auto* moved { ::new (static_cast<void*>(storage)) Stored(std::move(*static_cast<Stored*>(callable))) };
+                static_cast<Stored*>(callable)->~Stored();
+                return moved;
+            } else {
+                return callable;
+            }
+        }
+    };
+
+    alignas(std::max_align_t) std::array<std::byte, inPlaceSize> m_storage;
+    void* m_callable;
+    const Operations* m_operations;
+};
+
+}
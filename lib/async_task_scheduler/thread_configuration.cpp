@@ -0,0 +1,239 @@
+module;
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/resource.h>
+    #include <unistd.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+#elif defined(_WIN32)
+    // Keeps min and max from being macros
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#endif
+module thread_configuration;
+
+namespace async_task_scheduler {
+
+namespace {
+
+// Cores of the NUMA node among the ones given, all of the node when none is
+auto threadCores(const ThreadConfiguration& configuration) -> std::expected<std::vector<unsigned int>, std::string> {
+    if (not configuration.m_numaNode.has_value()) {
+        return configuration.m_cores;
+    }
+
+    auto nodeCores { numaNodeCores(*configuration.m_numaNode) };
+
+    // Nodes of memory only have no core
+    if (nodeCores.has_value() and nodeCores->empty()) {
+        return std::unexpected { std::format("No core on NUMA node {}", *configuration.m_numaNode) };
+    }
+
+    if (not nodeCores.has_value() or configuration.m_cores.empty()) {
+        return nodeCores;
+    }
+
+    std::erase_if(*nodeCores, [&configuration] (const unsigned int core) { return not std::ranges::contains(configuration.m_cores, core); });
+
+    if (nodeCores->empty()) {
+        return std::unexpected { std::format("No core given on NUMA node {}", *configuration.m_numaNode) };
+    }
+
+    return nodeCores;
+}
+
+}
+
+#if defined(__linux__)
+
+auto configureCurrentThread(const ThreadConfiguration& configuration) -> std::expected<void, std::string> {
+    if (not configuration.m_name.empty()) {
+        if (const auto name { configuration.m_name.substr(0, 15) }; pthread_setname_np(pthread_self(), name.c_str()) != 0) {
+            return std::unexpected { std::format("Could not name thread {}", name) };
+        }
+    }
+
+    const auto cores { threadCores(configuration) };
+
+    if (not cores.has_value()) {
+        return std::unexpected { cores.error() };
+    }
+
+    if (not cores->empty()) {
+        cpu_set_t coreSet {};
+        CPU_ZERO(&coreSet);
+
+        for (const auto core: *cores) {
+            if (core >= CPU_SETSIZE) {
+                return std::unexpected { std::format("Core {} out of range", core) };
+            }
+
+            CPU_SET(core, &coreSet);
+        }
+
+        if (pthread_setaffinity_np(pthread_self(), sizeof(coreSet), &coreSet) != 0) {
+            return std::unexpected { std::string { "Could not pin thread to its cores" } };
+        }
+    }
+
+    if (configuration.m_realtimePriority.has_value()) {
+        sched_param parameters {};
+        parameters.sched_priority = *configuration.m_realtimePriority;
+
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) != 0) {
+            return std::unexpected { std::string { "Could not set real time priority" } };
+        }
+    }
+
+    // Nice levels are per thread on Linux
+    if (configuration.m_niceLevel.has_value() and setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), *configuration.m_niceLevel) != 0) {
+        return std::unexpected { std::string { "Could not set nice level" } };
+    }
+
+    return {};
+}
+
+auto numaNodeCores(const unsigned int numaNode) -> std::expected<std::vector<unsigned int>, std::string> {
+    std::ifstream coreList { std::format("/sys/devices/system/node/node{}/cpulist", numaNode) };
+    std::string cores {};
+
+    if (not std::getline(coreList, cores)) {
+        return std::unexpected { std::format("Unknown NUMA node {}", numaNode) };
+    }
+
+    return parseCores(cores);
+}
+
+#elif defined(_WIN32)
+
+auto configureCurrentThread(const ThreadConfiguration& configuration) -> std::expected<void, std::string> {
+    if (not configuration.m_name.empty()) {
+        const std::wstring name { configuration.m_name.begin(), configuration.m_name.end() };
+
+        if (FAILED(SetThreadDescription(GetCurrentThread(), name.c_str()))) {
+            return std::unexpected { std::format("Could not name thread {}", configuration.m_name) };
+        }
+    }
+
+    const auto cores { threadCores(configuration) };
+
+    if (not cores.has_value()) {
+        return std::unexpected { cores.error() };
+    }
+
+    if (not cores->empty()) {
+        DWORD_PTR coreMask { 0 };
+
+        for (const auto core: *cores) {
+            if (core >= sizeof(DWORD_PTR) * 8) {
+                return std::unexpected { std::format("Core {} out of range", core) };
+            }
+
+            coreMask |= DWORD_PTR { 1 } << core;
+        }
+
+        if (SetThreadAffinityMask(GetCurrentThread(), coreMask) == 0) {
+            return std::unexpected { std::string { "Could not pin thread to its cores" } };
+        }
+    }
+
+    if (configuration.m_realtimePriority.has_value() and not SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+        return std::unexpected { std::string { "Could not set real time priority" } };
+    }
+
+    if (configuration.m_niceLevel.has_value()) {
+        return std::unexpected { std::string { "Nice levels are not supported on this platform" } };
+    }
+
+    return {};
+}
+
+auto numaNodeCores(const unsigned int numaNode) -> std::expected<std::vector<unsigned int>, std::string> {
+    ULONGLONG coreMask { 0 };
+
+    if (numaNode > std::numeric_limits<UCHAR>::max() or not GetNumaNodeProcessorMask(static_cast<UCHAR>(numaNode), &coreMask) or coreMask == 0) {
+        return std::unexpected { std::format("Unknown NUMA node {}", numaNode) };
+    }
+
+    std::vector<unsigned int> cores {};
+
+    for (unsigned int core { 0 }; core < sizeof(coreMask) * 8; ++core) {
+        if ((coreMask >> core) & 1) {
+            cores.push_back(core);
+        }
+    }
+
+    return cores;
+}
+
+#else
+
+auto configureCurrentThread(const ThreadConfiguration& configuration) -> std::expected<void, std::string> {
+#if defined(__APPLE__)
+    if (not configuration.m_name.empty() and pthread_setname_np(configuration.m_name.c_str()) != 0) {
+        return std::unexpected { std::format("Could not name thread {}", configuration.m_name) };
+    }
+
+    if (configuration.m_realtimePriority.has_value()) {
+        sched_param parameters {};
+        parameters.sched_priority = *configuration.m_realtimePriority;
+
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) != 0) {
+            return std::unexpected { std::string { "Could not set real time priority" } };
+        }
+    }
+#else
+    if (not configuration.m_name.empty() or configuration.m_realtimePriority.has_value()) {
+        return std::unexpected { std::string { "Thread names and priorities are not supported on this platform" } };
+    }
+#endif
+
+    if (not configuration.m_cores.empty() or configuration.m_numaNode.has_value() or configuration.m_niceLevel.has_value()) {
+        return std::unexpected { std::string { "Thread affinity and nice levels are not supported on this platform" } };
+    }
+
+    return {};
+}
+
+auto numaNodeCores(const unsigned int numaNode) -> std::expected<std::vector<unsigned int>, std::string> {
+    return std::unexpected { std::format("Unknown NUMA node {}", numaNode) };
+}
+
+#endif
+
+auto parseCores(const std::string_view cores) -> std::expected<std::vector<unsigned int>, std::string> {
+    const auto parseCore { [] (const std::string_view core) -> std::optional<unsigned int> {
+        unsigned int value { 0 };
+        const auto [end, error] { std::from_chars(core.data(), core.data() + core.size(), value) };
+
+        if (error != std::errc {} or end != core.data() + core.size()) {
+            return std::nullopt;
+        }
+
+        return value;
+    } };
+
+    std::vector<unsigned int> coreList {};
+
+    for (const auto range: cores | std::views::split(',')) {
+        const std::string_view bounds { range.begin(), range.end() };
+        const auto separator { bounds.find('-') };
+
+        const auto first { parseCore(bounds.substr(0, separator)) };
+        const auto last { separator == std::string_view::npos ? first : parseCore(bounds.substr(separator + 1)) };
+
+        if (not first.has_value() or not last.has_value() or *first > *last) {
+            return std::unexpected { std::format("Invalid core list {}", cores) };
+        }
+
+        for (auto core { *first }; core <= *last; ++core) {
+            coreList.push_back(core);
+        }
+    }
+
+    return coreList;
+}
+
+}
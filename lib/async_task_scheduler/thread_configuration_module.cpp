@@ -0,0 +1,36 @@
+export module thread_configuration;
+
+import std;
+
+namespace async_task_scheduler {
+
+// How an executor out of tasks waits for more. It first spins on the core, checking between pause instructions, then
+// yields the core to other threads, then sleeps until it is woken. Tasks coming in bursts are then picked up without the
+// latency of waking a sleeping thread, at the cost of the core kept busy meanwhile. Sleeps straight away by default
+export struct IdlePolicy final {
+    std::chrono::nanoseconds m_spinFor;
+    // Once done spinning
+    std::chrono::nanoseconds m_yieldFor;
+};
+
+// Settings of an executor thread, applied by the thread itself when it starts. Unset fields leave the platform defaults
+export struct ThreadConfiguration final {
+    // Shown by top and perf, cut to 15 characters on Linux
+    std::string m_name;
+    // Cores the thread may run on, any of them when empty
+    std::vector<unsigned int> m_cores;
+    // Keeps the thread on the cores of the node, among m_cores when given. Memory it touches first is then local to it
+    std::optional<unsigned int> m_numaNode;
+    // SCHED_FIFO priority, usually needs privileges
+    std::optional<int> m_realtimePriority;
+    std::optional<int> m_niceLevel;
+    IdlePolicy m_idlePolicy;
+};
+
+export [[nodiscard]] auto configureCurrentThread(const ThreadConfiguration& configuration) -> std::expected<void, std::string>;
+
+// Cores listed as taskset and /sys do, e.g. "0-3,8"
+export [[nodiscard]] auto parseCores(std::string_view cores) -> std::expected<std::vector<unsigned int>, std::string>;
+export [[nodiscard]] auto numaNodeCores(unsigned int numaNode) -> std::expected<std::vector<unsigned int>, std::string>;
+
+}
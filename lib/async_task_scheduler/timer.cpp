@@ -0,0 +1,282 @@
+module timer;
+
+namespace async_task_scheduler {
+
+Timer::Timer()
+ :  m_start { std::chrono::steady_clock::now() },
+    m_currentTick { 0 },
+    m_wheel {},
+    m_entries {},
+    m_freeEntries {},
+    m_nextTimerId { 1 },
+    m_timerAccess {},
+    m_timerChanged {},
+    m_timerThread { [this] (std::stop_token stopHandle) { runTimers(stopHandle); } } {}
+
+Timer::~Timer() {
+    stop();
+}
+
+auto Timer::schedule(const std::chrono::steady_clock::time_point deadline, const std::chrono::steady_clock::duration period,
+        std::move_only_function<void()> function) -> TimerId_t {
+    TimerId_t timerId { 0 };
+
+    {
+        std::lock_guard lock { m_timerAccess };
+
+        std::unique_ptr<Entry> entry {};
+
+        if (m_freeEntries.empty()) {
+            entry = std::make_unique<Entry>();
+        } else {
+            entry = std::move(m_freeEntries.back());
+            m_freeEntries.pop_back();
+        }
+
+        timerId = m_nextTimerId++;
+
+        entry->m_timerId = timerId;
+        entry->m_deadline = toTick(deadline);
+        entry->m_period = period <= std::chrono::steady_clock::duration::zero() ? 0 :
+            std::max<Tick_t>(1, static_cast<Tick_t>(std::chrono::ceil<std::chrono::milliseconds>(period) / tick));
+        entry->m_cancelled = false;
+        entry->m_function = std::move(function);
+
+        // Nothing to move down the wheel, it catches up with the time spent idle
+        if (m_entries.empty()) {
+            m_currentTick = std::max(m_currentTick, elapsedTicks());
+        }
+
+        // Due already, it runs on the next tick
+        entry->m_deadline = std::max(entry->m_deadline, m_currentTick + 1);
+
+        insert(entry.get());
+        m_entries.emplace(timerId, std::move(entry));
+    }
+
+    m_timerChanged.notify_one();
+    return timerId;
+}
+
+auto Timer::schedule(const std::chrono::steady_clock::time_point deadline, Continuation& continuation) -> TimerId_t {
+    return schedule(deadline, std::chrono::steady_clock::duration::zero(), [&continuation] () { continuation.run(); });
+}
+
+auto Timer::cancel(const TimerId_t timerId) -> bool {
+    std::lock_guard lock { m_timerAccess };
+
+    const auto entry { m_entries.find(timerId) };
+
+    if (entry == m_entries.end() or entry->second->m_cancelled) {
+        return false;
+    }
+
+    // Running, it is dropped once it returns. A timer running once is then running for the last time
+    if (entry->second->m_next == nullptr) {
+        if (entry->second->m_period == 0) {
+            return false;
+        }
+
+        entry->second->m_cancelled = true;
+        return true;
+    }
+
+    unlink(entry->second.get());
+    recycle(timerId);
+
+    return true;
+}
+
+auto Timer::pendingTimers() -> std::size_t {
+    std::lock_guard lock { m_timerAccess };
+
+    return static_cast<std::size_t>(std::ranges::count_if(m_entries, [] (const auto& entry) { return not entry.second->m_cancelled; }));
+}
+
+auto Timer::stop() -> void {
+    m_timerThread.request_stop();
+
+    if (m_timerThread.joinable()) {
+        m_timerThread.join();
+    }
+
+    // Destroyed outside the lock, a task dropped along with its timer releases whoever waits for it
+    std::unordered_map<TimerId_t, std::unique_ptr<Entry>> entries {};
+
+    {
+        std::lock_guard lock { m_timerAccess };
+        entries.swap(m_entries);
+
+        for (auto& level: m_wheel) {
+            for (auto& slot: level) {
+                slot.m_head.m_previous = slot.m_head.m_next = &slot.m_head;
+            }
+        }
+    }
+}
+
+auto Timer::runTimers(const std::stop_token& stopHandle) -> void {
+    std::vector<Entry*> dueEntries {};
+    std::unique_lock lock { m_timerAccess };
+
+    while (not stopHandle.stop_requested()) {
+        const auto now { elapsedTicks() };
+
+        // Ticks with nothing to move down or to run are skipped
+        for (auto nextTick { nextWakeUp() }; nextTick.has_value() and *nextTick <= now; nextTick = nextWakeUp()) {
+            m_currentTick = *nextTick - 1;
+            advance(dueEntries);
+        }
+
+        m_currentTick = std::max(m_currentTick, now);
+
+        if (dueEntries.empty()) {
+            // Woken up early when a timer is scheduled meanwhile
+            const auto nextTimerId { m_nextTimerId };
+            const auto timerScheduled { [this, nextTimerId] () { return m_nextTimerId != nextTimerId; } };
+
+            if (const auto nextTick { nextWakeUp() }; nextTick.has_value()) {
+                m_timerChanged.wait_until(lock, stopHandle, toTimePoint(*nextTick), timerScheduled);
+            } else {
+                m_timerChanged.wait(lock, stopHandle, timerScheduled);
+            }
+
+            continue;
+        }
+
+        lock.unlock();
+
+        for (auto* entry: dueEntries) {
+            entry->m_function();
+        }
+
+        lock.lock();
+
+        for (auto* entry: dueEntries) {
+            if (entry->m_period != 0 and not entry->m_cancelled) {
+                // Behind by more than a period, the runs missed are skipped
+                entry->m_deadline = std::max(entry->m_deadline + entry->m_period, m_currentTick + 1);
+                insert(entry);
+            } else {
+                recycle(entry->m_timerId);
+            }
+        }
+
+        dueEntries.clear();
+    }
+}
+
+auto Timer::toTick(const std::chrono::steady_clock::time_point timePoint) const -> Tick_t {
+    if (timePoint <= m_start) {
+        return 0;
+    }
+
+    // Rounded up, timers never run early
+    return static_cast<Tick_t>(std::chrono::ceil<std::chrono::milliseconds>(timePoint - m_start) / tick);
+}
+
+auto Timer::elapsedTicks() const -> Tick_t {
+    // Rounded down, a tick is over only once all of it has passed
+    return static_cast<Tick_t>(std::chrono::floor<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start) / tick);
+}
+
+auto Timer::toTimePoint(const Tick_t tickCount) const -> std::chrono::steady_clock::time_point {
+    return m_start + tickCount * tick;
+}
+
+auto Timer::insert(Entry* entry) -> void {
+    // Due on the current tick, e.g. moved down on a level boundary, it goes in the level 0 slot advance empties next
+    auto level { std::size_t { 0 } };
+
+    while (level + 1 < levels and (entry->m_deadline >> (level * levelBits)) - (m_currentTick >> (level * levelBits)) >= slotsPerLevel) {
+        ++level;
+    }
+
+    // Beyond the last level it waits in the farthest slot and is placed again from there
+    const auto shift { level * levelBits };
+    const auto position { std::min(entry->m_deadline >> shift, (m_currentTick >> shift) + slotsPerLevel - 1) };
+
+    auto& head { m_wheel[level][position & (slotsPerLevel - 1)].m_head };
+
+    entry->m_previous = head.m_previous;
+    entry->m_next = &head;
+    head.m_previous->m_next = entry;
+    head.m_previous = entry;
+}
+
+auto Timer::unlink(Entry* entry) -> void {
+    entry->m_previous->m_next = entry->m_next;
+    entry->m_next->m_previous = entry->m_previous;
+    entry->m_previous = nullptr;
+    entry->m_next = nullptr;
+}
+
+auto Timer::advance(std::vector<Entry*>& dueEntries) -> void {
+    ++m_currentTick;
+
+    // Higher levels first, so that their entries can go down more than one level on the same tick
+    for (auto level { levels - 1 }; level > 0; --level) {
+        if ((m_currentTick & ((Tick_t { 1 } << (level * levelBits)) - 1)) == 0) {
+            cascade(level);
+        }
+    }
+
+    auto& head { m_wheel[0][m_currentTick & (slotsPerLevel - 1)].m_head };
+
+    while (head.m_next != &head) {
+        auto* entry { head.m_next };
+        unlink(entry);
+        dueEntries.push_back(entry);
+    }
+}
+
+auto Timer::cascade(const std::size_t level) -> void {
+    auto& head { m_wheel[level][(m_currentTick >> (level * levelBits)) & (slotsPerLevel - 1)].m_head };
+
+    Entry entries { nullptr, nullptr, 0, 0, 0, false, {} };
+    entries.m_previous = entries.m_next = &entries;
+
+    // Taken out first, an entry may be placed back in the same slot
+    if (head.m_next != &head) {
+        entries.m_next = head.m_next;
+        entries.m_previous = head.m_previous;
+        entries.m_next->m_previous = &entries;
+        entries.m_previous->m_next = &entries;
+        head.m_next = head.m_previous = &head;
+    }
+
+    while (entries.m_next != &entries) {
+        auto* entry { entries.m_next };
+        unlink(entry);
+        insert(entry);
+    }
+}
+
+auto Timer::nextWakeUp() const -> std::optional<Tick_t> {
+    // First busy slot of each level, a slot of a higher level is reached when its entries have to be moved down
+    std::optional<Tick_t> nextTick {};
+
+    for (std::size_t level { 0 }; level < levels; ++level) {
+        const auto shift { level * levelBits };
+        const auto position { m_currentTick >> shift };
+
+        for (Tick_t distance { 1 }; distance < slotsPerLevel; ++distance) {
+            if (not m_wheel[level][(position + distance) & (slotsPerLevel - 1)].empty()) {
+                const auto slotTick { (position + distance) << shift };
+                nextTick = std::min(nextTick.value_or(slotTick), slotTick);
+                break;
+            }
+        }
+    }
+
+    return nextTick;
+}
+
+auto Timer::recycle(const TimerId_t timerId) -> void {
+    if (auto entry { m_entries.extract(timerId) }; not entry.empty()) {
+        entry.mapped()->m_function = nullptr;
+        m_freeEntries.push_back(std::move(entry.mapped()));
+    }
+}
+
+}
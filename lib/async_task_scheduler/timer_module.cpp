@@ -0,0 +1,100 @@
+export module timer;
+
+import std;
+
+import shared_state;
+
+namespace async_task_scheduler {
+
+export using TimerId_t = std::uint64_t;
+
+// Runs functions on its own thread once their deadline has passed, with a resolution of one tick. Timers are kept
+// in a hierarchical wheel: levels of slots holding intrusive lists, each level covering ticks the previous one can not.
+// A timer is moved down a level when the wheel reaches its slot, so inserting and cancelling never search
+export class Timer final {
+public:
+    static constexpr std::chrono::milliseconds tick { 1 };
+
+    Timer();
+    ~Timer();
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+    Timer(Timer&&) = delete;
+    Timer& operator=(Timer&&) = delete;
+
+    // Called again every period after the deadline when the period is not zero, until cancelled
+    auto schedule(std::chrono::steady_clock::time_point deadline, std::chrono::steady_clock::duration period,
+        std::move_only_function<void()> function) -> TimerId_t;
+
+    // The continuation has to outlive the timer or its deadline
+    auto schedule(std::chrono::steady_clock::time_point deadline, Continuation& continuation) -> TimerId_t;
+
+    // False when the timer already ran, or is running, for the last time. A running periodic timer finishes its current run
+    auto cancel(TimerId_t timerId) -> bool;
+
+    [[nodiscard]] auto pendingTimers() -> std::size_t;
+
+    // Timers still pending are dropped
+    auto stop() -> void;
+
+private:
+    static constexpr std::size_t levelBits { 6 };
+    static constexpr std::size_t slotsPerLevel { 1 << levelBits };
+    static constexpr std::size_t levels { 4 };
+
+    using Tick_t = std::uint64_t;
+
+    struct Entry {
+        Entry* m_previous;
+        Entry* m_next;
+        TimerId_t m_timerId;
+        Tick_t m_deadline;
+        Tick_t m_period;
+        bool m_cancelled;
+        std::move_only_function<void()> m_function;
+    };
+
+    // Circular list with a sentinel, so that an entry unlinks itself without knowing its slot
+    struct Slot {
+        Slot() :  m_head { nullptr, nullptr, 0, 0, 0, false, {} } { m_head.m_previous = m_head.m_next = &m_head; }
+
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+
+        [[nodiscard]] auto empty() const -> bool { return m_head.m_next == &m_head; }
+
+        Entry m_head;
+    };
+
+    auto runTimers(const std::stop_token& stopHandle) -> void;
+
+    [[nodiscard]] auto toTick(std::chrono::steady_clock::time_point timePoint) const -> Tick_t;
+    [[nodiscard]] auto elapsedTicks() const -> Tick_t;
+    [[nodiscard]] auto toTimePoint(Tick_t tick) const -> std::chrono::steady_clock::time_point;
+
+    auto insert(Entry* entry) -> void;
+    static auto unlink(Entry* entry) -> void;
+
+    // Moves the wheel one tick forward and unlinks the entries due on it
+    auto advance(std::vector<Entry*>& dueEntries) -> void;
+    auto cascade(std::size_t level) -> void;
+    [[nodiscard]] auto nextWakeUp() const -> std::optional<Tick_t>;
+
+    auto recycle(TimerId_t timerId) -> void;
+
+    std::chrono::steady_clock::time_point m_start;
+    Tick_t m_currentTick;
+
+    std::array<std::array<Slot, slotsPerLevel>, levels> m_wheel;
+    // Entries of live timers, running ones included, and entries kept for reuse
+    std::unordered_map<TimerId_t, std::unique_ptr<Entry>> m_entries;
+    std::vector<std::unique_ptr<Entry>> m_freeEntries;
+    TimerId_t m_nextTimerId;
+
+    std::mutex m_timerAccess;
+    std::condition_variable_any m_timerChanged;
+    std::jthread m_timerThread;
+};
+
+}
@@ -0,0 +1,142 @@
+export module work_stealing_deque;
+
+import std;
+
+namespace async_task_scheduler {
+
+// Keeps the indices the owner and the thieves write on different cache lines
+constexpr std::size_t cacheLineSize { 64 };
+
+// Chase-Lev deque: the owner thread pushes and pops at the bottom, any other thread steals from the top.
+// Only the owner may call push and pop. Buffers replaced when growing are kept until destruction,
+// since a thief may still be reading them
+export template <typename T> requires std::is_pointer_v<T>
+class WorkStealingDeque final {
+public:
+    WorkStealingDeque() :  WorkStealingDeque { 64 } {}
+
+    explicit WorkStealingDeque(const std::int64_t capacity)
+     :  m_top { 0 },
+        m_bottom { 0 },
+        m_buffer { nullptr },
+        m_buffers {} {
+        if (capacity <= 0 or (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument { "Capacity must be a power of 2" };
+        }
+
+        m_buffers.push_back(std::make_unique<Buffer>(capacity));
+        m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+    auto push(const T item) -> void {
+        const auto bottom { m_bottom.load(std::memory_order_relaxed) };
+        const auto top { m_top.load(std::memory_order_acquire) };
+        auto* buffer { m_buffer.load(std::memory_order_relaxed) };
+
+        if (bottom - top > buffer->capacity() - 1) {
+            buffer = grow(buffer, top, bottom);
+        }
+
+        buffer->put(bottom, item);
+        m_bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Newest item, nullptr when empty
+    [[nodiscard]] auto pop() -> T {
+        const auto bottom { m_bottom.load(std::memory_order_relaxed) - 1 };
+        auto* buffer { m_buffer.load(std::memory_order_relaxed) };
+
+        // Sequentially consistent rather than fenced, which thread sanitizer does not support
+        m_bottom.store(bottom, std::memory_order_seq_cst);
+        auto top { m_top.load(std::memory_order_seq_cst) };
+
+        if (top > bottom) {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto item { buffer->get(bottom) };
+
+        // Last item, a thief may be taking it too
+        if (top == bottom) {
+            if (not m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return item;
+    }
+
+    // Oldest item, nullptr when empty or when another thread took it first
+    [[nodiscard]] auto steal() -> T {
+        auto top { m_top.load(std::memory_order_seq_cst) };
+        const auto bottom { m_bottom.load(std::memory_order_seq_cst) };
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        const auto item { m_buffer.load(std::memory_order_acquire)->get(top) };
+
+        if (not m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        return item;
+    }
+
+    // Only a hint when other threads are stealing
+    [[nodiscard]] auto size() const -> std::size_t {
+        const auto bottom { m_bottom.load(std::memory_order_relaxed) };
+        const auto top { m_top.load(std::memory_order_relaxed) };
+
+        return bottom > top ? static_cast<std::size_t>(bottom - top) : 0;
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+private:
+    class Buffer final {
+    public:
+        explicit Buffer(const std::int64_t capacity)
+         :  m_capacity { capacity },
+            m_items { std::make_unique<std::atomic<T>[]>(static_cast<std::size_t>(capacity)) } {}
+
+        [[nodiscard]] auto capacity() const -> std::int64_t { return m_capacity; }
+
+        [[nodiscard]] auto get(const std::int64_t index) const -> T { return m_items[slot(index)].load(std::memory_order_relaxed); }
+        auto put(const std::int64_t index, const T item) -> void { m_items[slot(index)].store(item, std::memory_order_relaxed); }
+
+    private:
+        [[nodiscard]] auto slot(const std::int64_t index) const -> std::size_t { return static_cast<std::size_t>(index & (m_capacity - 1)); }
+
+        std::int64_t m_capacity;
+        std::unique_ptr<std::atomic<T>[]> m_items;
+    };
+
+    auto grow(const Buffer* buffer, const std::int64_t top, const std::int64_t bottom) -> Buffer* {
+        m_buffers.push_back(std::make_unique<Buffer>(buffer->capacity() * 2));
+        auto* grown { m_buffers.back().get() };
+
+        for (auto index { top }; index < bottom; ++index) {
+            grown->put(index, buffer->get(index));
+        }
+
+        m_buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    alignas(cacheLineSize) std::atomic<std::int64_t> m_top;
+    alignas(cacheLineSize) std::atomic<std::int64_t> m_bottom;
+    std::atomic<Buffer*> m_buffer;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+};
+
+}
@@ -20,6 +20,14 @@ struct AudioBufferView {
       : m_leftMono { other.m_leftMono },
         m_right { other.m_right } {}
 
+    // Frames [offset, offset + count) of both channels, an empty channel stays empty
+    [[nodiscard]] auto subview(const std::size_t offset, const std::size_t count) const -> AudioBufferView {
+        return AudioBufferView {
+            m_leftMono.empty() ? m_leftMono : m_leftMono.subspan(offset, count),
+            m_right.empty() ? m_right : m_right.subspan(offset, count)
+        };
+    }
+
     AudioChannel<T> m_leftMono;
     AudioChannel<T> m_right;
 };
@@ -1,3 +1,5 @@
+module;
+#include "trace_macros.h"
 export module audio_engine;
 
 export import audio_device;
@@ -15,8 +17,22 @@ export import audio_format;
 
 import std;
 
+import tracing;
+
 namespace audio_engine {
 
+// Recorders to open for each side of the stream, a side without recording has no settings
+export struct RecordingSettings final {
+    std::optional<audio_recorder::RecorderSettings> m_input;
+    std::optional<audio_recorder::RecorderSettings> m_output;
+};
+
+// Audio taken from the ring buffers to be written, a side without recording has no buffer
+export struct RecordingBlock final {
+    std::unique_ptr<audio_buffer::AudioBuffer<float>> m_input;
+    std::unique_ptr<audio_buffer::AudioBuffer<float>> m_output;
+};
+
 export template<class T> requires std::derived_from<T, audio_library_wrapper::AudioLibraryWrapper>
 class AudioEngine {
 public:
@@ -28,6 +44,8 @@ public:
         m_inputRingAudioBuffer { nullptr },
         m_outputRingAudioBuffer { nullptr },
         m_isRecording { false },
+        m_preRollFrames { 0 },
+        m_overruns { 0 },
         m_inputRecorder { nullptr },
         m_outputRecorder { nullptr },
         m_inputAudioStats { std::vector<std::unique_ptr<audio_buffer::AudioStats<float>>> {} },
@@ -130,8 +148,8 @@ public:
         std::unique_ptr<ring_audio_buffer::RingAudioBuffer<float>> inputRingAudioBuffer { nullptr };
 
         if (inputChannelCount.has_value()) {
-            // 10 seconds of audio in ring buffer
-            if (auto inputRingAudioBufferResult = ring_audio_buffer::makeRingAudioBuffer<float>(inputChannelCount.value(), streamParamsResult.value()->m_sampleRate * 10); not inputRingAudioBufferResult.has_value()) {
+            // 10 seconds of audio in ring buffer on top of the pre-roll
+            if (auto inputRingAudioBufferResult = ring_audio_buffer::makeRingAudioBuffer<float>(inputChannelCount.value(), ringBufferLength(streamParamsResult.value()->m_sampleRate)); not inputRingAudioBufferResult.has_value()) {
                 return std::unexpected { std::format("Error creating input ring audio buffer: {}", inputRingAudioBufferResult.error()) };
             } else {
                 inputRingAudioBuffer.swap(inputRingAudioBufferResult.value());
@@ -141,8 +159,8 @@ public:
         std::unique_ptr<ring_audio_buffer::RingAudioBuffer<float>> outputRingAudioBuffer { nullptr };
 
         if (outputChannelCount.has_value()) {
-            // 10 seconds of audio in ring buffer
-            if (auto outputRingAudioBufferResult = ring_audio_buffer::makeRingAudioBuffer<float>(outputChannelCount.value(), streamParamsResult.value()->m_sampleRate * 10); not outputRingAudioBufferResult.has_value()) {
+            // 10 seconds of audio in ring buffer on top of the pre-roll
+            if (auto outputRingAudioBufferResult = ring_audio_buffer::makeRingAudioBuffer<float>(outputChannelCount.value(), ringBufferLength(streamParamsResult.value()->m_sampleRate)); not outputRingAudioBufferResult.has_value()) {
                 return std::unexpected { std::format("Error creating output ring audio buffer: {}", outputRingAudioBufferResult.error()) };
             } else {
                outputRingAudioBuffer.swap(outputRingAudioBufferResult.value());
@@ -186,7 +204,48 @@ public:
         return m_audioMixer;
     }
 
-    [[nodiscard]] auto startRecording(const audio_format::AudioFormat format) -> std::expected<void, std::string> {
+    // Keeps the last length of audio in the ring buffers while not recording, so that a recording can start up to that far in the past.
+    // Zero disables it. A running stream only fits the pre-roll it was started with, a longer one needs a stream restart
+    [[nodiscard]] auto preRoll(const std::chrono::milliseconds length) -> std::expected<void, std::string> {
+        if (length.count() < 0) {
+            return std::unexpected { std::string { "Pre-roll can not be negative" } };
+        }
+
+        const auto frames { toFrames(length) };
+
+        for (const auto ringAudioBuffer: { m_inputRingAudioBuffer.get(), m_outputRingAudioBuffer.get() }) {
+            if (ringAudioBuffer and ringAudioBuffer->capacity() < frames + m_sampleRate * 10) {
+                return std::unexpected { std::string { "Pre-roll does not fit in the ring buffers, the stream needs to be restarted" } };
+            }
+        }
+
+        m_preRollFrames.store(frames, std::memory_order_release);
+        return {};
+    }
+
+    [[nodiscard]] auto preRoll() const -> std::chrono::milliseconds {
+        return std::chrono::milliseconds { static_cast<std::chrono::milliseconds::rep>(std::uint64_t { m_preRollFrames.load(std::memory_order_acquire) } * 1000 / m_sampleRate) };
+    }
+
+    // Drops the audio older than the pre-roll, the ring buffers only belong to the write task while recording.
+    // Returns false when pre-roll is disabled
+    [[nodiscard]] auto trimPreRoll() const -> bool {
+        const auto preRollFrames { m_preRollFrames.load(std::memory_order_acquire) };
+
+        if (preRollFrames == 0) {
+            return false;
+        }
+
+        if (not m_isRecording.load(std::memory_order_acquire)) {
+            discardOlderThan(preRollFrames);
+        }
+
+        return true;
+    }
+
+    // The files start preRoll before now, taken from what the ring buffers kept
+    [[nodiscard]] auto startRecording(const audio_format::AudioFormat format, const audio_format::EncodingFormat encoding = audio_format::EncodingFormat::Wav,
+        const audio_recorder::EncodeDispatcher_t& dispatcher = {}, const std::chrono::milliseconds preRoll = std::chrono::milliseconds { 0 }) -> std::expected<void, std::string> {
         if (not m_audioLibraryWrapper->isStreamRunning()) {
             return std::unexpected { std::string { "Audio stream is not running" } };
         }
@@ -195,6 +254,10 @@ public:
             return std::unexpected { std::string { "Recording already started" } };
         }
 
+        if (preRoll.count() < 0 or toFrames(preRoll) > m_preRollFrames.load(std::memory_order_acquire)) {
+            return std::unexpected { std::string { "Requested pre-roll is longer than the captured one" } };
+        }
+
         try {
             const auto& inputParams { dynamic_cast<const audio_stream_params::InputAudioStreamParams&>(*m_audioStreamParams) };
 
@@ -210,7 +273,7 @@ public:
                 return std::unexpected { "Input ring audio buffer is null" };
             }
 
-            if (auto inputAudioRecorder { audio_recorder::makeAudioRecorder(m_audioStreamParams->m_sampleRate, format, fileNames, routingList) }; not inputAudioRecorder.has_value()) {
+            if (auto inputAudioRecorder { audio_recorder::makeAudioRecorder(m_audioStreamParams->m_sampleRate, format, fileNames, routingList, encoding, dispatcher) }; not inputAudioRecorder.has_value()) {
                 return std::unexpected { std::format("Could not create input audio recorder: {}", inputAudioRecorder.error()) };
             } else {
                 m_inputRecorder.swap(inputAudioRecorder.value());
@@ -232,59 +295,184 @@ public:
                 return std::unexpected { "Output ring audio buffer is null" };
             }
 
-            if (auto outputAudioRecorder { audio_recorder::makeAudioRecorder(m_audioStreamParams->m_sampleRate, format, fileNames, routingList) }; not outputAudioRecorder.has_value()) {
+            if (auto outputAudioRecorder { audio_recorder::makeAudioRecorder(m_audioStreamParams->m_sampleRate, format, fileNames, routingList, encoding, dispatcher) }; not outputAudioRecorder.has_value()) {
                 return std::unexpected { std::format("Could not create output audio recorder: {}", outputAudioRecorder.error()) };
             } else {
                 m_outputRecorder.swap(outputAudioRecorder.value());
             }
         } catch ([[maybe_unused]] const std::bad_cast&) {}
 
+        // Also drops what a previous recording left behind
+        discardOlderThan(toFrames(preRoll));
+
         m_isRecording.store(true, std::memory_order_release);
         return {};
     }
 
+    // Settings of the files that continue the current recording: same format and routing, named after the mixer channels followed by suffix.
+    // Opening them does not need the engine, so it can happen while the recording goes on
+    [[nodiscard]] auto nextRecordingSettings(const std::string_view suffix) const -> std::expected<RecordingSettings, std::string> {
+        if (not m_isRecording.load(std::memory_order_acquire)) {
+            return std::unexpected { std::string { "Recording not started" } };
+        }
+
+        if (suffix.empty()) {
+            return std::unexpected { std::string { "File name suffix can not be empty" } };
+        }
+
+        RecordingSettings settings {};
+
+        if (m_inputRecorder) {
+            settings.m_input = m_inputRecorder->settings();
+
+            for (audio_device::ChannelCount_t channel { 0 }; channel < settings.m_input->m_fileNames.size(); ++channel) {
+                settings.m_input->m_fileNames[channel] = std::format("{}{}", m_audioMixer->inputName(channel), suffix);
+            }
+
+            if (settings.m_input->m_fileNames == m_inputRecorder->settings().m_fileNames) {
+                return std::unexpected { std::string { "Rotation file names must differ from the current ones" } };
+            }
+        }
+
+        if (m_outputRecorder) {
+            settings.m_output = m_outputRecorder->settings();
+
+            for (audio_device::ChannelCount_t channel { 0 }; channel < settings.m_output->m_fileNames.size(); ++channel) {
+                settings.m_output->m_fileNames[channel] = std::format("{}{}", m_audioMixer->outputName(channel), suffix);
+            }
+
+            if (settings.m_output->m_fileNames == m_outputRecorder->settings().m_fileNames) {
+                return std::unexpected { std::string { "Rotation file names must differ from the current ones" } };
+            }
+        }
+
+        return settings;
+    }
+
+    // Recording switches to the given recorders at atFrame, counted from the start of the recording, or at the next write without it.
+    // It hands them to the recorders being written, so it must not run along with write: the manager holds its recording mutex for both
+    [[nodiscard]] auto rotateRecording(std::unique_ptr<audio_recorder::AudioRecorder> inputRecorder, std::unique_ptr<audio_recorder::AudioRecorder> outputRecorder,
+        const std::optional<std::uint64_t> atFrame = std::nullopt) -> std::expected<void, std::string> {
+        if (not m_isRecording.load(std::memory_order_acquire)) {
+            return std::unexpected { std::string { "Recording not started" } };
+        }
+
+        if (static_cast<bool>(inputRecorder) != static_cast<bool>(m_inputRecorder) or static_cast<bool>(outputRecorder) != static_cast<bool>(m_outputRecorder)) {
+            return std::unexpected { std::string { "Recorders do not match the current recording" } };
+        }
+
+        // Both sides switch or none does
+        if ((m_inputRecorder and m_inputRecorder->isRotating()) or (m_outputRecorder and m_outputRecorder->isRotating())) {
+            return std::unexpected { std::string { "Rotation already pending" } };
+        }
+
+        if (m_inputRecorder) {
+            if (auto result { m_inputRecorder->rotate(std::move(inputRecorder), atFrame.value_or(m_inputRecorder->framesWritten())) }; not result.has_value()) {
+                return result;
+            }
+        }
+
+        if (m_outputRecorder) {
+            if (auto result { m_outputRecorder->rotate(std::move(outputRecorder), atFrame.value_or(m_outputRecorder->framesWritten())) }; not result.has_value()) {
+                return result;
+            }
+        }
+
+        return {};
+    }
+
     auto stopRecording() -> void {
         m_isRecording.store(false, std::memory_order_release);
     }
 
-    auto finalizeRecording() -> void {
+    // Closes the files, false when completing any of them failed
+    [[nodiscard]] auto finalizeRecording() -> bool {
+        auto closeResult { true };
+
+        if (m_inputRecorder) {
+            closeResult &= m_inputRecorder->close();
+        }
+
+        if (m_outputRecorder) {
+            closeResult &= m_outputRecorder->close();
+        }
+
         m_inputRecorder.reset();
         m_outputRecorder.reset();
+
+        return closeResult;
     }
 
-    [[nodiscard]] auto write() const -> bool {
+    // Dequeues at most a write worth of audio for each side being recorded, empty once not recording
+    [[nodiscard]] auto capture() const -> std::optional<RecordingBlock> {
         if (not m_isRecording.load(std::memory_order_acquire)) {
-            return false;
+            return std::nullopt;
         }
 
-        if (m_inputRecorder) {
-            const auto audioBuffer { audio_buffer::makeAudioBuffer<float>(0, 0) };
+        RecordingBlock block { nullptr, nullptr };
 
-            if (not m_inputRingAudioBuffer->dequeue(*audioBuffer)) {
-                return false;
-            }
+        if (m_inputRecorder) {
+            block.m_input = audio_buffer::makeAudioBuffer<float>(0, 0);
 
-            if (not m_inputRecorder->write(*audioBuffer)) {
-                return false;
+            if (not m_inputRingAudioBuffer->dequeue(*block.m_input, m_maxFramesPerWrite)) {
+                return std::nullopt;
             }
         }
 
         if (m_outputRecorder) {
-             const auto audioBuffer { audio_buffer::makeAudioBuffer<float>(0, 0) };
+            block.m_output = audio_buffer::makeAudioBuffer<float>(0, 0);
 
-            if (not m_outputRingAudioBuffer->dequeue(*audioBuffer)) {
-                return false;
+            if (not m_outputRingAudioBuffer->dequeue(*block.m_output, m_maxFramesPerWrite)) {
+                return std::nullopt;
             }
+        }
 
-            if (not m_outputRecorder->write(*audioBuffer)) {
-                return false;
-            }
+        return block;
+    }
+
+    // Also once recording stopped, until the recording is finalized, so that audio captured before is not lost
+    [[nodiscard]] auto write(const RecordingBlock& block) const -> bool {
+        if (block.m_input and m_inputRecorder and not m_inputRecorder->write(*block.m_input)) {
+            return false;
+        }
+
+        if (block.m_output and m_outputRecorder and not m_outputRecorder->write(*block.m_output)) {
+            return false;
         }
 
         return true;
     }
 
+    // Audio callbacks that could not queue every frame of a side, as its ring buffer was full: the recording has a gap
+    [[nodiscard]] auto overruns() const -> std::uint64_t { return m_overruns.load(std::memory_order_relaxed); }
+
+    // More than a write worth of audio is waiting, e.g. after starting with a pre-roll, and should be written without waiting
+    [[nodiscard]] auto hasRecordingBacklog() const -> bool {
+        return (m_inputRecorder and m_inputRingAudioBuffer->availableFrames() >= m_maxFramesPerWrite) or
+            (m_outputRecorder and m_outputRingAudioBuffer->availableFrames() >= m_maxFramesPerWrite);
+    }
+
 protected:
+    [[nodiscard]] static constexpr auto toFrames(const std::chrono::milliseconds length) -> audio_stream_params::BufferLength_t {
+        return static_cast<audio_stream_params::BufferLength_t>(length.count() * std::int64_t { m_sampleRate } / 1000);
+    }
+
+    [[nodiscard]] auto ringBufferLength(const audio_device::SampleRate_t sampleRate) const -> audio_stream_params::BufferLength_t {
+        return sampleRate * 10 + m_preRollFrames.load(std::memory_order_acquire);
+    }
+
+    auto discardOlderThan(const audio_stream_params::BufferLength_t frames) const -> void {
+        for (const auto ringAudioBuffer: { m_inputRingAudioBuffer.get(), m_outputRingAudioBuffer.get() }) {
+            if (not ringAudioBuffer) {
+                continue;
+            }
+
+            if (const auto availableFrames { ringAudioBuffer->availableFrames() }; availableFrames > frames) {
+                std::ignore = ringAudioBuffer->discard(availableFrames - frames);
+            }
+        }
+    }
+
     [[nodiscard]] auto getAudioDevice(const std::string& deviceName, audio_device::AudioDeviceType deviceType) const
                     -> std::expected<std::ranges::borrowed_iterator_t<const std::vector<std::unique_ptr<const audio_device::AudioDevice>> &>, std::string> {
         auto deviceItr { std::ranges::find_if(m_audioDevices, [&deviceName, &deviceType] (const auto& currentDevice) { return currentDevice->m_deviceName == deviceName and currentDevice->m_type == deviceType; } ) };
@@ -375,13 +563,16 @@ protected:
     }
 
     auto process(const audio_buffer::AudioBuffer<float>& inputBuffer, const audio_buffer::AudioBuffer<float>& outputBuffer) const -> void {
+        TRACE_SPAN("audio", "AudioEngine::process");
+
         if (m_processedInputBuffer)
             m_processedInputBuffer->clear();
 
-        const auto isRecording { m_isRecording.load(std::memory_order_acquire) };
+        // Pre-roll keeps the rings filled while not recording, the oldest audio is trimmed by the consumer
+        const auto isCapturing { m_isRecording.load(std::memory_order_acquire) or m_preRollFrames.load(std::memory_order_relaxed) != 0 };
 
-        if (m_inputRingAudioBuffer && isRecording) {
-            std::ignore = m_inputRingAudioBuffer->enqueue(inputBuffer);
+        if (m_inputRingAudioBuffer && isCapturing and not m_inputRingAudioBuffer->enqueue(inputBuffer)) {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
         }
 
         for (auto channel { audio_device::ChannelCount_t { 0 } }; channel < inputBuffer.numberOfChannels(); ++channel) {
@@ -396,8 +587,8 @@ protected:
 
         processInput(inputBuffer, outputBuffer);
 
-        if (m_outputRingAudioBuffer && isRecording) {
-            std::ignore = m_outputRingAudioBuffer->enqueue(outputBuffer);
+        if (m_outputRingAudioBuffer && isCapturing and not m_outputRingAudioBuffer->enqueue(outputBuffer)) {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
         }
 
         for (auto channel { audio_device::ChannelCount_t { 0 } }; channel < outputBuffer.numberOfChannels(); ++channel) {
@@ -417,6 +608,8 @@ protected:
     static constexpr audio_format::AudioFormat m_format { audio_format::AudioFormat::Float32 };
     static constexpr audio_stream_params::PeriodSize_t m_periodSize { 3 };
     static constexpr std::array<const audio_stream_params::BufferLength_t, 5> m_allowedBufferLengths { 1024, 2048, 4096, 8192, 16384 };
+    // One second, a larger backlog is written over several calls
+    static constexpr audio_stream_params::BufferLength_t m_maxFramesPerWrite { m_sampleRate };
 
     std::unique_ptr<audio_mixer::AudioMixer<float>> m_audioMixer;
     std::vector<std::unique_ptr<const audio_device::AudioDevice>> m_audioDevices;
@@ -425,6 +618,8 @@ protected:
     std::unique_ptr<ring_audio_buffer::RingAudioBuffer<float>> m_inputRingAudioBuffer;
     std::unique_ptr<ring_audio_buffer::RingAudioBuffer<float>> m_outputRingAudioBuffer;
     std::atomic_bool m_isRecording;
+    std::atomic<audio_stream_params::BufferLength_t> m_preRollFrames;
+    std::atomic<std::uint64_t> m_overruns;
     std::unique_ptr<audio_recorder::AudioRecorder> m_inputRecorder;
     std::unique_ptr<audio_recorder::AudioRecorder> m_outputRecorder;
     std::vector<std::unique_ptr<audio_buffer::AudioStats<float>>> m_inputAudioStats;
@@ -28,6 +28,21 @@ export [[nodiscard]] auto constexpr toString(const AudioFormat format) -> std::e
     return std::unexpected { std::string { "Audio format unknown" } };
 }
 
+// Container and codec of recorded files
+export enum class EncodingFormat {
+    Wav,
+    Flac
+};
+
+export [[nodiscard]] auto constexpr toString(const EncodingFormat encoding) -> std::expected<std::string, std::string> {
+    switch (encoding) {
+        case EncodingFormat::Wav:   return "Wav";
+        case EncodingFormat::Flac:  return "Flac";
+    };
+
+    return std::unexpected { std::string { "Encoding format unknown" } };
+}
+
 export [[nodiscard]] auto constexpr toAudioFormat(const ma_format format) -> std::expected<AudioFormat, std::string> {
     switch (format) {
         case ma_format_unknown: return AudioFormat::Unknown;
@@ -1,11 +1,52 @@
+module;
+#include "trace_macros.h"
 module audio_recorder;
 
+import peak_file;
+import tracing;
+
 namespace audio_engine::audio_recorder {
 
+namespace {
+
+// Keeps the peak file of a recording file up to date from the same samples
+class PeakAudioWriter final: public AudioWriter {
+public:
+    PeakAudioWriter(std::unique_ptr<AudioWriter> writer, std::unique_ptr<peak_file::PeakWriter> peakWriter)
+      : m_writer { std::move(writer) },
+        m_peakWriter { std::move(peakWriter) } {}
+
+    [[nodiscard]] auto write(const audio_buffer::ReadOnlyAudioBufferView<float>& buffer) -> bool override {
+        const auto writeResult { m_writer->write(buffer) };
+
+        return m_peakWriter->write(buffer) and writeResult;
+    }
+
+    auto reserve(const std::size_t framesPerWrite) -> void override {
+        m_writer->reserve(framesPerWrite);
+    }
+
+    [[nodiscard]] auto close() -> bool override {
+        return m_writer->close();
+    }
+
+private:
+    std::unique_ptr<AudioWriter> m_writer;
+    std::unique_ptr<peak_file::PeakWriter> m_peakWriter;
+};
+
+}
+
 AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sampleRate,[[maybe_unused]] const audio_format::AudioFormat format,
-            [[maybe_unused]]const std::vector<std::string>& fileNames, [[maybe_unused]]const std::vector<audio_mixer::ChannelRouting>& routingList)
-  : m_writers {},
-    m_routing {} {
+            [[maybe_unused]]const std::vector<std::string>& fileNames, [[maybe_unused]]const std::vector<audio_mixer::ChannelRouting>& routingList,
+            const audio_format::EncodingFormat encoding, const EncodeDispatcher_t& dispatcher)
+  : m_settings { sampleRate, format, fileNames, routingList, encoding, dispatcher },
+    m_writers {},
+    m_routing {},
+    m_framesWritten { 0 },
+    m_next { nullptr },
+    m_rotationFrame { 0 },
+    m_closeFailed { std::make_shared<std::atomic_bool>(false) } {
 
     if (fileNames.size() == 0) {
         throw std::invalid_argument( "No files provided");
@@ -30,6 +71,10 @@ AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sa
         throw std::invalid_argument("Unsupported audio format");
     }
 
+    if (encoding == audio_format::EncodingFormat::Flac and format == audio_format::AudioFormat::Float32) {
+        throw std::invalid_argument("FLAC does not support floating point samples");
+    }
+
     for (const auto [name, routing]: std::ranges::views::zip(fileNames, routingList)) {
         const auto isMono { routing.isMono() };
         const auto isStereo { routing.isStereo() };
@@ -45,7 +90,7 @@ AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sa
         switch (format) {
             case audio_format::AudioFormat::SignedInt16:
                 if (auto result { audio_recorder::makeAudioWriter<audio_format::AudioFormat::SignedInt16>(
-                    name, sampleRate, channelCount) }; not result.has_value()) {
+                    name, sampleRate, channelCount, encoding, dispatcher) }; not result.has_value()) {
                     throw std::runtime_error { std::move(result).error() };
                 } else {
                     audioWriter = std::move(result).value();
@@ -55,7 +100,7 @@ AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sa
 
             case audio_format::AudioFormat::SignedInt24:
                 if (auto result { audio_recorder::makeAudioWriter<audio_format::AudioFormat::SignedInt24>(
-                    name, sampleRate, channelCount) }; not result.has_value()) {
+                    name, sampleRate, channelCount, encoding, dispatcher) }; not result.has_value()) {
                     throw std::runtime_error { std::move(result).error() };
                 } else {
                     audioWriter = std::move(result).value();
@@ -64,7 +109,7 @@ AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sa
                 break;
             case audio_format::AudioFormat::Float32:
                 if (auto result { audio_recorder::makeAudioWriter<audio_format::AudioFormat::Float32>(
-                    name, sampleRate, channelCount) }; not result.has_value()) {
+                    name, sampleRate, channelCount, encoding, dispatcher) }; not result.has_value()) {
                     throw std::runtime_error { std::move(result).error() };
                 } else {
                     audioWriter = std::move(result).value();
@@ -75,7 +120,12 @@ AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sa
                 std::unreachable();
         }
 
-        m_writers.emplace_back(std::move(audioWriter));
+        // Overviews of long recordings are drawn from the peak file instead of the whole recording
+        if (auto peakWriter { peak_file::makePeakWriter(name, sampleRate, channelCount) }; not peakWriter.has_value()) {
+            throw std::runtime_error { std::move(peakWriter).error() };
+        } else {
+            m_writers.emplace_back(std::make_unique<PeakAudioWriter>(std::move(audioWriter), std::move(peakWriter).value()));
+        }
         m_routing.push_back(routing);
     }
 
@@ -89,13 +139,99 @@ AudioRecorder::AudioRecorder([[maybe_unused]]const audio_device::SampleRate_t sa
     }
 }
 
-auto AudioRecorder::write(const audio_buffer::AudioBuffer<float> &audioBuffer) const -> bool {
+auto AudioRecorder::write(const audio_buffer::AudioBuffer<float> &audioBuffer) -> bool {
+    TRACE_SPAN("writer", "AudioRecorder::write");
+
+    const auto frames { std::size_t { audioBuffer.bufferLength() } };
+    auto offset { std::size_t { 0 } };
+    auto writeResult { true };
+
+    if (m_next and m_rotationFrame < m_framesWritten + frames) {
+        // Frames before the rotation point complete the current files
+        offset = static_cast<std::size_t>(std::max(m_rotationFrame, m_framesWritten) - m_framesWritten);
+        writeResult &= write(audioBuffer, 0, offset);
+
+        switchToNext();
+    }
+
+    writeResult &= write(audioBuffer, offset, frames - offset);
+    m_framesWritten += frames;
+
+    return writeResult and not m_closeFailed->load(std::memory_order_relaxed);
+}
+
+auto AudioRecorder::reserve(const std::size_t framesPerWrite) const -> void {
+    for (const auto& writer: m_writers) {
+        writer->reserve(framesPerWrite);
+    }
+}
+
+auto AudioRecorder::close() -> bool {
+    auto closeResult { true };
+
+    for (const auto& writer: m_writers) {
+        closeResult &= writer->close();
+    }
+
+    // Files of a rotation not reached yet are left empty
+    if (m_next) {
+        closeResult &= m_next->close();
+    }
+
+    return closeResult and not m_closeFailed->load(std::memory_order_relaxed);
+}
+
+auto AudioRecorder::rotate(std::unique_ptr<AudioRecorder> next, const std::uint64_t atFrame) -> std::expected<void, std::string> {
+    if (not next) {
+        return std::unexpected { "No audio recorder to rotate to" };
+    }
+
+    if (m_next) {
+        return std::unexpected { "Rotation already pending" };
+    }
+
+    m_next = std::move(next);
+    m_rotationFrame = atFrame;
+
+    return {};
+}
+
+auto AudioRecorder::write(const audio_buffer::AudioBuffer<float> &audioBuffer, const std::size_t offset, const std::size_t count) const -> bool {
+    if (count == 0) {
+        return true;
+    }
+
     auto writeResult { true };
     for (const auto [writer, routing]: std::ranges::views::zip(m_writers, m_routing)) {
-        writeResult &= writer->write(audioBuffer.view(routing.m_leftMono.value(), routing.m_right));
+        writeResult &= writer->write(audio_buffer::ReadOnlyAudioBufferView<float> { audioBuffer.view(routing.m_leftMono.value(), routing.m_right) }.subview(offset, count));
     }
 
     return writeResult;
 }
 
+auto AudioRecorder::switchToNext() -> void {
+    auto previousWriters { std::make_shared<std::vector<std::unique_ptr<AudioWriter>>>(std::exchange(m_writers, std::move(m_next->m_writers))) };
+
+    m_routing = std::move(m_next->m_routing);
+    m_settings = std::move(m_next->m_settings);
+    m_next.reset();
+
+    auto closeWriters { [previousWriters, closeFailed = m_closeFailed] {
+        for (const auto& writer: *previousWriters) {
+            if (not writer->close()) {
+                closeFailed->store(true, std::memory_order_relaxed);
+            }
+        }
+
+        previousWriters->clear();
+    } };
+
+    // Closing files can take a while, e.g. waiting for FLAC frames, so it is kept off the writing path when possible
+    if (m_settings.m_dispatcher) {
+        m_settings.m_dispatcher(std::move(closeWriters));
+    } else {
+        closeWriters();
+    }
+}
+
 }
@@ -2,7 +2,7 @@ export module audio_recorder;
 
 import std;
 
-import audio_writer;
+export import audio_writer;
 import audio_device;
 import channel_routing;
 import audio_format;
@@ -10,27 +10,70 @@ import audio_buffer;
 
 namespace audio_engine::audio_recorder {
 
+// Everything a recorder is made of, kept so that a recording can go on in new files
+export struct RecorderSettings final {
+    audio_device::SampleRate_t m_sampleRate;
+    audio_format::AudioFormat m_format;
+    std::vector<std::string> m_fileNames;
+    std::vector<audio_mixer::ChannelRouting> m_routingList;
+    audio_format::EncodingFormat m_encoding;
+    EncodeDispatcher_t m_dispatcher;
+};
+
 export class AudioRecorder {
 public:
     AudioRecorder(audio_device::SampleRate_t sampleRate, audio_format::AudioFormat format,
-        const std::vector<std::string>& fileNames, const std::vector<audio_mixer::ChannelRouting>& routingList);
+        const std::vector<std::string>& fileNames, const std::vector<audio_mixer::ChannelRouting>& routingList,
+        audio_format::EncodingFormat encoding = audio_format::EncodingFormat::Wav, const EncodeDispatcher_t& dispatcher = {});
 
     virtual ~AudioRecorder() = default;
 
-    [[nodiscard]] auto write(const audio_buffer::AudioBuffer<float>& audioBuffer) const -> bool;
+    [[nodiscard]] auto write(const audio_buffer::AudioBuffer<float>& audioBuffer) -> bool;
+
+    auto reserve(std::size_t framesPerWrite) const -> void;
+
+    // Completes the files, nothing is written after. Files closed through the dispatcher by a rotation that failed are
+    // reported here or by the writes that follow it
+    [[nodiscard]] auto close() -> bool;
+
+    // Frame atFrame, counted from the first write, and every following one go to the files of next. Files are switched
+    // inside a write so no frame is lost, and the previous files are finalized through the dispatcher.
+    // If atFrame was already written, files are switched at the start of the next write.
+    // Not synchronized: rotate, isRotating and framesWritten must not run along with write, callers serialize them
+    [[nodiscard]] auto rotate(std::unique_ptr<AudioRecorder> next, std::uint64_t atFrame) -> std::expected<void, std::string>;
+
+    [[nodiscard]] auto isRotating() const noexcept -> bool { return m_next != nullptr; }
+    [[nodiscard]] auto framesWritten() const noexcept -> std::uint64_t { return m_framesWritten; }
+    [[nodiscard]] auto settings() const noexcept -> const RecorderSettings& { return m_settings; }
+
 private:
+    [[nodiscard]] auto write(const audio_buffer::AudioBuffer<float>& audioBuffer, std::size_t offset, std::size_t count) const -> bool;
+    auto switchToNext() -> void;
+
+    RecorderSettings m_settings;
     std::vector<std::unique_ptr<AudioWriter>> m_writers;
     std::vector<audio_mixer::ChannelRouting> m_routing;
+    std::uint64_t m_framesWritten;
+    std::unique_ptr<AudioRecorder> m_next;
+    std::uint64_t m_rotationFrame;
+    // Shared with the closing of the previous files, which may outlive the recorder
+    std::shared_ptr<std::atomic_bool> m_closeFailed;
 };
 
+// FLAC frames are encoded through the dispatcher when one is given, otherwise on the writing thread
 export [[nodiscard]] auto makeAudioRecorder(audio_device::SampleRate_t sampleRate, audio_format::AudioFormat format,
-    const std::vector<std::string>& fileNames, const std::vector<audio_mixer::ChannelRouting>& routingList) -> std::expected<std::unique_ptr<AudioRecorder>, std::string> {
+    const std::vector<std::string>& fileNames, const std::vector<audio_mixer::ChannelRouting>& routingList,
+    const audio_format::EncodingFormat encoding = audio_format::EncodingFormat::Wav, const EncodeDispatcher_t& dispatcher = {}) -> std::expected<std::unique_ptr<AudioRecorder>, std::string> {
 
     try {
-        return std::make_unique<AudioRecorder>(sampleRate, format, fileNames, routingList);
+        return std::make_unique<AudioRecorder>(sampleRate, format, fileNames, routingList, encoding, dispatcher);
     } catch (const std::exception& e) {
         return std::unexpected { std::string { e.what()} };
     }
 }
 
-}
\ No newline at end of file
+export [[nodiscard]] auto makeAudioRecorder(const RecorderSettings& settings) -> std::expected<std::unique_ptr<AudioRecorder>, std::string> {
+    return makeAudioRecorder(settings.m_sampleRate, settings.m_format, settings.m_fileNames, settings.m_routingList, settings.m_encoding, settings.m_dispatcher);
+}
+
+}
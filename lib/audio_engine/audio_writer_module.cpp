@@ -7,33 +7,22 @@ import std;
 import audio_device;
 import audio_format;
 import audio_buffer;
+import pcm_converter;
+import flac_encoder;
 
 namespace audio_engine::audio_recorder {
 
-template <audio_format::AudioFormat format> requires (format == audio_format::AudioFormat::SignedInt16) or
-    (format == audio_format::AudioFormat::SignedInt24) or (format == audio_format::AudioFormat::Float32)
-struct SelectMaFormat;
-
-template <>
-struct SelectMaFormat<audio_format::AudioFormat::SignedInt16> {
-    using type = ma_int16;
-};
-
-template <>
-struct SelectMaFormat<audio_format::AudioFormat::SignedInt24> {
-    using type = ma_uint8;
-};
-
-template <>
-struct SelectMaFormat<audio_format::AudioFormat::Float32> {
-    using type = ma_float;
-};
-
 export class AudioWriter {
 public:
     virtual ~AudioWriter() = default;
 
     [[nodiscard]] virtual auto write(const audio_buffer::ReadOnlyAudioBufferView<float>& buffer) -> bool = 0;
+
+    // Allocates ahead what writes of up to framesPerWrite frames need
+    virtual auto reserve([[maybe_unused]] const std::size_t framesPerWrite) -> void {}
+
+    // Completes the file, nothing is written after. Destroying the writer does it as well, without telling whether it failed
+    [[nodiscard]] virtual auto close() -> bool { return true; }
 };
 
 template <audio_format::AudioFormat format>
@@ -42,7 +31,7 @@ public:
     AudioWriterWithFormat(std::string_view fileName, const audio_device::SampleRate_t sampleRate, const audio_device::ChannelCount_t channelCount)
       : m_encoderConfig {},
         m_encoder {},
-        m_interleavedSamples {},
+        m_dither {},
         m_convertedSamples {}
     {
         static_assert(format == audio_format::AudioFormat::SignedInt16 or format == audio_format::AudioFormat::SignedInt24 or format == audio_format::AudioFormat::Float32,
@@ -73,63 +62,273 @@ public:
             return false;
         }
 
+        const auto samplesPerChannel { buffer.m_leftMono.size() };
+
+        // Every sample is overwritten by the conversion, so the buffer only grows and is never cleared
+        if (const auto convertedSize { pcm_converter::outputSize<format>(samplesPerChannel, m_encoderConfig.channels) }; m_convertedSamples.size() < convertedSize) {
+            m_convertedSamples.resize(convertedSize);
+        }
+
+        if (not pcm_converter::convert<format>(buffer, m_convertedSamples, m_dither)) {
+            return false;
+        }
+
+        ma_uint64 framesWritten { 0 };
+
+        return ma_encoder_write_pcm_frames(&m_encoder, m_convertedSamples.data(), samplesPerChannel, &framesWritten) == MA_SUCCESS and framesWritten == samplesPerChannel;
+    }
+
+    auto reserve(const std::size_t framesPerWrite) -> void override {
+        if (const auto convertedSize { pcm_converter::outputSize<format>(framesPerWrite, m_encoderConfig.channels) }; m_convertedSamples.size() < convertedSize) {
+            m_convertedSamples.resize(convertedSize);
+        }
+    }
+
+private:
+    ma_encoder_config m_encoderConfig;
+    ma_encoder m_encoder;
+
+    pcm_converter::TpdfDither m_dither;
+    std::vector<pcm_converter::PcmSample_t<format>> m_convertedSamples;
+};
+
+// Runs a unit of encoding work, e.g. on the async task scheduler. Work must not be dropped but may run on any thread
+export using EncodeDispatcher_t = std::function<void(std::function<void()>)>;
+
+// One block of planar samples, encoded by whichever thread claims it first
+class FlacFrame final {
+public:
+    FlacFrame(const flac_encoder::StreamParameters& parameters, std::vector<std::int32_t> samples, const std::uint32_t blockSize, const std::uint64_t frameNumber)
+     :  m_parameters { parameters },
+        m_samples { std::move(samples) },
+        m_blockSize { blockSize },
+        m_frameNumber { frameNumber },
+        m_encoded {},
+        m_state { State::Pending } {}
+
+    // Does nothing when another thread already claimed the frame
+    auto encode() -> void {
+        if (auto expected { State::Pending }; not m_state.compare_exchange_strong(expected, State::Encoding, std::memory_order_acq_rel)) {
+            return;
+        }
+
+        try {
+            m_encoded = flac_encoder::encodeFrame(m_parameters, m_frameNumber, m_samples, m_blockSize);
+        } catch (...) {
+            // An empty frame is reported as a write failure
+            m_encoded.clear();
+        }
+
+        m_samples = {};
+        m_state.store(State::Encoded, std::memory_order_release);
+        m_state.notify_all();
+    }
+
+    // Encodes on the calling thread if no one started yet, so that waiting never depends on a busy executor
+    [[nodiscard]] auto wait() -> const std::vector<std::uint8_t>& {
+        encode();
+
+        for (auto state { m_state.load(std::memory_order_acquire) }; state != State::Encoded; state = m_state.load(std::memory_order_acquire)) {
+            m_state.wait(state, std::memory_order_acquire);
+        }
+
+        return m_encoded;
+    }
+
+    [[nodiscard]] auto isEncoded() const -> bool {
+        return m_state.load(std::memory_order_acquire) == State::Encoded;
+    }
+
+    [[nodiscard]] auto blockSize() const -> std::uint32_t { return m_blockSize; }
+
+private:
+    enum class State { Pending, Encoding, Encoded };
+
+    flac_encoder::StreamParameters m_parameters;
+    std::vector<std::int32_t> m_samples;
+    std::uint32_t m_blockSize;
+    std::uint64_t m_frameNumber;
+    std::vector<std::uint8_t> m_encoded;
+    std::atomic<State> m_state;
+};
+
+// Lossless writer: samples are cut in fixed size blocks, each block is encoded as an independent frame through the dispatcher
+// and frames are written in order as soon as the oldest one is done. STREAMINFO is completed when the writer is closed
+template <audio_format::AudioFormat format>
+class FlacAudioWriter: public AudioWriter {
+public:
+    FlacAudioWriter(std::string_view fileName, const audio_device::SampleRate_t sampleRate, const audio_device::ChannelCount_t channelCount, EncodeDispatcher_t dispatcher)
+      : m_parameters { sampleRate, channelCount, format == audio_format::AudioFormat::SignedInt16 ? 16u : 24u, flac_encoder::defaultBlockSize },
+        m_dispatcher { std::move(dispatcher) },
+        m_file {},
+        m_dither {},
+        m_block(std::size_t { channelCount } * flac_encoder::defaultBlockSize),
+        m_blockFrames { 0 },
+        m_frameNumber { 0 },
+        m_totalSamples { 0 },
+        m_minFrameSize { std::numeric_limits<std::uint32_t>::max() },
+        m_maxFrameSize { 0 },
+        m_framesInFlight {},
+        m_failed { false },
+        m_closed { false }
+    {
+        static_assert(format == audio_format::AudioFormat::SignedInt16 or format == audio_format::AudioFormat::SignedInt24, "Unsupported FLAC sample format");
+
+        if (auto supported { flac_encoder::isStreamSupported(m_parameters) }; not supported.has_value()) {
+            throw std::invalid_argument { std::move(supported).error() };
+        }
+
+        m_file.open(std::string { fileName }.append(".flac"), std::ios::binary | std::ios::trunc);
+
+        if (not m_file.is_open()) {
+            throw std::runtime_error("Failed to initialize output file");
+        }
+
+        writeBytes(flac_encoder::encodeStreamHeader(m_parameters, {}));
+    }
+
+    ~FlacAudioWriter() override {
+        if (not m_closed) {
+            std::ignore = close();
+        }
+    }
+
+    [[nodiscard]] auto write(const audio_buffer::ReadOnlyAudioBufferView<float>& buffer) -> bool override {
+        const auto isMono { not buffer.m_leftMono.empty() and buffer.m_right.empty() };
+        const auto isStereo { not buffer.m_leftMono.empty() and not buffer.m_right.empty() };
+
+        if (not isMono and not isStereo) {
+            return false;
+        }
+
+        if ((isMono and m_parameters.m_channelCount != 1) or (isStereo and m_parameters.m_channelCount != 2)) {
+            return false;
+        }
+
         if (isStereo and buffer.m_leftMono.size() != buffer.m_right.size()) {
             return false;
         }
 
-        const auto samplesPerChannel { buffer.m_leftMono.size() };
-        const auto bufferLength { isStereo ? samplesPerChannel * 2 : samplesPerChannel };
+        const auto blockSize { std::size_t { m_parameters.m_blockSize } };
+
+        for (std::size_t offset { 0 }; offset < buffer.m_leftMono.size();) {
+            const auto count { std::min(blockSize - m_blockFrames, buffer.m_leftMono.size() - offset) };
 
-        m_interleavedSamples.resize(bufferLength);
-        std::ranges::fill(m_interleavedSamples, 0.0f);
+            const std::array channels { buffer.m_leftMono, buffer.m_right };
 
-        if (isMono) {
-            std::ranges::copy(std::ranges::begin(buffer.m_leftMono), std::ranges::end(buffer.m_leftMono), std::ranges::begin(m_interleavedSamples));
-        } else {
-            for (unsigned int i { 0 }; i < samplesPerChannel; ++i) {
-                m_interleavedSamples[i * 2] = buffer.m_leftMono[i];
-                m_interleavedSamples[i * 2 + 1] = buffer.m_right[i];
+            for (std::size_t channel { 0 }; channel < m_parameters.m_channelCount; ++channel) {
+                const auto destination { std::span { m_block }.subspan(channel * blockSize + m_blockFrames, count) };
+
+                if (not pcm_converter::convertPlanar<format>(channels[channel].subspan(offset, count), destination, m_dither)) {
+                    return false;
+                }
             }
-        }
 
-        if constexpr (format == audio_format::AudioFormat::SignedInt16) {
-            static_assert(std::same_as<typename decltype(m_convertedSamples)::value_type, ma_int16>, "Format is 16-bit signed int but buffer type is not");
+            m_blockFrames += count;
+            offset += count;
 
-            resizeAndClearConvertedSamples(bufferLength);
-        } else if constexpr (format == audio_format::AudioFormat::SignedInt24) {
-            static_assert(std::same_as<typename decltype(m_convertedSamples)::value_type, ma_uint8>, "Format is 24-bit signed int but buffer is not");
+            if (m_blockFrames == blockSize) {
+                submitBlock();
+            }
+        }
 
-            resizeAndClearConvertedSamples(bufferLength * 3);
-        } else if constexpr (format == audio_format::AudioFormat::Float32) {
-            static_assert(std::same_as<typename decltype(m_convertedSamples)::value_type, ma_float>, "Format is 32-bit float but buffer is not");
+        // Without a dispatcher every frame is encoded right away on this thread
+        writeFrames(m_dispatcher ? maxFramesInFlight : 0);
 
-            resizeAndClearConvertedSamples(bufferLength);
+        return not m_failed and m_file.good();
+    }
+
+    [[nodiscard]] auto close() -> bool override {
+        if (m_blockFrames != 0) {
+            submitBlock();
         }
 
-        ma_convert_pcm_frames_format(m_convertedSamples.data(), audio_format::toMaFormat(format).value(),
-            m_interleavedSamples.data(), ma_format_f32,
-            samplesPerChannel, m_encoderConfig.channels, ma_dither_mode_triangle);
+        writeFrames(0);
 
-        ma_uint64 framesWritten { 0 };
+        const auto minFrameSize { m_minFrameSize <= m_maxFrameSize ? m_minFrameSize : 0 };
 
-        return ma_encoder_write_pcm_frames(&m_encoder, m_convertedSamples.data(), samplesPerChannel, &framesWritten) == MA_SUCCESS and framesWritten == samplesPerChannel;
+        m_file.seekp(0);
+        writeBytes(flac_encoder::encodeStreamHeader(m_parameters, { m_totalSamples, minFrameSize, m_maxFrameSize }));
+        m_file.close();
+        m_closed = true;
+
+        return not m_failed and not m_file.fail();
     }
 
 private:
-    auto resizeAndClearConvertedSamples(const auto size) -> void {
-        m_convertedSamples.resize(size);
-        std::ranges::fill(m_convertedSamples, static_cast<decltype(m_convertedSamples)::value_type>(0));
+    // Bounds memory and latency when encoding falls behind, the writing thread then encodes the oldest frames itself
+    static constexpr std::size_t maxFramesInFlight { 32 };
+
+    auto submitBlock() -> void {
+        const auto blockSize { std::size_t { m_parameters.m_blockSize } };
+
+        // A short last block is compacted, channels are expected back to back
+        if (m_blockFrames != blockSize) {
+            for (std::size_t channel { 1 }; channel < m_parameters.m_channelCount; ++channel) {
+                std::copy_n(m_block.begin() + static_cast<std::ptrdiff_t>(channel * blockSize), m_blockFrames, m_block.begin() + static_cast<std::ptrdiff_t>(channel * m_blockFrames));
+            }
+
+            m_block.resize(m_blockFrames * m_parameters.m_channelCount);
+        }
+
+        auto frame { std::make_shared<FlacFrame>(m_parameters, std::exchange(m_block, std::vector<std::int32_t>(blockSize * m_parameters.m_channelCount)),
+            static_cast<std::uint32_t>(m_blockFrames), m_frameNumber++) };
+
+        m_blockFrames = 0;
+
+        if (m_dispatcher) {
+            m_dispatcher([frame] { frame->encode(); });
+        }
+
+        m_framesInFlight.push_back(std::move(frame));
     }
 
-    ma_encoder_config m_encoderConfig;
-    ma_encoder m_encoder;
+    // Writes every frame that is ready in order, then waits until at most maxFrames are left. A frame that could not be
+    // encoded is left out of the file and of the total in STREAMINFO
+    auto writeFrames(const std::size_t maxFrames) -> void {
+        while (not m_framesInFlight.empty() and (m_framesInFlight.front()->isEncoded() or m_framesInFlight.size() > maxFrames)) {
+            const auto& encoded { m_framesInFlight.front()->wait() };
+
+            if (encoded.empty()) {
+                m_failed = true;
+            } else {
+                const auto size { static_cast<std::uint32_t>(encoded.size()) };
+                m_minFrameSize = std::min(m_minFrameSize, size);
+                m_maxFrameSize = std::max(m_maxFrameSize, size);
+                m_totalSamples += m_framesInFlight.front()->blockSize();
+
+                writeBytes(encoded);
+            }
+
+            m_framesInFlight.pop_front();
+        }
+    }
+
+    auto writeBytes(const std::span<const std::uint8_t> bytes) -> void {
+        m_file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    flac_encoder::StreamParameters m_parameters;
+    EncodeDispatcher_t m_dispatcher;
+    std::ofstream m_file;
 
-    std::vector<float> m_interleavedSamples;
-    std::vector<typename SelectMaFormat<format>::type> m_convertedSamples;
+    pcm_converter::TpdfDither m_dither;
+    std::vector<std::int32_t> m_block;
+    std::size_t m_blockFrames;
+
+    std::uint64_t m_frameNumber;
+    std::uint64_t m_totalSamples;
+    std::uint32_t m_minFrameSize;
+    std::uint32_t m_maxFrameSize;
+
+    std::deque<std::shared_ptr<FlacFrame>> m_framesInFlight;
+    bool m_failed;
+    bool m_closed;
 };
 
 export template <audio_format::AudioFormat format>
-[[nodiscard]] auto makeAudioWriter(std::string_view fileName, const audio_device::SampleRate_t sampleRate, const audio_device::ChannelCount_t channelCount) -> std::expected<std::unique_ptr<AudioWriter>, std::string> {
+[[nodiscard]] auto makeAudioWriter(std::string_view fileName, const audio_device::SampleRate_t sampleRate, const audio_device::ChannelCount_t channelCount,
+    const audio_format::EncodingFormat encoding = audio_format::EncodingFormat::Wav, EncodeDispatcher_t dispatcher = {}) -> std::expected<std::unique_ptr<AudioWriter>, std::string> {
     if (fileName.empty()) {
         return std::unexpected { "File name can not be empty" };
     }
@@ -142,7 +341,17 @@ export template <audio_format::AudioFormat format>
         return std::unexpected {"Invalid channel count" };
     }
 
+    if (encoding == audio_format::EncodingFormat::Flac and format == audio_format::AudioFormat::Float32) {
+        return std::unexpected { "FLAC does not support floating point samples" };
+    }
+
     try {
+        if constexpr (format != audio_format::AudioFormat::Float32) {
+            if (encoding == audio_format::EncodingFormat::Flac) {
+                return std::make_unique<FlacAudioWriter<format>>(fileName, sampleRate, channelCount, std::move(dispatcher));
+            }
+        }
+
         return std::make_unique<AudioWriterWithFormat<format>>(fileName, sampleRate, channelCount);
     } catch (const std::exception& ex) {
         return std::unexpected { ex.what() };
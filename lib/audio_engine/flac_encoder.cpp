@@ -0,0 +1,558 @@
+module flac_encoder;
+
+namespace audio_engine::flac_encoder {
+
+namespace {
+
+constexpr unsigned int maxFixedOrder { 4 };
+constexpr unsigned int maxPartitionOrder { 8 };
+constexpr unsigned int maxRiceParameter { 30 };
+// Above this parameter the 5-bit RICE2 coding method has to be used
+constexpr unsigned int maxRice1Parameter { 14 };
+
+enum class ChannelAssignment : std::uint32_t {
+    LeftSide = 0b1000,
+    RightSide = 0b1001,
+    MidSide = 0b1010
+};
+
+[[nodiscard]] consteval auto makeCrc8Table() -> std::array<std::uint8_t, 256> {
+    std::array<std::uint8_t, 256> table {};
+
+    for (std::uint32_t i { 0 }; i < table.size(); ++i) {
+        auto crc { i };
+
+        for (auto bit { 0 }; bit < 8; ++bit) {
+            crc = (crc & 0x80u) != 0 ? (crc << 1) ^ 0x07u : crc << 1;
+        }
+
+        table[i] = static_cast<std::uint8_t>(crc & 0xFFu);
+    }
+
+    return table;
+}
+
+[[nodiscard]] consteval auto makeCrc16Table() -> std::array<std::uint16_t, 256> {
+    std::array<std::uint16_t, 256> table {};
+
+    for (std::uint32_t i { 0 }; i < table.size(); ++i) {
+        auto crc { i << 8 };
+
+        for (auto bit { 0 }; bit < 8; ++bit) {
+            crc = (crc & 0x8000u) != 0 ? (crc << 1) ^ 0x8005u : crc << 1;
+        }
+
+        table[i] = static_cast<std::uint16_t>(crc & 0xFFFFu);
+    }
+
+    return table;
+}
+
+constexpr auto crc8Table { makeCrc8Table() };
+constexpr auto crc16Table { makeCrc16Table() };
+
+[[nodiscard]] auto crc8(const std::span<const std::uint8_t> bytes) -> std::uint8_t {
+    std::uint8_t crc { 0 };
+
+    for (const auto byte: bytes) {
+        crc = crc8Table[crc ^ byte];
+    }
+
+    return crc;
+}
+
+[[nodiscard]] auto crc16(const std::span<const std::uint8_t> bytes) -> std::uint16_t {
+    std::uint16_t crc { 0 };
+
+    for (const auto byte: bytes) {
+        crc = static_cast<std::uint16_t>((crc << 8) ^ crc16Table[(crc >> 8) ^ byte]);
+    }
+
+    return crc;
+}
+
+// MSB first bit packing, as required by the FLAC bitstream
+class BitWriter final {
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& output)
+     :  m_output { output },
+        m_accumulator { 0 },
+        m_bitCount { 0 } {}
+
+    // At most 32 bits at a time
+    auto write(const std::uint64_t value, const unsigned int bits) -> void {
+        if (bits == 0) {
+            return;
+        }
+
+        m_accumulator = (m_accumulator << bits) | (value & ((std::uint64_t { 1 } << bits) - 1));
+        m_bitCount += bits;
+
+        while (m_bitCount >= 8) {
+            m_bitCount -= 8;
+            m_output.push_back(static_cast<std::uint8_t>((m_accumulator >> m_bitCount) & 0xFFu));
+        }
+    }
+
+    auto writeSigned(const std::int32_t value, const unsigned int bits) -> void {
+        write(static_cast<std::uint32_t>(value), bits);
+    }
+
+    // Value zeros followed by a one
+    auto writeUnary(std::uint32_t value) -> void {
+        while (value >= 32) {
+            write(0, 32);
+            value -= 32;
+        }
+
+        write(1, value + 1);
+    }
+
+    auto alignToByte() -> void {
+        if (m_bitCount != 0) {
+            write(0, 8 - m_bitCount);
+        }
+    }
+
+private:
+    std::vector<std::uint8_t>& m_output;
+    std::uint64_t m_accumulator;
+    unsigned int m_bitCount;
+};
+
+[[nodiscard]] constexpr auto zigzag(const std::int32_t value) -> std::uint32_t {
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+[[nodiscard]] constexpr auto blockSizeCode(const std::uint32_t blockSize) -> std::uint32_t {
+    switch (blockSize) {
+        case 192:   return 0b0001;
+        case 576:   return 0b0010;
+        case 1152:  return 0b0011;
+        case 2304:  return 0b0100;
+        case 4608:  return 0b0101;
+        case 256:   return 0b1000;
+        case 512:   return 0b1001;
+        case 1024:  return 0b1010;
+        case 2048:  return 0b1011;
+        case 4096:  return 0b1100;
+        case 8192:  return 0b1101;
+        case 16384: return 0b1110;
+        case 32768: return 0b1111;
+        default: break;
+    }
+
+    // Block size - 1 is stored after the frame number, on 8 or 16 bits
+    return blockSize <= 256 ? 0b0110 : 0b0111;
+}
+
+[[nodiscard]] constexpr auto sampleRateCode(const audio_device::SampleRate_t sampleRate) -> std::uint32_t {
+    switch (sampleRate) {
+        case 88200:  return 0b0001;
+        case 176400: return 0b0010;
+        case 192000: return 0b0011;
+        case 8000:   return 0b0100;
+        case 16000:  return 0b0101;
+        case 22050:  return 0b0110;
+        case 24000:  return 0b0111;
+        case 32000:  return 0b1000;
+        case 44100:  return 0b1001;
+        case 48000:  return 0b1010;
+        case 96000:  return 0b1011;
+        default: break;
+    }
+
+    // Taken from STREAMINFO
+    return 0b0000;
+}
+
+[[nodiscard]] constexpr auto sampleSizeCode(const unsigned int bitsPerSample) -> std::uint32_t {
+    return bitsPerSample == 16 ? 0b100 : 0b110;
+}
+
+// Frame number, UTF-8 style variable length coding
+auto writeFrameNumber(BitWriter& writer, const std::uint64_t frameNumber) -> void {
+    if (frameNumber < 0x80) {
+        writer.write(frameNumber, 8);
+        return;
+    }
+
+    // The first byte holds 6 - n value bits after n + 1 ones and a zero, each continuation byte holds 6
+    auto continuationBytes { 1u };
+
+    while (continuationBytes < 6 and frameNumber >= (std::uint64_t { 1 } << (6 + 5 * continuationBytes))) {
+        ++continuationBytes;
+    }
+
+    writer.write(((1u << (continuationBytes + 1)) - 1) << 1, continuationBytes + 2);
+    writer.write(frameNumber >> (6 * continuationBytes), 6 - continuationBytes);
+
+    for (auto byte { continuationBytes }; byte > 0; --byte) {
+        writer.write(0x80u | ((frameNumber >> (6 * (byte - 1))) & 0x3Fu), 8);
+    }
+}
+
+auto computeResiduals(const std::span<const std::int32_t> samples, const unsigned int order, std::vector<std::int32_t>& residuals) -> void {
+    const auto size { samples.size() };
+    residuals.resize(size - order);
+
+    const auto* x { samples.data() };
+    auto* r { residuals.data() };
+
+    switch (order) {
+        case 0:
+            std::copy_n(x, size, r);
+            break;
+        case 1:
+            for (auto i { std::size_t { 1 } }; i < size; ++i)
+                r[i - 1] = x[i] - x[i - 1];
+            break;
+        case 2:
+            for (auto i { std::size_t { 2 } }; i < size; ++i)
+                r[i - 2] = x[i] - 2 * x[i - 1] + x[i - 2];
+            break;
+        case 3:
+            for (auto i { std::size_t { 3 } }; i < size; ++i)
+                r[i - 3] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+            break;
+        case 4:
+            for (auto i { std::size_t { 4 } }; i < size; ++i)
+                r[i - 4] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+            break;
+        default:
+            std::unreachable();
+    }
+}
+
+// Picks the fixed predictor order with the smallest sum of absolute residuals, in a single pass over the samples
+[[nodiscard]] auto selectFixedOrder(const std::span<const std::int32_t> samples) -> unsigned int {
+    const auto size { samples.size() };
+    const auto maxOrder { static_cast<unsigned int>(std::min<std::size_t>(maxFixedOrder, size - 1)) };
+
+    std::array<std::uint64_t, maxFixedOrder + 1> errors {};
+
+    for (auto i { std::size_t { maxOrder } }; i < size; ++i) {
+        const auto e0 { static_cast<std::int64_t>(samples[i]) };
+        const auto e1 { i >= 1 ? e0 - samples[i - 1] : 0 };
+        const auto e2 { i >= 2 ? e1 - (static_cast<std::int64_t>(samples[i - 1]) - samples[i - 2]) : 0 };
+        const auto e3 { i >= 3 ? e2 - (static_cast<std::int64_t>(samples[i - 1]) - 2 * static_cast<std::int64_t>(samples[i - 2]) + samples[i - 3]) : 0 };
+        const auto e4 { i >= 4 ? e3 - (static_cast<std::int64_t>(samples[i - 1]) - 3 * static_cast<std::int64_t>(samples[i - 2]) +
+            3 * static_cast<std::int64_t>(samples[i - 3]) - samples[i - 4]) : 0 };
+
+        errors[0] += static_cast<std::uint64_t>(std::abs(e0));
+        errors[1] += static_cast<std::uint64_t>(std::abs(e1));
+        errors[2] += static_cast<std::uint64_t>(std::abs(e2));
+        errors[3] += static_cast<std::uint64_t>(std::abs(e3));
+        errors[4] += static_cast<std::uint64_t>(std::abs(e4));
+    }
+
+    const auto candidates { std::span { errors }.first(maxOrder + 1) };
+    return static_cast<unsigned int>(std::ranges::distance(std::ranges::begin(candidates), std::ranges::min_element(candidates)));
+}
+
+struct RicePartitioning final {
+    unsigned int m_partitionOrder;
+    std::array<unsigned int, 1 << maxPartitionOrder> m_parameters;
+    // Rice coded size without the partition parameters
+    std::uint64_t m_bits;
+};
+
+// Estimated cost of rice coding a partition: a unary quotient plus a stop bit and parameter bits per sample
+[[nodiscard]] auto bestRiceParameter(const std::uint64_t sum, const std::uint64_t count) -> std::pair<unsigned int, std::uint64_t> {
+    auto bestParameter { 0u };
+    auto bestBits { std::numeric_limits<std::uint64_t>::max() };
+
+    for (auto parameter { 0u }; parameter <= maxRiceParameter; ++parameter) {
+        const auto bits { count * (parameter + 1) + (sum >> parameter) };
+
+        if (bits < bestBits) {
+            bestBits = bits;
+            bestParameter = parameter;
+        }
+    }
+
+    return { bestParameter, bestBits };
+}
+
+// Sums are computed for the finest partitioning and merged pairwise for the coarser ones
+[[nodiscard]] auto selectRicePartitioning(const std::span<const std::uint32_t> residuals, const std::uint32_t blockSize, const unsigned int predictorOrder) -> RicePartitioning {
+    auto maxOrder { 0u };
+
+    while (maxOrder < maxPartitionOrder and (blockSize % (1u << (maxOrder + 1))) == 0 and (blockSize >> (maxOrder + 1)) > predictorOrder) {
+        ++maxOrder;
+    }
+
+    std::array<std::uint64_t, 1 << maxPartitionOrder> sums {};
+    const auto partitionSize { blockSize >> maxOrder };
+
+    for (auto partition { 0u }, offset { 0u }; partition < (1u << maxOrder); ++partition) {
+        const auto count { partition == 0 ? partitionSize - predictorOrder : partitionSize };
+
+        for (auto i { offset }; i < offset + count; ++i) {
+            sums[partition] += residuals[i];
+        }
+
+        offset += count;
+    }
+
+    RicePartitioning best { .m_partitionOrder = 0, .m_parameters = {}, .m_bits = std::numeric_limits<std::uint64_t>::max() };
+
+    for (auto order { maxOrder + 1 }; order-- > 0;) {
+        if (order != maxOrder) {
+            for (auto partition { 0u }; partition < (1u << order); ++partition) {
+                sums[partition] = sums[2 * partition] + sums[2 * partition + 1];
+            }
+        }
+
+        RicePartitioning candidate { .m_partitionOrder = order, .m_parameters = {}, .m_bits = 0 };
+
+        for (auto partition { 0u }; partition < (1u << order); ++partition) {
+            const auto count { (blockSize >> order) - (partition == 0 ? predictorOrder : 0) };
+            const auto [parameter, bits] { bestRiceParameter(sums[partition], count) };
+
+            candidate.m_parameters[partition] = parameter;
+            // Parameter bits are counted as for RICE2, a close enough estimate for both methods
+            candidate.m_bits += bits + 5;
+        }
+
+        if (candidate.m_bits < best.m_bits) {
+            best = candidate;
+        }
+    }
+
+    return best;
+}
+
+// Scratch buffers reused for every subframe of a frame
+struct SubframeScratch final {
+    std::vector<std::int32_t> m_residuals;
+    std::vector<std::uint32_t> m_folded;
+};
+
+struct SubframePlan final {
+    enum class Type { Constant, Verbatim, Fixed } m_type;
+    unsigned int m_order;
+    RicePartitioning m_partitioning;
+    std::uint64_t m_bits;
+};
+
+[[nodiscard]] auto planSubframe(const std::span<const std::int32_t> samples, const unsigned int bitsPerSample, SubframeScratch& scratch) -> SubframePlan {
+    const auto blockSize { static_cast<std::uint32_t>(samples.size()) };
+    constexpr std::uint64_t headerBits { 8 };
+
+    if (std::ranges::all_of(samples, [first = samples.front()] (const auto sample) { return sample == first; })) {
+        return { .m_type = SubframePlan::Type::Constant, .m_order = 0, .m_partitioning = {}, .m_bits = headerBits + bitsPerSample };
+    }
+
+    const auto verbatimBits { headerBits + std::uint64_t { blockSize } * bitsPerSample };
+
+    const auto order { selectFixedOrder(samples) };
+    computeResiduals(samples, order, scratch.m_residuals);
+
+    scratch.m_folded.resize(scratch.m_residuals.size());
+    std::ranges::transform(scratch.m_residuals, std::ranges::begin(scratch.m_folded), zigzag);
+
+    const auto partitioning { selectRicePartitioning(scratch.m_folded, blockSize, order) };
+    // Coding method and partition order, followed by the warm-up samples
+    const auto fixedBits { headerBits + 6 + std::uint64_t { order } * bitsPerSample + partitioning.m_bits };
+
+    if (fixedBits >= verbatimBits) {
+        return { .m_type = SubframePlan::Type::Verbatim, .m_order = 0, .m_partitioning = {}, .m_bits = verbatimBits };
+    }
+
+    return { .m_type = SubframePlan::Type::Fixed, .m_order = order, .m_partitioning = partitioning, .m_bits = fixedBits };
+}
+
+auto writeSubframe(BitWriter& writer, const std::span<const std::int32_t> samples, const unsigned int bitsPerSample, SubframeScratch& scratch) -> void {
+    const auto plan { planSubframe(samples, bitsPerSample, scratch) };
+
+    // Zero padding bit, subframe type and no wasted bits
+    switch (plan.m_type) {
+        case SubframePlan::Type::Constant:
+            writer.write(0b0'000000'0, 8);
+            writer.writeSigned(samples.front(), bitsPerSample);
+            return;
+
+        case SubframePlan::Type::Verbatim:
+            writer.write(0b0'000001'0, 8);
+
+            for (const auto sample: samples) {
+                writer.writeSigned(sample, bitsPerSample);
+            }
+
+            return;
+
+        case SubframePlan::Type::Fixed:
+            break;
+    }
+
+    writer.write((0b001000u | plan.m_order) << 1, 8);
+
+    for (const auto sample: samples.first(plan.m_order)) {
+        writer.writeSigned(sample, bitsPerSample);
+    }
+
+    // Residuals of planSubframe() are still in the scratch buffers
+    const auto& partitioning { plan.m_partitioning };
+    const auto partitionCount { 1u << partitioning.m_partitionOrder };
+    const auto useRice2 { std::ranges::any_of(std::span { partitioning.m_parameters }.first(partitionCount), [] (const auto parameter) { return parameter > maxRice1Parameter; }) };
+
+    writer.write(useRice2 ? 0b01 : 0b00, 2);
+    writer.write(partitioning.m_partitionOrder, 4);
+
+    const auto partitionSize { static_cast<std::uint32_t>(samples.size()) >> partitioning.m_partitionOrder };
+    auto residual { scratch.m_folded.cbegin() };
+
+    for (auto partition { 0u }; partition < partitionCount; ++partition) {
+        const auto parameter { partitioning.m_parameters[partition] };
+        const auto count { partitionSize - (partition == 0 ? plan.m_order : 0) };
+
+        writer.write(parameter, useRice2 ? 5 : 4);
+
+        for (const auto end { residual + count }; residual != end; ++residual) {
+            writer.writeUnary(*residual >> parameter);
+            writer.write(*residual, parameter);
+        }
+    }
+}
+
+}
+
+auto encodeStreamHeader(const StreamParameters& parameters, const StreamInfo& info) -> std::vector<std::uint8_t> {
+    std::vector<std::uint8_t> output { 'f', 'L', 'a', 'C' };
+    output.reserve(42);
+
+    BitWriter writer { output };
+
+    // Last metadata block, STREAMINFO type, 34 bytes
+    writer.write(1, 1);
+    writer.write(0, 7);
+    writer.write(34, 24);
+
+    writer.write(parameters.m_blockSize, 16);
+    writer.write(parameters.m_blockSize, 16);
+    writer.write(info.m_minFrameSize, 24);
+    writer.write(info.m_maxFrameSize, 24);
+    writer.write(parameters.m_sampleRate, 20);
+    writer.write(parameters.m_channelCount - 1, 3);
+    writer.write(parameters.m_bitsPerSample - 1, 5);
+    writer.write(info.m_totalSamples >> 32, 4);
+    writer.write(info.m_totalSamples & 0xFFFFFFFFu, 32);
+
+    output.resize(output.size() + 16, 0);
+
+    return output;
+}
+
+auto encodeFrame(const StreamParameters& parameters, const std::uint64_t frameNumber, const std::span<const std::int32_t> samples,
+    const std::uint32_t blockSize) -> std::vector<std::uint8_t> {
+
+    const auto bitsPerSample { parameters.m_bitsPerSample };
+    const auto channelCount { parameters.m_channelCount };
+
+    std::vector<std::uint8_t> output {};
+    // Worst case is verbatim subframes
+    output.reserve(16 + std::size_t { blockSize } * channelCount * (bitsPerSample + 1) / 8 + channelCount + 2);
+
+    auto channel { [&] (const unsigned int index) { return samples.subspan(std::size_t { index } * blockSize, blockSize); } };
+
+    SubframeScratch scratch {};
+    auto channelAssignment { std::uint32_t { channelCount - 1 } };
+
+    // Stereo decorrelation: side needs one extra bit, pick the cheapest pair of subframes
+    std::vector<std::int32_t> mid {};
+    std::vector<std::int32_t> side {};
+
+    if (channelCount == 2) {
+        const auto left { channel(0) };
+        const auto right { channel(1) };
+
+        mid.resize(blockSize);
+        side.resize(blockSize);
+
+        for (auto i { std::size_t { 0 } }; i < blockSize; ++i) {
+            mid[i] = (left[i] + right[i]) >> 1;
+            side[i] = left[i] - right[i];
+        }
+
+        const auto leftBits { planSubframe(left, bitsPerSample, scratch).m_bits };
+        const auto rightBits { planSubframe(right, bitsPerSample, scratch).m_bits };
+        const auto midBits { planSubframe(mid, bitsPerSample, scratch).m_bits };
+        const auto sideBits { planSubframe(side, bitsPerSample + 1, scratch).m_bits };
+
+        const std::array candidates {
+            std::pair { leftBits + rightBits, channelAssignment },
+            std::pair { leftBits + sideBits, std::to_underlying(ChannelAssignment::LeftSide) },
+            std::pair { sideBits + rightBits, std::to_underlying(ChannelAssignment::RightSide) },
+            std::pair { midBits + sideBits, std::to_underlying(ChannelAssignment::MidSide) }
+        };
+
+        channelAssignment = std::ranges::min(candidates, {}, &std::pair<std::uint64_t, std::uint32_t>::first).second;
+    }
+
+    BitWriter writer { output };
+
+    // Sync code, reserved bit and fixed block size strategy
+    writer.write(0b11111111111110'0'0, 16);
+    const auto sizeCode { blockSizeCode(blockSize) };
+    writer.write(sizeCode, 4);
+    writer.write(sampleRateCode(parameters.m_sampleRate), 4);
+    writer.write(channelAssignment, 4);
+    writer.write(sampleSizeCode(bitsPerSample), 3);
+    writer.write(0, 1);
+    writeFrameNumber(writer, frameNumber);
+
+    if (sizeCode == 0b0110) {
+        writer.write(blockSize - 1, 8);
+    } else if (sizeCode == 0b0111) {
+        writer.write(blockSize - 1, 16);
+    }
+
+    writer.write(crc8(output), 8);
+
+    switch (channelAssignment) {
+        case std::to_underlying(ChannelAssignment::LeftSide):
+            writeSubframe(writer, channel(0), bitsPerSample, scratch);
+            writeSubframe(writer, side, bitsPerSample + 1, scratch);
+            break;
+        case std::to_underlying(ChannelAssignment::RightSide):
+            writeSubframe(writer, side, bitsPerSample + 1, scratch);
+            writeSubframe(writer, channel(1), bitsPerSample, scratch);
+            break;
+        case std::to_underlying(ChannelAssignment::MidSide):
+            writeSubframe(writer, mid, bitsPerSample, scratch);
+            writeSubframe(writer, side, bitsPerSample + 1, scratch);
+            break;
+        default:
+            for (auto index { 0u }; index < channelCount; ++index) {
+                writeSubframe(writer, channel(index), bitsPerSample, scratch);
+            }
+    }
+
+    writer.alignToByte();
+    writer.write(crc16(output), 16);
+
+    return output;
+}
+
+auto isStreamSupported(const StreamParameters& parameters) -> std::expected<void, std::string> {
+    if (parameters.m_bitsPerSample != 16 and parameters.m_bitsPerSample != 24) {
+        return std::unexpected { "Only 16 and 24 bits per sample are supported" };
+    }
+
+    if (parameters.m_channelCount == 0 or parameters.m_channelCount > 8) {
+        return std::unexpected { "Invalid channel count" };
+    }
+
+    if (parameters.m_sampleRate == 0 or parameters.m_sampleRate >= (1u << 20)) {
+        return std::unexpected { "Invalid sample rate" };
+    }
+
+    if (parameters.m_blockSize < 16 or parameters.m_blockSize > 65535) {
+        return std::unexpected { "Invalid block size" };
+    }
+
+    return {};
+}
+
+}
@@ -0,0 +1,37 @@
+export module flac_encoder;
+
+import std;
+
+import audio_device;
+
+namespace audio_engine::flac_encoder {
+
+// Every frame but the last one has this many samples per channel
+export constexpr std::uint32_t defaultBlockSize { 4096 };
+
+export struct StreamParameters final {
+    audio_device::SampleRate_t m_sampleRate;
+    audio_device::ChannelCount_t m_channelCount;
+    unsigned int m_bitsPerSample;
+    std::uint32_t m_blockSize;
+};
+
+export struct StreamInfo final {
+    std::uint64_t m_totalSamples;
+    std::uint32_t m_minFrameSize;
+    std::uint32_t m_maxFrameSize;
+};
+
+// "fLaC" marker followed by the STREAMINFO block. Its size never changes, so it can be rewritten in place once the stream is complete.
+// MD5 signature is left to 0, which means unknown
+export [[nodiscard]] auto encodeStreamHeader(const StreamParameters& parameters, const StreamInfo& info) -> std::vector<std::uint8_t>;
+
+// Encodes one frame with fixed predictors and rice coded residuals. Frames do not depend on each other,
+// so they can be encoded in parallel and written in frame number order.
+// Samples are planar: channel c starts at c * blockSize
+export [[nodiscard]] auto encodeFrame(const StreamParameters& parameters, std::uint64_t frameNumber,
+    std::span<const std::int32_t> samples, std::uint32_t blockSize) -> std::vector<std::uint8_t>;
+
+export [[nodiscard]] auto isStreamSupported(const StreamParameters& parameters) -> std::expected<void, std::string>;
+
+}
@@ -1,7 +1,10 @@
 module;
 #include <miniaudio.h>
+#include "trace_macros.h"
 module miniaudio_library_wrapper;
 
+import tracing;
+
 namespace audio_engine::audio_library_wrapper {
 
 auto miniaudioLogCallback(void* userData, [[maybe_unused]] ma_uint32 logLevel, const char* logMessage) -> void {
@@ -12,7 +15,8 @@ MiniaudioLibraryWrapper::MiniaudioLibraryWrapper(const LogCallback& logCallback,
  :  AudioLibraryWrapper { logCallback },
     m_context {},
     m_log {},
-    m_device {} {
+    m_device {},
+    m_callbackThread {} {
 
     const auto backendResult { audio_driver::toBackend(audioDriver) };
     const std::array backendList { backendResult.value() };
@@ -120,6 +124,13 @@ auto MiniaudioLibraryWrapper::audioDriver() const -> std::expected<audio_driver:
 auto miniaudioAudioCallback(ma_device* device, void* outputBuffer, const void* inputBuffer, ma_uint32 frameCount) -> void {
     const auto miniaudio { static_cast<MiniaudioLibraryWrapper*>(device->pUserData) };
 
+    // The backend may run the callback on another thread after a restart
+    if constexpr (tracing::enabled) {
+        miniaudio->m_callbackThread->attach();
+    }
+
+    TRACE_SPAN("audio", "miniaudioAudioCallback");
+
     miniaudio->m_inputAudioBuffer->copyFromRawBuffer(static_cast<const float*>(inputBuffer), device->capture.channels, frameCount);
     miniaudio->m_outputAudioBuffer->clear();
     miniaudio->m_audioCallback(*miniaudio->m_inputAudioBuffer, *miniaudio->m_outputAudioBuffer);
@@ -182,9 +193,16 @@ auto MiniaudioLibraryWrapper::openStream(const audio_stream_params::AudioStreamP
 
 auto MiniaudioLibraryWrapper::closeStream() -> void {
     ma_device_uninit(&m_device);
+    m_callbackThread.reset();
 }
 
 auto MiniaudioLibraryWrapper::startStream() -> bool {
+    if constexpr (tracing::enabled) {
+        if (not m_callbackThread.has_value()) {
+            m_callbackThread.emplace("audio callback");
+        }
+    }
+
     return ma_device_start(&m_device) == MA_SUCCESS;
 }
 
@@ -8,6 +8,7 @@ import audio_driver;
 import audio_library_wrapper;
 import audio_stream_params;
 import audio_buffer;
+import tracing;
 
 namespace audio_engine::audio_library_wrapper {
 
@@ -33,6 +34,8 @@ private:
     ma_context m_context;
     ma_log  m_log;
     ma_device m_device;
+    // Reserved before the stream starts, so that the callback records its spans without locking nor allocating
+    std::optional<tracing::ReservedThread> m_callbackThread;
 };
 
 template<>
@@ -0,0 +1,312 @@
+module;
+#if defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+    #define PCM_CONVERTER_SSE2
+    #include <emmintrin.h>
+
+    #if defined(__SSSE3__) or defined(__AVX__)
+        #define PCM_CONVERTER_SSSE3
+        #include <tmmintrin.h>
+    #endif
+#endif
+export module pcm_converter;
+
+import std;
+
+import audio_format;
+import audio_buffer;
+
+namespace audio_engine::pcm_converter {
+
+export template <audio_format::AudioFormat format> requires (format == audio_format::AudioFormat::SignedInt16) or
+    (format == audio_format::AudioFormat::SignedInt24) or (format == audio_format::AudioFormat::Float32)
+struct PcmSample;
+
+template <>
+struct PcmSample<audio_format::AudioFormat::SignedInt16> {
+    using type = std::int16_t;
+    static constexpr std::size_t elementsPerSample { 1 };
+};
+
+// 24-bit samples are packed little endian, 3 bytes each
+template <>
+struct PcmSample<audio_format::AudioFormat::SignedInt24> {
+    using type = std::uint8_t;
+    static constexpr std::size_t elementsPerSample { 3 };
+};
+
+template <>
+struct PcmSample<audio_format::AudioFormat::Float32> {
+    using type = float;
+    static constexpr std::size_t elementsPerSample { 1 };
+};
+
+export template <audio_format::AudioFormat format> using PcmSample_t = typename PcmSample<format>::type;
+
+// Triangular dither spanning +-1 LSB. Every 32-bit xorshift draw is split in two 16-bit uniform values whose
+// difference has a triangular distribution, so one generator step gives one dither value.
+// Four independent lanes are kept so that the SIMD kernels can advance them in a single register.
+export struct TpdfDither final {
+    explicit TpdfDither(const std::uint32_t seed = 0x6d2b79f5u)
+     :  m_lanes {} {
+        for (auto lane { std::uint32_t { 0 } }; auto& state: m_lanes) {
+            // xorshift gets stuck on 0, so we force the lowest bit
+            state = mix(seed + 0x9e3779b9u * ++lane) | 1u;
+        }
+    }
+
+    [[nodiscard]] auto next() -> float {
+        m_lanes[0] = xorshift(m_lanes[0]);
+        return toTriangular(m_lanes[0]);
+    }
+
+    [[nodiscard]] static constexpr auto xorshift(std::uint32_t state) -> std::uint32_t {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    [[nodiscard]] static constexpr auto toTriangular(const std::uint32_t random) -> float {
+        return static_cast<float>(static_cast<std::int32_t>(random & 0xFFFFu) - static_cast<std::int32_t>(random >> 16)) * (1.0f / 65536.0f);
+    }
+
+    alignas(16) std::array<std::uint32_t, 4> m_lanes;
+
+private:
+    [[nodiscard]] static constexpr auto mix(std::uint32_t value) -> std::uint32_t {
+        value = (value ^ (value >> 16)) * 0x45d9f3bu;
+        value = (value ^ (value >> 16)) * 0x45d9f3bu;
+        return value ^ (value >> 16);
+    }
+};
+
+// Full scale values: positive full scale is used for scaling so that +1.0 does not overflow
+constexpr float signedInt16Scale { 32767.0f };
+constexpr float signedInt24Scale { 8388607.0f };
+
+[[nodiscard]] auto quantize(const float sample, const float scale, TpdfDither& dither) -> std::int32_t {
+    const auto dithered { std::clamp(sample, -1.0f, 1.0f) * scale + dither.next() };
+    return static_cast<std::int32_t>(std::lrint(std::clamp(dithered, -scale - 1.0f, scale)));
+}
+
+auto storeSignedInt24(const std::int32_t sample, std::uint8_t* output) -> void {
+    output[0] = static_cast<std::uint8_t>(sample & 0xFF);
+    output[1] = static_cast<std::uint8_t>((sample >> 8) & 0xFF);
+    output[2] = static_cast<std::uint8_t>((sample >> 16) & 0xFF);
+}
+
+#ifdef PCM_CONVERTER_SSE2
+constexpr std::size_t simdWidth { 4 };
+
+[[nodiscard]] auto nextDither(__m128i& state) -> __m128 {
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+    state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+    state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+
+    const auto low { _mm_and_si128(state, _mm_set1_epi32(0xFFFF)) };
+    const auto high { _mm_srli_epi32(state, 16) };
+
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(low, high)), _mm_set1_ps(1.0f / 65536.0f));
+}
+
+// Same as quantize(), 4 samples at a time. Conversion rounds to nearest as the default MXCSR mode is used
+[[nodiscard]] auto quantize(const __m128 samples, const __m128 scale, __m128i& dither) -> __m128i {
+    const auto clamped { _mm_max_ps(_mm_min_ps(samples, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f)) };
+    const auto dithered { _mm_add_ps(_mm_mul_ps(clamped, scale), nextDither(dither)) };
+    const auto limited { _mm_max_ps(_mm_min_ps(dithered, scale), _mm_sub_ps(_mm_setzero_ps(), _mm_add_ps(scale, _mm_set1_ps(1.0f)))) };
+
+    return _mm_cvtps_epi32(limited);
+}
+
+// Writes 4 packed 24-bit samples, exactly 12 bytes
+auto storeSignedInt24(const __m128i samples, std::uint8_t* output) -> void {
+#ifdef PCM_CONVERTER_SSSE3
+    const auto packed { _mm_shuffle_epi8(samples, _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1)) };
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(output), packed);
+
+    const auto tail { _mm_cvtsi128_si32(_mm_srli_si128(packed, 8)) };
+    std::memcpy(output + 8, &tail, sizeof(tail));
+#else
+    alignas(16) std::array<std::int32_t, simdWidth> lanes {};
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes.data()), samples);
+
+    for (auto lane { std::size_t { 0 } }; lane < simdWidth; ++lane) {
+        storeSignedInt24(lanes[lane], output + lane * 3);
+    }
+#endif
+}
+#endif
+
+// Planar float to interleaved 16-bit signed int with dither. Right channel is ignored when empty
+auto interleaveToSignedInt16(const float* left, const float* right, std::int16_t* output, const std::size_t frames, TpdfDither& dither) -> void {
+    std::size_t frame { 0 };
+
+#ifdef PCM_CONVERTER_SSE2
+    auto state { _mm_load_si128(reinterpret_cast<const __m128i*>(dither.m_lanes.data())) };
+    const auto scale { _mm_set1_ps(signedInt16Scale) };
+
+    if (right != nullptr) {
+        for (; frame + simdWidth <= frames; frame += simdWidth) {
+            const auto leftSamples { _mm_loadu_ps(left + frame) };
+            const auto rightSamples { _mm_loadu_ps(right + frame) };
+
+            const auto first { quantize(_mm_unpacklo_ps(leftSamples, rightSamples), scale, state) };
+            const auto second { quantize(_mm_unpackhi_ps(leftSamples, rightSamples), scale, state) };
+
+            // Saturating pack, a no-op because samples are already limited
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + frame * 2), _mm_packs_epi32(first, second));
+        }
+    } else {
+        for (; frame + simdWidth <= frames; frame += simdWidth) {
+            const auto samples { quantize(_mm_loadu_ps(left + frame), scale, state) };
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(output + frame), _mm_packs_epi32(samples, samples));
+        }
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(dither.m_lanes.data()), state);
+#endif
+
+    const auto channels { right != nullptr ? std::size_t { 2 } : std::size_t { 1 } };
+
+    for (; frame < frames; ++frame) {
+        output[frame * channels] = static_cast<std::int16_t>(quantize(left[frame], signedInt16Scale, dither));
+
+        if (right != nullptr)
+            output[frame * channels + 1] = static_cast<std::int16_t>(quantize(right[frame], signedInt16Scale, dither));
+    }
+}
+
+// Planar float to interleaved and packed 24-bit signed int with dither. Right channel is ignored when empty
+auto interleaveToSignedInt24(const float* left, const float* right, std::uint8_t* output, const std::size_t frames, TpdfDither& dither) -> void {
+    std::size_t frame { 0 };
+
+#ifdef PCM_CONVERTER_SSE2
+    auto state { _mm_load_si128(reinterpret_cast<const __m128i*>(dither.m_lanes.data())) };
+    const auto scale { _mm_set1_ps(signedInt24Scale) };
+
+    if (right != nullptr) {
+        for (; frame + simdWidth <= frames; frame += simdWidth) {
+            const auto leftSamples { _mm_loadu_ps(left + frame) };
+            const auto rightSamples { _mm_loadu_ps(right + frame) };
+
+            storeSignedInt24(quantize(_mm_unpacklo_ps(leftSamples, rightSamples), scale, state), output + frame * 6);
+            storeSignedInt24(quantize(_mm_unpackhi_ps(leftSamples, rightSamples), scale, state), output + frame * 6 + 12);
+        }
+    } else {
+        for (; frame + simdWidth <= frames; frame += simdWidth) {
+            storeSignedInt24(quantize(_mm_loadu_ps(left + frame), scale, state), output + frame * 3);
+        }
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(dither.m_lanes.data()), state);
+#endif
+
+    const auto channels { right != nullptr ? std::size_t { 2 } : std::size_t { 1 } };
+
+    for (; frame < frames; ++frame) {
+        storeSignedInt24(quantize(left[frame], signedInt24Scale, dither), output + frame * channels * 3);
+
+        if (right != nullptr)
+            storeSignedInt24(quantize(right[frame], signedInt24Scale, dither), output + frame * channels * 3 + 3);
+    }
+}
+
+// Planar float to interleaved float. No dither is needed. Right channel is ignored when empty
+auto interleaveToFloat32(const float* left, const float* right, float* output, const std::size_t frames) -> void {
+    if (right == nullptr) {
+        std::copy_n(left, frames, output);
+        return;
+    }
+
+    std::size_t frame { 0 };
+
+#ifdef PCM_CONVERTER_SSE2
+    for (; frame + simdWidth <= frames; frame += simdWidth) {
+        const auto leftSamples { _mm_loadu_ps(left + frame) };
+        const auto rightSamples { _mm_loadu_ps(right + frame) };
+
+        _mm_storeu_ps(output + frame * 2, _mm_unpacklo_ps(leftSamples, rightSamples));
+        _mm_storeu_ps(output + frame * 2 + simdWidth, _mm_unpackhi_ps(leftSamples, rightSamples));
+    }
+#endif
+
+    for (; frame < frames; ++frame) {
+        output[frame * 2] = left[frame];
+        output[frame * 2 + 1] = right[frame];
+    }
+}
+
+// Single channel float to dithered signed int, each sample held in 32 bits
+auto quantizeChannel(const float* input, std::int32_t* output, const std::size_t frames, const float scale, TpdfDither& dither) -> void {
+    std::size_t frame { 0 };
+
+#ifdef PCM_CONVERTER_SSE2
+    auto state { _mm_load_si128(reinterpret_cast<const __m128i*>(dither.m_lanes.data())) };
+    const auto scaleVector { _mm_set1_ps(scale) };
+
+    for (; frame + simdWidth <= frames; frame += simdWidth) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + frame), quantize(_mm_loadu_ps(input + frame), scaleVector, state));
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(dither.m_lanes.data()), state);
+#endif
+
+    for (; frame < frames; ++frame) {
+        output[frame] = quantize(input[frame], scale, dither);
+    }
+}
+
+// Number of output elements needed to convert a buffer of the given size
+export template <audio_format::AudioFormat format>
+[[nodiscard]] constexpr auto outputSize(const std::size_t frames, const std::size_t channels) -> std::size_t {
+    return frames * channels * PcmSample<format>::elementsPerSample;
+}
+
+// Converts a mono or stereo planar float view to interleaved samples of the given format in a single pass.
+// Returns false when the view is neither mono nor stereo, channels differ in length or the output is too small
+export template <audio_format::AudioFormat format>
+[[nodiscard]] auto convert(const audio_buffer::ReadOnlyAudioBufferView<float>& input, std::span<PcmSample_t<format>> output, TpdfDither& dither) -> bool {
+    const auto isMono { not input.m_leftMono.empty() and input.m_right.empty() };
+    const auto isStereo { not input.m_leftMono.empty() and not input.m_right.empty() };
+
+    if (not isMono and not isStereo) {
+        return false;
+    }
+
+    if (isStereo and input.m_leftMono.size() != input.m_right.size()) {
+        return false;
+    }
+
+    const auto frames { input.m_leftMono.size() };
+
+    if (output.size() < outputSize<format>(frames, isStereo ? 2 : 1)) {
+        return false;
+    }
+
+    const auto* right { isStereo ? input.m_right.data() : nullptr };
+
+    if constexpr (format == audio_format::AudioFormat::SignedInt16) {
+        interleaveToSignedInt16(input.m_leftMono.data(), right, output.data(), frames, dither);
+    } else if constexpr (format == audio_format::AudioFormat::SignedInt24) {
+        interleaveToSignedInt24(input.m_leftMono.data(), right, output.data(), frames, dither);
+    } else {
+        interleaveToFloat32(input.m_leftMono.data(), right, output.data(), frames);
+    }
+
+    return true;
+}
+
+// Converts one planar channel to dithered 16 or 24-bit samples without packing them, for encoders working on planar integers.
+// Returns false when the output is too small
+export template <audio_format::AudioFormat format> requires (format == audio_format::AudioFormat::SignedInt16) or (format == audio_format::AudioFormat::SignedInt24)
+[[nodiscard]] auto convertPlanar(const std::span<const float> input, std::span<std::int32_t> output, TpdfDither& dither) -> bool {
+    if (output.size() < input.size()) {
+        return false;
+    }
+
+    quantizeChannel(input.data(), output.data(), input.size(), format == audio_format::AudioFormat::SignedInt16 ? signedInt16Scale : signedInt24Scale, dither);
+
+    return true;
+}
+
+}
@@ -0,0 +1,359 @@
+module;
+#if defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+    #define PEAK_FILE_SSE2
+    #include <emmintrin.h>
+#endif
+module peak_file;
+
+namespace audio_engine::peak_file {
+
+namespace {
+
+constexpr std::array<char, 4> magic { 'M', 'P', 'K', 'S' };
+constexpr std::uint16_t version { 1 };
+// Magic, version, channel count, sample rate and level count, then the bin sizes and the frame count
+constexpr std::size_t fixedHeaderSize { 16 };
+constexpr std::size_t peakSize { 2 * sizeof(float) };
+
+constexpr Peak emptyPeak { std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest() };
+
+static_assert(std::ranges::adjacent_find(binSizes, [] (const auto finer, const auto coarser) { return coarser % finer != 0; }) == binSizes.end());
+
+[[nodiscard]] auto merge(const Peak& first, const Peak& second) -> Peak {
+    return { std::min(first.m_min, second.m_min), std::max(first.m_max, second.m_max) };
+}
+
+template <typename T> requires std::is_unsigned_v<T>
+auto appendLittleEndian(std::vector<std::uint8_t>& bytes, const T value) -> void {
+    for (std::size_t byte { 0 }; byte < sizeof(T); ++byte) {
+        bytes.push_back(static_cast<std::uint8_t>((value >> (8 * byte)) & 0xFFu));
+    }
+}
+
+template <typename T> requires std::is_unsigned_v<T>
+[[nodiscard]] auto readLittleEndian(const std::span<const std::uint8_t> bytes, const std::size_t offset) -> T {
+    T value { 0 };
+
+    for (std::size_t byte { 0 }; byte < sizeof(T); ++byte) {
+        value |= static_cast<T>(T { bytes[offset + byte] } << (8 * byte));
+    }
+
+    return value;
+}
+
+[[nodiscard]] auto readBytes(std::ifstream& file, const std::size_t size) -> std::optional<std::vector<std::uint8_t>> {
+    std::vector<std::uint8_t> bytes(size);
+
+    if (not file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size))) {
+        return std::nullopt;
+    }
+
+    return bytes;
+}
+
+}
+
+auto computePeak(const std::span<const float> samples) -> Peak {
+    auto peak { emptyPeak };
+    std::size_t sample { 0 };
+
+#if defined(PEAK_FILE_SSE2)
+    if (samples.size() >= 4) {
+        auto minimum { _mm_set1_ps(emptyPeak.m_min) };
+        auto maximum { _mm_set1_ps(emptyPeak.m_max) };
+
+        // Samples come first so that a NaN keeps the running value, as the scalar comparisons do
+        for (; sample + 8 <= samples.size(); sample += 8) {
+            const auto first { _mm_loadu_ps(samples.data() + sample) };
+            const auto second { _mm_loadu_ps(samples.data() + sample + 4) };
+
+            minimum = _mm_min_ps(second, _mm_min_ps(first, minimum));
+            maximum = _mm_max_ps(second, _mm_max_ps(first, maximum));
+        }
+
+        for (; sample + 4 <= samples.size(); sample += 4) {
+            const auto values { _mm_loadu_ps(samples.data() + sample) };
+
+            minimum = _mm_min_ps(values, minimum);
+            maximum = _mm_max_ps(values, maximum);
+        }
+
+        alignas(16) std::array<float, 4> minimums {};
+        alignas(16) std::array<float, 4> maximums {};
+        _mm_store_ps(minimums.data(), minimum);
+        _mm_store_ps(maximums.data(), maximum);
+
+        peak = { std::ranges::min(minimums), std::ranges::max(maximums) };
+    }
+#endif
+
+    for (; sample < samples.size(); ++sample) {
+        peak = merge(peak, { samples[sample], samples[sample] });
+    }
+
+    return peak;
+}
+
+PeakWriter::PeakWriter(std::string_view fileName, const audio_device::SampleRate_t sampleRate, const audio_device::ChannelCount_t channelCount)
+  : m_file {},
+    m_sampleRate { sampleRate },
+    m_channelCount { channelCount },
+    m_totalFrames { 0 },
+    m_partialBins {},
+    m_partialFrames {},
+    m_completedBins {},
+    m_bytes {} {
+
+    if (channelCount == 0 or channelCount > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::invalid_argument { "Invalid channel count" };
+    }
+
+    for (auto& partialBin: m_partialBins) {
+        partialBin.assign(channelCount, emptyPeak);
+    }
+
+    m_file.open(std::string { fileName }.append(".peaks"), std::ios::binary | std::ios::trunc);
+
+    if (not m_file.is_open()) {
+        throw std::runtime_error("Failed to initialize peak file");
+    }
+
+    // Written again with the frame count once complete
+    writeHeader();
+}
+
+PeakWriter::~PeakWriter() {
+    // Last bins are shorter, finer ones are completed first as they are merged in the coarser ones
+    for (std::size_t level { 0 }; level < binSizes.size(); ++level) {
+        if (m_partialFrames[level] != 0) {
+            completeBin(level);
+        }
+    }
+
+    for (const auto& completedBins: m_completedBins) {
+        writePeaks(completedBins);
+    }
+
+    m_file.seekp(0);
+    writeHeader();
+}
+
+auto PeakWriter::write(const audio_buffer::ReadOnlyAudioBufferView<float>& buffer) -> bool {
+    const auto isMono { not buffer.m_leftMono.empty() and buffer.m_right.empty() };
+    const auto isStereo { not buffer.m_leftMono.empty() and not buffer.m_right.empty() };
+
+    if ((isMono and m_channelCount != 1) or (isStereo and (m_channelCount != 2 or buffer.m_leftMono.size() != buffer.m_right.size()))) {
+        return false;
+    }
+
+    const std::array channels { buffer.m_leftMono, buffer.m_right };
+
+    const auto frames { buffer.m_leftMono.size() };
+
+    for (std::size_t offset { 0 }; offset < frames;) {
+        const auto count { static_cast<std::size_t>(std::min<std::uint64_t>(binSizes.front() - m_partialFrames.front(), frames - offset)) };
+
+        for (std::size_t channel { 0 }; channel < m_channelCount; ++channel) {
+            m_partialBins.front()[channel] = merge(m_partialBins.front()[channel], computePeak(channels[channel].subspan(offset, count)));
+        }
+
+        m_partialFrames.front() += count;
+        offset += count;
+
+        if (m_partialFrames.front() == binSizes.front()) {
+            completeBin(0);
+        }
+    }
+
+    m_totalFrames += frames;
+
+    writePeaks(m_completedBins.front());
+    m_completedBins.front().clear();
+
+    return m_file.good();
+}
+
+auto PeakWriter::completeBin(const std::size_t level) -> void {
+    auto& partialBin { m_partialBins[level] };
+    m_completedBins[level].insert(m_completedBins[level].end(), partialBin.begin(), partialBin.end());
+
+    if (const auto coarser { level + 1 }; coarser < binSizes.size()) {
+        for (std::size_t channel { 0 }; channel < m_channelCount; ++channel) {
+            m_partialBins[coarser][channel] = merge(m_partialBins[coarser][channel], partialBin[channel]);
+        }
+
+        m_partialFrames[coarser] += m_partialFrames[level];
+
+        if (m_partialFrames[coarser] == binSizes[coarser]) {
+            completeBin(coarser);
+        }
+    }
+
+    std::ranges::fill(partialBin, emptyPeak);
+    m_partialFrames[level] = 0;
+}
+
+auto PeakWriter::writePeaks(const std::span<const Peak> peaks) -> void {
+    if (peaks.empty()) {
+        return;
+    }
+
+    m_bytes.clear();
+
+    for (const auto& peak: peaks) {
+        appendLittleEndian(m_bytes, std::bit_cast<std::uint32_t>(peak.m_min));
+        appendLittleEndian(m_bytes, std::bit_cast<std::uint32_t>(peak.m_max));
+    }
+
+    m_file.write(reinterpret_cast<const char*>(m_bytes.data()), static_cast<std::streamsize>(m_bytes.size()));
+}
+
+auto PeakWriter::writeHeader() -> void {
+    m_bytes.clear();
+
+    for (const auto character: magic) {
+        m_bytes.push_back(static_cast<std::uint8_t>(character));
+    }
+
+    appendLittleEndian(m_bytes, version);
+    appendLittleEndian(m_bytes, static_cast<std::uint16_t>(m_channelCount));
+    appendLittleEndian(m_bytes, std::uint32_t { m_sampleRate });
+    appendLittleEndian(m_bytes, static_cast<std::uint32_t>(binSizes.size()));
+
+    for (const auto binSize: binSizes) {
+        appendLittleEndian(m_bytes, binSize);
+    }
+
+    appendLittleEndian(m_bytes, m_totalFrames);
+
+    m_file.write(reinterpret_cast<const char*>(m_bytes.data()), static_cast<std::streamsize>(m_bytes.size()));
+}
+
+auto makePeakWriter(std::string_view fileName, const audio_device::SampleRate_t sampleRate,
+    const audio_device::ChannelCount_t channelCount) -> std::expected<std::unique_ptr<PeakWriter>, std::string> {
+    if (fileName.empty()) {
+        return std::unexpected { "File name can not be empty" };
+    }
+
+    try {
+        return std::make_unique<PeakWriter>(fileName, sampleRate, channelCount);
+    } catch (const std::exception& e) {
+        return std::unexpected { std::string { e.what() } };
+    }
+}
+
+auto readPeaks(std::string_view fileName, const std::uint32_t binSize) -> std::expected<PeakLevel, std::string> {
+    const auto fileNameWithExtension { std::string { fileName }.append(".peaks") };
+
+    std::ifstream file { fileNameWithExtension, std::ios::binary };
+
+    if (not file.is_open()) {
+        return std::unexpected { "Failed to open peak file" };
+    }
+
+    const auto fixedHeader { readBytes(file, fixedHeaderSize) };
+
+    if (not fixedHeader.has_value() or not std::ranges::equal(std::span { *fixedHeader }.first(magic.size()), magic, {}, [] (const auto byte) { return static_cast<char>(byte); })) {
+        return std::unexpected { "Not a peak file" };
+    }
+
+    if (readLittleEndian<std::uint16_t>(*fixedHeader, 4) != version) {
+        return std::unexpected { "Unsupported peak file version" };
+    }
+
+    const audio_device::ChannelCount_t channelCount { readLittleEndian<std::uint16_t>(*fixedHeader, 6) };
+    const audio_device::SampleRate_t sampleRate { readLittleEndian<std::uint32_t>(*fixedHeader, 8) };
+    const auto levelCount { readLittleEndian<std::uint32_t>(*fixedHeader, 12) };
+
+    if (channelCount == 0 or levelCount == 0 or levelCount > 32) {
+        return std::unexpected { "Corrupted peak file" };
+    }
+
+    const auto header { readBytes(file, levelCount * sizeof(std::uint32_t) + sizeof(std::uint64_t)) };
+
+    if (not header.has_value()) {
+        return std::unexpected { "Corrupted peak file" };
+    }
+
+    std::vector<std::uint32_t> fileBinSizes {};
+
+    for (std::size_t level { 0 }; level < levelCount; ++level) {
+        fileBinSizes.push_back(readLittleEndian<std::uint32_t>(*header, level * sizeof(std::uint32_t)));
+
+        if (fileBinSizes.back() == 0 or fileBinSizes.back() % fileBinSizes.front() != 0) {
+            return std::unexpected { "Corrupted peak file" };
+        }
+    }
+
+    const auto levelIt { std::ranges::find(fileBinSizes, binSize) };
+
+    if (levelIt == fileBinSizes.end()) {
+        return std::unexpected { "Bin size not found in peak file" };
+    }
+
+    auto totalFrames { readLittleEndian<std::uint64_t>(*header, levelCount * sizeof(std::uint32_t)) };
+
+    const auto bodyPosition { file.tellg() };
+    file.seekg(0, std::ios::end);
+    const auto bodySize { static_cast<std::uint64_t>(file.tellg() - bodyPosition) };
+    file.seekg(bodyPosition);
+
+    const auto binBytes { std::size_t { channelCount } * peakSize };
+
+    // Without a frame count the recording did not complete, only the finest bins made it to the file
+    const auto isComplete { totalFrames != 0 };
+    const auto binCount { [&totalFrames] (const std::uint32_t size) { return (totalFrames + size - 1) / size; } };
+
+    if (not isComplete) {
+        totalFrames = bodySize / binBytes * fileBinSizes.front();
+    }
+
+    const auto level { isComplete ? static_cast<std::size_t>(std::ranges::distance(fileBinSizes.begin(), levelIt)) : std::size_t { 0 } };
+    std::uint64_t levelOffset { 0 };
+
+    for (std::size_t finer { 0 }; finer < level; ++finer) {
+        levelOffset += binCount(fileBinSizes[finer]) * binBytes;
+    }
+
+    const auto levelSize { binCount(fileBinSizes[level]) * binBytes };
+
+    if (levelOffset + levelSize > bodySize) {
+        return std::unexpected { "Corrupted peak file" };
+    }
+
+    file.seekg(static_cast<std::streamoff>(levelOffset), std::ios::cur);
+    const auto bytes { readBytes(file, static_cast<std::size_t>(levelSize)) };
+
+    if (not bytes.has_value()) {
+        return std::unexpected { "Failed to read peak file" };
+    }
+
+    PeakLevel peakLevel { sampleRate, channelCount, binSize, totalFrames, {} };
+    peakLevel.m_peaks.reserve(bytes->size() / peakSize);
+
+    for (std::size_t offset { 0 }; offset < bytes->size(); offset += peakSize) {
+        peakLevel.m_peaks.push_back({ std::bit_cast<float>(readLittleEndian<std::uint32_t>(*bytes, offset)),
+            std::bit_cast<float>(readLittleEndian<std::uint32_t>(*bytes, offset + sizeof(float))) });
+    }
+
+    if (fileBinSizes[level] == binSize) {
+        return peakLevel;
+    }
+
+    // Coarser bins are rebuilt from the finest ones
+    const auto ratio { binSize / fileBinSizes[level] };
+    std::vector<Peak> peaks(binCount(binSize) * channelCount, emptyPeak);
+
+    for (std::size_t bin { 0 }; bin < peakLevel.m_peaks.size() / channelCount; ++bin) {
+        for (std::size_t channel { 0 }; channel < channelCount; ++channel) {
+            auto& peak { peaks[bin / ratio * channelCount + channel] };
+            peak = merge(peak, peakLevel.m_peaks[bin * channelCount + channel]);
+        }
+    }
+
+    peakLevel.m_peaks = std::move(peaks);
+
+    return peakLevel;
+}
+
+}
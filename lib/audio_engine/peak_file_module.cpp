@@ -0,0 +1,70 @@
+export module peak_file;
+
+import std;
+
+import audio_device;
+import audio_buffer;
+
+namespace audio_engine::peak_file {
+
+// Frames per bin of every resolution, finest first. Each one is a multiple of the previous
+export constexpr std::array<std::uint32_t, 3> binSizes { 256, 4096, 65536 };
+
+export struct Peak final {
+    float m_min;
+    float m_max;
+};
+
+// Min and max of the samples. Without samples min is above max, so that merging it changes nothing
+export [[nodiscard]] auto computePeak(std::span<const float> samples) -> Peak;
+
+// One resolution of a peak file. Peaks are interleaved, bin b of channel c is at b * channelCount + c
+export struct PeakLevel final {
+    audio_device::SampleRate_t m_sampleRate;
+    audio_device::ChannelCount_t m_channelCount;
+    std::uint32_t m_binSize;
+    std::uint64_t m_totalFrames;
+    std::vector<Peak> m_peaks;
+};
+
+// Writes fileName.peaks next to a recording: min and max of every bin of every resolution, per channel.
+// Finest bins are appended as they complete, coarser ones are small enough to be kept in memory and appended on destruction,
+// along with the frame count in the header. A file that was never completed still holds the finest bins
+export class PeakWriter final {
+public:
+    PeakWriter(std::string_view fileName, audio_device::SampleRate_t sampleRate, audio_device::ChannelCount_t channelCount);
+    ~PeakWriter();
+
+    PeakWriter(const PeakWriter&) = delete;
+    PeakWriter& operator=(const PeakWriter&) = delete;
+    PeakWriter(PeakWriter&&) = delete;
+    PeakWriter& operator=(PeakWriter&&) = delete;
+
+    [[nodiscard]] auto write(const audio_buffer::ReadOnlyAudioBufferView<float>& buffer) -> bool;
+
+private:
+    // Adds the partial bin of level to the completed ones and merges it in the next level
+    auto completeBin(std::size_t level) -> void;
+    auto writePeaks(std::span<const Peak> peaks) -> void;
+    auto writeHeader() -> void;
+
+    std::ofstream m_file;
+    audio_device::SampleRate_t m_sampleRate;
+    audio_device::ChannelCount_t m_channelCount;
+    std::uint64_t m_totalFrames;
+
+    // Bin being filled of every level, one peak per channel
+    std::array<std::vector<Peak>, binSizes.size()> m_partialBins;
+    std::array<std::uint64_t, binSizes.size()> m_partialFrames;
+    // Finest bins wait here until the end of the write
+    std::array<std::vector<Peak>, binSizes.size()> m_completedBins;
+    std::vector<std::uint8_t> m_bytes;
+};
+
+export [[nodiscard]] auto makePeakWriter(std::string_view fileName, audio_device::SampleRate_t sampleRate,
+    audio_device::ChannelCount_t channelCount) -> std::expected<std::unique_ptr<PeakWriter>, std::string>;
+
+// Reads the resolution with binSize frames per bin, without reading the others
+export [[nodiscard]] auto readPeaks(std::string_view fileName, std::uint32_t binSize) -> std::expected<PeakLevel, std::string>;
+
+}
@@ -1,5 +1,6 @@
 module;
 #include <miniaudio.h>
+#include "trace_macros.h"
 export module ring_audio_buffer;
 
 import std;
@@ -7,6 +8,7 @@ import std;
 import audio_device;
 import audio_stream_params;
 import audio_buffer;
+import tracing;
 
 namespace audio_engine::ring_audio_buffer {
 
@@ -36,6 +38,8 @@ public:
 
     template <typename G> requires std::same_as<T, G>
     [[nodiscard]] auto enqueue(const audio_buffer::AudioBuffer<G>& buffer) -> bool {
+        TRACE_SPAN("audio", "RingAudioBuffer::enqueue");
+
         if (not isAudioBufferCompatible(buffer.numberOfChannels())) {
             return false;
         }
@@ -72,9 +76,12 @@ public:
         return ma_pcm_rb_commit_write(&m_rb, remainingFrames) == MA_SUCCESS;
     }
 
+    // Reads the oldest frames, at most maxFrames of them
     template <typename G> requires std::same_as<T, G>
-    [[nodiscard]] auto dequeue(audio_buffer::AudioBuffer<G>& buffer) -> bool {
-        const auto totalFramesToRead { ma_pcm_rb_available_read(&m_rb) };
+    [[nodiscard]] auto dequeue(audio_buffer::AudioBuffer<G>& buffer, const audio_stream_params::BufferLength_t maxFrames = std::numeric_limits<audio_stream_params::BufferLength_t>::max()) -> bool {
+        TRACE_SPAN("writer", "RingAudioBuffer::dequeue");
+
+        const auto totalFramesToRead { std::min(ma_pcm_rb_available_read(&m_rb), maxFrames) };
 
         buffer.resize(ma_pcm_rb_get_channels(&m_rb), totalFramesToRead);
 
@@ -104,6 +111,19 @@ public:
         return ma_pcm_rb_commit_read(&m_rb, remainingFrames) == MA_SUCCESS;
     }
 
+    // Drops the oldest frames without reading them. Like dequeue, only the consumer may call it
+    [[nodiscard]] auto discard(const audio_stream_params::BufferLength_t frames) -> bool {
+        return ma_pcm_rb_seek_read(&m_rb, std::min(ma_pcm_rb_available_read(&m_rb), frames)) == MA_SUCCESS;
+    }
+
+    [[nodiscard]] auto availableFrames() -> audio_stream_params::BufferLength_t {
+        return ma_pcm_rb_available_read(&m_rb);
+    }
+
+    [[nodiscard]] auto capacity() -> audio_stream_params::BufferLength_t {
+        return ma_pcm_rb_get_subbuffer_size(&m_rb);
+    }
+
 protected:
     [[nodiscard]] static constexpr auto getAudioFormat() -> audio_format::AudioFormat {
         if constexpr (std::is_integral_v<T>) {
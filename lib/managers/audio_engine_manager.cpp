@@ -8,9 +8,14 @@ namespace managers {
 AudioEngineManager::AudioEngineManager(ats::AsyncTaskScheduler& scheduler, const ae::audio_library_wrapper::LogCallback &logCallback)
   : TaskManager { scheduler },
     m_taskMutex {},
+    m_recordingMutex {},
     m_logCallback { logCallback },
     m_audioEngine { nullptr },
-    m_writeTaskDependency { std::nullopt } {
+    m_captureTaskDependency { std::nullopt },
+    m_writeTaskDependency { std::nullopt },
+    m_preRollTaskDependency { std::nullopt },
+    m_writeTaskCancellation {},
+    m_preRollTaskCancellation {} {
     if (auto audioEngineResult { ae::makeAudioEngine<ae::audio_library_wrapper::MiniaudioLibraryWrapper>(logCallback) }; not audioEngineResult.has_value()) {
         throw std::runtime_error { std::string { std::format("Error creating audio engine: {}",  audioEngineResult.error()) } };
     } else {
@@ -19,7 +24,15 @@ AudioEngineManager::AudioEngineManager(ats::AsyncTaskScheduler& scheduler, const
 }
 
 AudioEngineManager::~AudioEngineManager() {
-    stopRecording();
+    // Only what was started is stopped. Stopping goes through control tasks, which would wait behind one that never
+    // returns, e.g. stuck in a driver call, and the manager would never be destroyed
+    if (m_writeTaskDependency.has_value()) {
+        stopRecording();
+    }
+
+    if (m_preRollTaskDependency.has_value()) {
+        std::ignore = preRoll(std::chrono::milliseconds { 0 });
+    }
 }
 
 auto AudioEngineManager::audioDriver() -> ats::Result<std::expected<ae::audio_driver::AudioDriver, std::string>> {
@@ -29,7 +42,7 @@ auto AudioEngineManager::audioDriver() -> ats::Result<std::expected<ae::audio_dr
     }) };
 
     auto result { task->result() };
-    enqueueTasks(std::move(task));
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
     return result;
 }
@@ -41,7 +54,7 @@ auto AudioEngineManager::audioDriver(const ae::audio_driver::AudioDriver newAudi
     }) };
 
     auto result { task->result() };
-    enqueueTasks(std::move(task));
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
     return result;
 }
@@ -53,7 +66,7 @@ auto AudioEngineManager::probeDevices() -> ats::Result<std::expected<void, std::
     }) };
 
     auto result { task->result() };
-    enqueueTasks(std::move(task));
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
     return result;
 }
@@ -65,7 +78,7 @@ auto AudioEngineManager::defaultInputAudioDeviceName() -> ats::Result<std::expec
     }) };
 
     auto result { task->result() };
-    enqueueTasks(std::move(task));
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
     return result;
 }
@@ -77,7 +90,7 @@ auto AudioEngineManager::defaultOutputAudioDeviceName() -> ats::Result<std::expe
     }) };
 
     auto result { task->result() };
-    enqueueTasks(std::move(task));
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
     return result;
 }
@@ -92,49 +105,164 @@ auto AudioEngineManager::startStream(const std::optional<std::string>& inputDevi
     }) };
 
     auto result { task->result() };
-    enqueueTasks(std::move(task));
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
     return result;
 }
 
-ats::ResumableTask<void> write(std::mutex& mutex, const std::unique_ptr<ae::AudioEngine<ae::audio_library_wrapper::MiniaudioLibraryWrapper>>& audioEngine) {
-    std::unique_lock writeLock { mutex, std::defer_lock };
-    auto writeResult { false };
+// Recording runs as two stages on different executors: capture drains the ring buffers a second at a time into a bounded
+// queue, write hands the blocks to the recorders, which convert and encode them then write the files. A disk slower than
+// the stream fills the queue and holds capture back until the ring buffers overrun, which is logged rather than left unseen.
+// Capture takes the task mutex and write the recording one, so that control tasks only wait for a dequeue, not for the disk
+ats::AsyncGenerator<ae::RecordingBlock> capture(std::mutex& mutex, const std::unique_ptr<ae::AudioEngine<ae::audio_library_wrapper::MiniaudioLibraryWrapper>>& audioEngine,
+    const ae::audio_library_wrapper::LogCallback& logCallback) {
+    std::unique_lock captureLock { mutex };
+    auto reportedOverruns { audioEngine->overruns() };
+    captureLock.unlock();
 
     while (true) {
-        // This needs to be placed before the write operation otherwise the audio buffer to write
-        // is empty. Need to get some samples in the audio buffer
+        // This needs to be placed before the capture otherwise the audio buffer to write
+        // is empty. Need to get some samples in the audio buffer. A backlog, e.g. the pre-roll, is captured without waiting
+
+        captureLock.lock();
+        const auto hasBacklog { audioEngine->hasRecordingBacklog() };
+        const auto overruns { audioEngine->overruns() };
+        captureLock.unlock();
+
+        if (overruns != reportedOverruns) {
+            logCallback(std::format("Recording fell behind, {} audio buffers could not be queued", overruns - reportedOverruns));
+            reportedOverruns = overruns;
+        }
+
+        if (hasBacklog) {
+            co_await std::suspend_always {};
+        } else {
+            co_await ats::after(std::chrono::milliseconds { 500 });
+        }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds { 500 });
+        captureLock.lock();
+        auto block { audioEngine->capture() };
+        captureLock.unlock();
 
+        if (not block.has_value()) co_return;
+
+        // The writer is gone, e.g. after failing to write
+        if (not (co_yield std::move(block).value())) co_return;
+    }
+}
+
+// Writes what was captured before recording stopped, then ends with the capture
+ats::ResumableTask<void> write(std::mutex& mutex, const std::unique_ptr<ae::AudioEngine<ae::audio_library_wrapper::MiniaudioLibraryWrapper>>& audioEngine,
+    ats::AsyncStream<ae::RecordingBlock> blocks) {
+    std::unique_lock writeLock { mutex, std::defer_lock };
+    auto writeResult { false };
+
+    while (const auto block { co_await blocks.next() }) {
         writeLock.lock();
-        writeResult = audioEngine->write();
+        writeResult = audioEngine->write(*block);
         writeLock.unlock();
 
         if (not writeResult) co_return;
-        co_await std::suspend_always {};
     }
 }
 
-auto AudioEngineManager::startRecording(const ae::audio_format::AudioFormat format) -> std::expected<void, std::string> {
-    stopRecording();
+ats::ResumableTask<void> trimPreRoll(std::mutex& mutex, const std::unique_ptr<ae::AudioEngine<ae::audio_library_wrapper::MiniaudioLibraryWrapper>>& audioEngine) {
+    std::unique_lock trimLock { mutex, std::defer_lock };
+    auto trimResult { false };
 
-    auto startRecordingTask { ats::makeAtomicTask([this, format] () {
+    while (true) {
+        // Ring buffers hold 10 seconds on top of the pre-roll, trimming twice a second keeps them far from full
+        co_await ats::after(std::chrono::milliseconds { 500 });
+
+        trimLock.lock();
+        trimResult = audioEngine->trimPreRoll();
+        trimLock.unlock();
+
+        if (not trimResult) co_return;
+    }
+}
+
+auto AudioEngineManager::preRoll(const std::chrono::milliseconds length) -> std::expected<void, std::string> {
+    auto preRollTask { ats::makeAtomicTask([this, length] () {
         std::lock_guard lock { m_taskMutex };
-        return m_audioEngine->startRecording(format);
+        return m_audioEngine->preRoll(length);
+    }) };
+
+    const auto preRollResult { preRollTask->result() };
+    enqueueTasks(ats::Priority::Control, std::move(preRollTask));
+
+    if (auto taskResult { preRollResult.get() }; not taskResult.has_value()) {
+        return taskResult;
+    }
+
+    // A disabled pre-roll ends the trim task, stopped rather than left to wait for its next run
+    if (length.count() == 0) {
+        if (m_preRollTaskDependency.has_value()) {
+            m_preRollTaskCancellation.request_stop();
+            m_preRollTaskDependency->wait();
+        }
+
+        m_preRollTaskDependency.reset();
+        return {};
+    }
+
+    if (m_preRollTaskDependency.has_value()) {
+        return {};
+    }
+
+    std::unique_ptr<ats::AsyncTask> trimTask { ats::makeResumableTask<void>(trimPreRoll(m_taskMutex, m_audioEngine)) };
+    m_preRollTaskDependency = trimTask->dependency();
+    m_preRollTaskCancellation = std::stop_source {};
+    trimTask->cancellation(m_preRollTaskCancellation.get_token());
+
+    enqueueTasks(std::move(trimTask));
+
+    return {};
+}
+
+auto AudioEngineManager::preRoll() -> ats::Result<std::chrono::milliseconds> {
+    auto task { ats::makeAtomicTask([this] () {
+        std::lock_guard lock { m_taskMutex };
+        return m_audioEngine->preRoll();
+    }) };
+
+    auto result { task->result() };
+    enqueueTasks(ats::Priority::Control, std::move(task));
+
+    return result;
+}
+
+auto AudioEngineManager::startRecording(const ae::audio_format::AudioFormat format, const ae::audio_format::EncodingFormat encoding,
+    const std::chrono::milliseconds preRoll) -> std::expected<void, std::string> {
+    stopRecording();
+
+    // Encoding work, e.g. FLAC frames, is spread over the executors while the write task keeps draining the ring buffers
+    auto dispatcher { [this] (std::function<void()> encode) {
+        enqueueTasks(ats::makeAtomicTask(std::move(encode)));
+    } };
+
+    auto startRecordingTask { ats::makeAtomicTask([this, format, encoding, dispatcher, preRoll] () {
+        std::scoped_lock lock { m_taskMutex, m_recordingMutex };
+        return m_audioEngine->startRecording(format, encoding, dispatcher, preRoll);
     }) };
 
     const auto startRecordingResult { startRecordingTask->result() };
-    enqueueTasks(std::move(startRecordingTask));
+    enqueueTasks(ats::Priority::Control, std::move(startRecordingTask));
 
     if (auto taskResult { startRecordingResult.get() }; not taskResult.has_value()) {
         return taskResult;
     }
 
-    std::unique_ptr<ats::AsyncTask> writeTask { ats::makeResumableTask<void>(write(m_taskMutex, m_audioEngine)) };
+    auto captureTask { ats::makeAsyncGenerator(capture(m_taskMutex, m_audioEngine, m_logCallback)) };
+    captureTask->capacity(maxBlocksInFlight);
+    m_writeTaskCancellation = std::stop_source {};
+    captureTask->cancellation(m_writeTaskCancellation.get_token());
+    m_captureTaskDependency = captureTask->dependency();
+
+    std::unique_ptr<ats::AsyncTask> writeTask { ats::makeResumableTask<void>(write(m_recordingMutex, m_audioEngine, captureTask->stream())) };
     m_writeTaskDependency = writeTask->dependency();
 
-    enqueueTasks(std::move(writeTask));
+    enqueueTasks(std::move(captureTask), std::move(writeTask));
 
     return {};
 }
@@ -146,25 +274,86 @@ auto AudioEngineManager::stopRecording() -> void {
     }) };
 
     const auto stopRecordingTaskDependency { stopRecordingTask->dependency() };
-    enqueueTasks(std::move(stopRecordingTask));
+    enqueueTasks(ats::Priority::Control, std::move(stopRecordingTask));
 
     stopRecordingTaskDependency.wait();
 
+    // Once stopped, capture ends without waiting for its next run, and write once what was captured is written.
+    // Capture may outlive a write that failed, both are waited for as finalizing takes the recorders away from them
     if (m_writeTaskDependency.has_value()) {
+        m_writeTaskCancellation.request_stop();
+        m_captureTaskDependency->wait();
         m_writeTaskDependency->wait();
     }
 
+    m_captureTaskDependency.reset();
     m_writeTaskDependency.reset();
 
     auto finalizeRecordingTask { ats::makeAtomicTask([this] () {
-        std::lock_guard lock { m_taskMutex };
-        m_audioEngine->finalizeRecording();
+        std::lock_guard lock { m_recordingMutex };
+        return m_audioEngine->finalizeRecording();
+    }) };
+
+    const auto finalizeRecordingResult { finalizeRecordingTask->result() };
+    enqueueTasks(ats::Priority::Control, std::move(finalizeRecordingTask));
+
+    // Completing the files is the last write, e.g. the FLAC header, and can fail like the others
+    if (not finalizeRecordingResult.get()) {
+        m_logCallback("Could not complete the recording files");
+    }
+}
+
+auto AudioEngineManager::rotateRecording(std::string suffix, const std::optional<std::uint64_t> atFrame) -> ats::Result<std::expected<void, std::string>> {
+    auto task { ats::makeAtomicTask([this, fileNameSuffix = std::move(suffix), atFrame] () -> std::expected<void, std::string> {
+        std::unique_lock lock { m_taskMutex, std::defer_lock };
+        std::unique_lock recordingLock { m_recordingMutex, std::defer_lock };
+        std::lock(lock, recordingLock);
+
+        const auto settings { m_audioEngine->nextRecordingSettings(fileNameSuffix) };
+        recordingLock.unlock();
+        lock.unlock();
+
+        if (not settings.has_value()) {
+            return std::unexpected { settings.error() };
+        }
+
+        // The write task keeps going while files are opened and buffers allocated
+        auto openRecorder { [] (const std::optional<ae::audio_recorder::RecorderSettings>& recorderSettings)
+            -> std::expected<std::unique_ptr<ae::audio_recorder::AudioRecorder>, std::string> {
+            if (not recorderSettings.has_value()) {
+                return nullptr;
+            }
+
+            auto recorder { ae::audio_recorder::makeAudioRecorder(*recorderSettings) };
+
+            if (recorder.has_value()) {
+                // Capture dequeues at most a second at a time
+                recorder.value()->reserve(recorderSettings->m_sampleRate);
+            }
+
+            return recorder;
+        } };
+
+        auto inputRecorder { openRecorder(settings->m_input) };
+
+        if (not inputRecorder.has_value()) {
+            return std::unexpected { std::format("Could not create input audio recorder: {}", inputRecorder.error()) };
+        }
+
+        auto outputRecorder { openRecorder(settings->m_output) };
+
+        if (not outputRecorder.has_value()) {
+            return std::unexpected { std::format("Could not create output audio recorder: {}", outputRecorder.error()) };
+        }
+
+        recordingLock.lock();
+        return m_audioEngine->rotateRecording(std::move(inputRecorder).value(), std::move(outputRecorder).value(), atFrame);
     }) };
 
-    const auto finalizeRecordingTaskDependency { finalizeRecordingTask->dependency() };
-    enqueueTasks(std::move(finalizeRecordingTask));
+    auto result { task->result() };
+    enqueueTasks(ats::Priority::Control, std::move(task));
 
-    finalizeRecordingTaskDependency.wait();
+    return result;
 }
 
 auto AudioEngineManager::inputChannelName(std::string channelName, const ae::audio_device::ChannelCount_t channelCount) -> ats::Result<void> {
@@ -174,7 +363,7 @@ auto AudioEngineManager::inputChannelName(std::string channelName, const ae::aud
     }) };
 
     const auto inputChannelNameResult { inputNameTask->result() };
-    enqueueTasks(std::move(inputNameTask));
+    enqueueTasks(ats::Priority::Control, std::move(inputNameTask));
 
     return inputChannelNameResult;
 }
@@ -186,7 +375,7 @@ auto AudioEngineManager::inputChannelName(const ae::audio_device::ChannelCount_t
     }) };
 
     const auto inputNameResult { inputNameTask->result() };
-    enqueueTasks(std::move(inputNameTask));
+    enqueueTasks(ats::Priority::Control, std::move(inputNameTask));
 
     return inputNameResult;
 }
@@ -198,7 +387,7 @@ auto AudioEngineManager::outputChannelName(std::string channelName, const ae::au
     }) };
 
     const auto outputNameResult { outputNameTask->result() };
-    enqueueTasks(std::move(outputNameTask));
+    enqueueTasks(ats::Priority::Control, std::move(outputNameTask));
 
     return outputNameResult;
 }
@@ -210,7 +399,7 @@ auto AudioEngineManager::outputChannelName(const ae::audio_device::ChannelCount_
     }) };
 
     const auto outputNameResult { outputNameTask->result() };
-    enqueueTasks(std::move(outputNameTask));
+    enqueueTasks(ats::Priority::Control, std::move(outputNameTask));
 
     return outputNameResult;
 }
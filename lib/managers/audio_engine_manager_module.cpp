@@ -27,9 +27,20 @@ public:
     [[nodiscard]] auto startStream(const std::optional<std::string>& inputDeviceName,
         const std::optional<std::string>& outputDeviceName, ae::audio_stream_params::BufferLength_t bufferLength) -> ats::Result<std::expected<void, std::string>>;
 
-    [[nodiscard]] auto startRecording(ae::audio_format::AudioFormat format) -> std::expected<void, std::string>;
+    // Keeps the last length of audio while not recording, zero disables it. A running stream only fits the pre-roll it was started with
+    [[nodiscard]] auto preRoll(std::chrono::milliseconds length) -> std::expected<void, std::string>;
+    [[nodiscard]] auto preRoll() -> ats::Result<std::chrono::milliseconds>;
+
+    // Files start preRoll before now, up to the pre-roll being kept
+    [[nodiscard]] auto startRecording(ae::audio_format::AudioFormat format,
+        ae::audio_format::EncodingFormat encoding = ae::audio_format::EncodingFormat::Wav,
+        std::chrono::milliseconds preRoll = std::chrono::milliseconds { 0 }) -> std::expected<void, std::string>;
                   auto stopRecording() -> void;
 
+    // Continues the recording in new files, named after the mixer channels followed by suffix, without dropping any frame.
+    // Files are opened on an executor while recording goes on, writing switches at atFrame or at the next write without it
+    [[nodiscard]] auto rotateRecording(std::string suffix, std::optional<std::uint64_t> atFrame = std::nullopt) -> ats::Result<std::expected<void, std::string>>;
+
     [[nodiscard]] auto inputChannelName(std::string channelName, ae::audio_device::ChannelCount_t channelCount) -> ats::Result<void>;
     [[nodiscard]] auto inputChannelName(ae::audio_device::ChannelCount_t channelCount) -> ats::Result<std::string>;
 
@@ -51,10 +62,22 @@ public:
     [[nodiscard]] auto outputChannelRouting(ae::audio_device::ChannelCount_t channelCount) const -> ae::audio_mixer::ChannelRouting;
 
 private:
+    // Seconds of audio captured ahead of the writer, on top of what the ring buffers hold
+    static constexpr std::size_t maxBlocksInFlight { 4 };
+
+    // Devices, mixer and stream, with the ring buffers capture dequeues from
     std::mutex m_taskMutex;
+    // Recorders, held while writing, rotating and closing files so that file I/O never holds the other tasks back.
+    // Tasks that need both take them together, e.g. through a scoped lock
+    std::mutex m_recordingMutex;
     ae::audio_library_wrapper::LogCallback m_logCallback;
     std::unique_ptr<ae::AudioEngine<ae::audio_library_wrapper::MiniaudioLibraryWrapper>> m_audioEngine;
+    std::optional<ats::Dependency> m_captureTaskDependency;
     std::optional<ats::Dependency> m_writeTaskDependency;
+    std::optional<ats::Dependency> m_preRollTaskDependency;
+    // Stop the write and trim coroutines without waiting for them to notice
+    std::stop_source m_writeTaskCancellation;
+    std::stop_source m_preRollTaskCancellation;
 };
 
 export [[nodiscard]] auto makeAudioEngineManager(ats::AsyncTaskScheduler& scheduler,
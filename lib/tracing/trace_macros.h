@@ -0,0 +1,21 @@
+#pragma once
+
+// Spans recorded only when built with the ENABLE_TRACING CMake option, compiled out otherwise. Included in the global
+// module fragment of units importing tracing. Categories and names have to be string literals
+
+#if defined(ENABLE_TRACING)
+    #define TRACE_CONCATENATE_INNER(first, second) first##second
+    #define TRACE_CONCATENATE(first, second) TRACE_CONCATENATE_INNER(first, second)
+
+    // From here to the end of the scope
+    #define TRACE_SPAN(category, name) const ::tracing::TraceSpan TRACE_CONCATENATE(traceSpan, __LINE__) { category, name }
+    // Timed by the caller, for code reading the clock anyway
+    #define TRACE_COMPLETE(category, name, startedAt, finishedAt) ::tracing::record(category, name, startedAt, finishedAt)
+    // Once per thread
+    #define TRACE_THREAD_NAME(name) \
+        [[maybe_unused]] static thread_local const bool TRACE_CONCATENATE(traceThreadNamed, __LINE__) { (::tracing::nameCurrentThread(name), true) }
+#else
+    #define TRACE_SPAN(category, name)
+    #define TRACE_COMPLETE(category, name, startedAt, finishedAt)
+    #define TRACE_THREAD_NAME(name)
+#endif
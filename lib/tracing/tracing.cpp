@@ -0,0 +1,247 @@
+module tracing;
+
+namespace tracing {
+
+struct Span {
+    const char* m_category;
+    const char* m_name;
+    // Since the epoch of the steady clock
+    std::int64_t m_startedAt;
+    std::int64_t m_duration;
+};
+
+// Spans of one thread at a time, in a ring written by that thread only and read by dumps without stopping it. Each slot
+// tells which span it holds and whether it is being written, so that a span overwritten while it is read is dropped
+class ThreadSpans final {
+public:
+    ThreadSpans() :  m_name {}, m_inUse { true }, m_slots {}, m_recorded { 0 } {}
+
+    auto record(const Span& span) -> void {
+        const auto index { m_recorded.load(std::memory_order_relaxed) };
+        auto& slot { m_slots[index % spansPerThread] };
+
+        // Released by the stores of the fields, a dump reading any of them then sees the slot being written
+        slot.m_version.store(2 * index + 1, std::memory_order_relaxed);
+        slot.m_category.store(span.m_category, std::memory_order_release);
+        slot.m_name.store(span.m_name, std::memory_order_release);
+        slot.m_startedAt.store(span.m_startedAt, std::memory_order_release);
+        slot.m_duration.store(span.m_duration, std::memory_order_release);
+        slot.m_version.store(2 * index + 2, std::memory_order_release);
+
+        m_recorded.store(index + 1, std::memory_order_release);
+    }
+
+    // Oldest first, the ones overwritten while they were copied left out
+    [[nodiscard]] auto spans() const -> std::vector<Span> {
+        const auto end { m_recorded.load(std::memory_order_acquire) };
+        const auto begin { end > spansPerThread ? end - spansPerThread : 0 };
+
+        std::vector<Span> spans {};
+        spans.reserve(static_cast<std::size_t>(end - begin));
+
+        for (auto index { begin }; index < end; ++index) {
+            const auto& slot { m_slots[index % spansPerThread] };
+
+            if (slot.m_version.load(std::memory_order_acquire) != 2 * index + 2) {
+                continue;
+            }
+
+            const Span span { slot.m_category.load(std::memory_order_acquire), slot.m_name.load(std::memory_order_acquire),
+                slot.m_startedAt.load(std::memory_order_acquire), slot.m_duration.load(std::memory_order_acquire) };
+
+            if (slot.m_version.load(std::memory_order_relaxed) == 2 * index + 2) {
+                spans.push_back(span);
+            }
+        }
+
+        return spans;
+    }
+
+    // Called with the registry locked, as the members below
+    auto reuse() -> void {
+        m_recorded.store(0, std::memory_order_relaxed);
+        m_name.clear();
+        m_inUse = true;
+    }
+
+    std::string m_name;
+    // Released when its thread ends, its spans are kept until another thread takes it over
+    bool m_inUse;
+
+private:
+    struct Slot {
+        // Odd while the span of that index is written
+        std::atomic<std::uint64_t> m_version;
+        std::atomic<const char*> m_category;
+        std::atomic<const char*> m_name;
+        std::atomic<std::int64_t> m_startedAt;
+        std::atomic<std::int64_t> m_duration;
+    };
+
+    std::array<Slot, spansPerThread> m_slots;
+    std::atomic<std::uint64_t> m_recorded;
+};
+
+namespace {
+
+// Never destroyed, threads may record after main returned
+struct Registry {
+    std::mutex m_access;
+    // Thread ids of the trace are positions here
+    std::vector<std::unique_ptr<ThreadSpans>> m_threads;
+};
+
+auto registry() -> Registry& {
+    static auto* const instance { new Registry {} };
+    return *instance;
+}
+
+// Released spans are reused before new ones are made
+auto takeThreadSpans(const std::string_view name) -> ThreadSpans* {
+    auto& [access, threads] { registry() };
+    std::lock_guard lock { access };
+
+    ThreadSpans* spans { nullptr };
+
+    if (const auto released { std::ranges::find_if(threads, [] (const auto& threadSpans) { return not threadSpans->m_inUse; }) };
+        released != threads.end()) {
+        (*released)->reuse();
+        spans = released->get();
+    } else {
+        spans = threads.emplace_back(std::make_unique<ThreadSpans>()).get();
+    }
+
+    spans->m_name = name;
+    return spans;
+}
+
+struct ThreadSpansLease {
+    ~ThreadSpansLease() {
+        if (m_spans) {
+            std::lock_guard lock { registry().m_access };
+            m_spans->m_inUse = false;
+        }
+    }
+
+    ThreadSpans* m_spans;
+};
+
+// Releases the spans a thread took on its first one when the thread ends
+thread_local ThreadSpansLease threadSpansLease { nullptr };
+// Trivially destructible, so that attaching a reserved thread registers no destructor, which could allocate
+thread_local ThreadSpans* currentThreadSpans { nullptr };
+
+// Taken on the first span of the thread, the only time recording locks
+auto threadSpans() -> ThreadSpans& {
+    if (currentThreadSpans == nullptr) {
+        currentThreadSpans = takeThreadSpans({});
+        threadSpansLease.m_spans = currentThreadSpans;
+    }
+
+    return *currentThreadSpans;
+}
+
+auto nanoseconds(const std::chrono::steady_clock::duration duration) -> std::int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+auto escaped(const std::string_view text) -> std::string {
+    std::string escapedText {};
+
+    for (const auto character: text) {
+        if (character == '"' or character == '\\') {
+            escapedText.push_back('\\');
+            escapedText.push_back(character);
+        } else if (static_cast<unsigned char>(character) < 0x20) {
+            escapedText.append(std::format("\\u{:04x}", static_cast<unsigned int>(character)));
+        } else {
+            escapedText.push_back(character);
+        }
+    }
+
+    return escapedText;
+}
+
+// Chrome trace times are in microseconds
+auto microseconds(const std::int64_t nanoseconds) -> std::string {
+    return std::format("{}.{:03}", nanoseconds / 1000, std::abs(nanoseconds % 1000));
+}
+
+}
+
+auto record(const char* category, const char* name, const std::chrono::steady_clock::time_point startedAt,
+        const std::chrono::steady_clock::time_point finishedAt) -> void {
+    threadSpans().record(Span { category, name, nanoseconds(startedAt.time_since_epoch()), nanoseconds(finishedAt - startedAt) });
+}
+
+ReservedThread::ReservedThread(const std::string_view name) :  m_spans { takeThreadSpans(name) } {}
+
+ReservedThread::~ReservedThread() {
+    std::lock_guard lock { registry().m_access };
+    m_spans->m_inUse = false;
+}
+
+auto ReservedThread::attach() const noexcept -> void {
+    currentThreadSpans = m_spans;
+}
+
+auto nameCurrentThread(const std::string_view name) -> void {
+    auto& spans { threadSpans() };
+
+    std::lock_guard lock { registry().m_access };
+    spans.m_name = name;
+}
+
+auto writeChromeTrace(std::ostream& stream) -> void {
+    std::vector<std::pair<std::string, std::vector<Span>>> threads {};
+
+    // Copied first, so that threads starting meanwhile are not kept waiting for the writing
+    {
+        auto& [access, registeredThreads] { registry() };
+        std::lock_guard lock { access };
+
+        for (const auto& spans: registeredThreads) {
+            threads.emplace_back(spans->m_name, spans->spans());
+        }
+    }
+
+    std::print(stream, R"({{"displayTimeUnit":"ns","traceEvents":[)");
+    auto separator { "" };
+
+    for (std::size_t i { 0 }; i < threads.size(); ++i) {
+        const auto& [name, spans] { threads[i] };
+        const auto threadId { i + 1 };
+
+        if (not name.empty()) {
+            std::print(stream, R"({}{{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", separator, threadId, escaped(name));
+            separator = ",";
+        }
+
+        for (const auto& span: spans) {
+            std::print(stream, R"({}{{"name":"{}","cat":"{}","ph":"X","pid":1,"tid":{},"ts":{},"dur":{}}})", separator, escaped(span.m_name),
+                escaped(span.m_category), threadId, microseconds(span.m_startedAt), microseconds(span.m_duration));
+            separator = ",";
+        }
+    }
+
+    std::println(stream, "]}}");
+}
+
+auto dumpChromeTrace(const std::filesystem::path& path) -> std::expected<void, std::string> {
+    std::ofstream file { path };
+
+    if (not file.is_open()) {
+        return std::unexpected { std::format("Cannot open {}", path.string()) };
+    }
+
+    writeChromeTrace(file);
+    file.flush();
+
+    if (not file) {
+        return std::unexpected { std::format("Cannot write {}", path.string()) };
+    }
+
+    return {};
+}
+
+}
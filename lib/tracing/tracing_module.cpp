@@ -0,0 +1,72 @@
+export module tracing;
+
+import std;
+
+namespace tracing {
+
+// Whether the TRACE_ macros record anything, set by the ENABLE_TRACING CMake option
+#if defined(ENABLE_TRACING)
+export constexpr bool enabled { true };
+#else
+export constexpr bool enabled { false };
+#endif
+
+// Spans are kept by the thread recording them in a ring of this many, the oldest being overwritten
+export constexpr std::size_t spansPerThread { 16384 };
+
+// Records a span on the calling thread, without locking nor allocating once the thread recorded its first one or attached
+// a reserved thread. Category and name are not copied, they have to be string literals
+export auto record(const char* category, const char* name, std::chrono::steady_clock::time_point startedAt,
+    std::chrono::steady_clock::time_point finishedAt) -> void;
+
+// Shown along with the spans of the calling thread
+export auto nameCurrentThread(std::string_view name) -> void;
+
+// Spans of every thread so far, the ones of threads that ended included, as Chrome trace JSON opened by
+// chrome://tracing and ui.perfetto.dev. Any thread can dump them while others record
+export auto writeChromeTrace(std::ostream& stream) -> void;
+export [[nodiscard]] auto dumpChromeTrace(const std::filesystem::path& path) -> std::expected<void, std::string>;
+
+class ThreadSpans;
+
+// Spans of a thread that must neither lock nor allocate, as the one of the audio callback, taken and named ahead by
+// another thread. They are released along with the reservation, once the thread is done recording
+export class ReservedThread final {
+public:
+    explicit ReservedThread(std::string_view name);
+    ~ReservedThread();
+
+    ReservedThread(const ReservedThread&) = delete;
+    ReservedThread& operator=(const ReservedThread&) = delete;
+    ReservedThread(ReservedThread&&) = delete;
+    ReservedThread& operator=(ReservedThread&&) = delete;
+
+    // On the thread, before its spans, each time it may be another one. Neither locks nor allocates
+    auto attach() const noexcept -> void;
+
+private:
+    ThreadSpans* m_spans;
+};
+
+// From its construction to the end of the scope
+export class TraceSpan final {
+public:
+    TraceSpan(const char* category, const char* name) noexcept
+     :  m_category { category },
+        m_name { name },
+        m_startedAt { std::chrono::steady_clock::now() } {}
+
+    ~TraceSpan() { record(m_category, m_name, m_startedAt, std::chrono::steady_clock::now()); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+    TraceSpan(TraceSpan&&) = delete;
+    TraceSpan& operator=(TraceSpan&&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    std::chrono::steady_clock::time_point m_startedAt;
+};
+
+}
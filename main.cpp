@@ -10,11 +10,14 @@ import audio_engine_manager;
 
 import async_task_scheduler;
 import task_manager;
+
+import tracing;
+
 using namespace async_task_scheduler;
 
 auto main() -> int {
     std::unique_ptr<AsyncTaskScheduler> asyncTaskScheduler { nullptr };
-    if (auto asyncTaskSchedulerResult { makeAsyncTaskScheduler(4) }; not asyncTaskSchedulerResult.has_value()) {
+    if (auto asyncTaskSchedulerResult { makeAsyncTaskScheduler(4, 1) }; not asyncTaskSchedulerResult.has_value()) {
         std::println("Cannot create async task scheduler: {}", asyncTaskSchedulerResult.error());
         return 1;
     } else {
@@ -31,12 +34,21 @@ auto main() -> int {
     }
 
     auto probeDevicesResult { audioEngineManager->probeDevices() };
-    if (auto result { probeDevicesResult.get() }; not result.has_value()) {
-        std::println("Cannot probe devices: {}", result.error());
+    if (auto result { probeDevicesResult.getFor(std::chrono::seconds { 10 }) }; not result.has_value()) {
+        // A driver call can not be interrupted. The scheduler is shut down first, waiting for the call to return while the
+        // manager it runs on is still there. Nothing was started, so the manager then goes without enqueuing anything
+        std::println("Cannot probe devices: no answer from the audio driver");
+        asyncTaskScheduler.reset();
+        return 1;
+    } else if (not result->has_value()) {
+        std::println("Cannot probe devices: {}", result->error());
         return 1;
     }
 
+    // Both requested before waiting for either, so that they overlap
     auto inputDeviceNameResult { audioEngineManager->defaultInputAudioDeviceName() };
+    auto outputDeviceNameResult { audioEngineManager->defaultOutputAudioDeviceName() };
+    whenAll(inputDeviceNameResult, outputDeviceNameResult).wait();
 
     std::string inputDeviceName { "" };
     if (auto result { inputDeviceNameResult.get() }; not result.has_value()) {
@@ -46,8 +58,6 @@ auto main() -> int {
         inputDeviceName.swap(result.value());
     }
 
-    auto outputDeviceNameResult { audioEngineManager->defaultOutputAudioDeviceName() };
-
     std::string outputDeviceName { "" };
     if (auto result { outputDeviceNameResult.get() }; not result.has_value()) {
         std::println("Cannot get default output device name: {}", result.error());
@@ -82,4 +92,19 @@ auto main() -> int {
     audioEngineManager->stopRecording();
 
     std::println("Written to file");
+
+    // Built with ENABLE_TRACING, the timeline of the audio callback, the writers and the executors
+    if constexpr (tracing::enabled) {
+        if (const auto dumpResult { tracing::dumpChromeTrace("muesli-radio-trace.json") }; not dumpResult.has_value()) {
+            std::println("Cannot write trace: {}", dumpResult.error());
+        } else {
+            std::println("Trace written to muesli-radio-trace.json");
+        }
+    }
+
+    // Tells whether the executors are saturated or idle
+    for (const auto& statistics: asyncTaskScheduler->statistics()) {
+        std::println("{}: {} tasks, {:.1f}% busy, queue latency p99 {}, run time p99 {}", statistics.m_name, statistics.m_tasksRun,
+            statistics.utilization() * 100.0, statistics.m_queueLatency.percentile(99.0), statistics.m_runTime.percentile(99.0));
+    }
 }
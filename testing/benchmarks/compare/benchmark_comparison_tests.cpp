@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import benchmark_comparison;
+
+using namespace benchmark_comparison;
+
+namespace {
+
+// As written by --benchmark_repetitions=3 --benchmark_out_format=json, context shortened
+constexpr std::string_view benchmarkOutput { R"({
+  "context": {
+    "date": "2026-10-19T10:00:00+02:00",
+    "host_name": "muesli",
+    "caches": [ { "type": "Data", "level": 1, "size": 49152, "num_sharing": 2 } ],
+    "library_build_type": "release"
+  },
+  "benchmarks": [
+    { "name": "BM_RingAudioBuffer/1/256", "family_index": 0, "run_name": "BM_RingAudioBuffer/1/256", "run_type": "iteration",
+      "repetitions": 3, "repetition_index": 0, "iterations": 1000, "real_time": 1.5, "cpu_time": 1.5, "time_unit": "us",
+      "ns/frame": NaN },
+    { "name": "BM_RingAudioBuffer/1/256", "family_index": 0, "run_name": "BM_RingAudioBuffer/1/256", "run_type": "iteration",
+      "repetitions": 3, "repetition_index": 1, "iterations": 1000, "real_time": 1.25e0, "cpu_time": 1.25, "time_unit": "us" },
+    { "name": "BM_RingAudioBuffer/1/256", "family_index": 0, "run_name": "BM_RingAudioBuffer/1/256", "run_type": "iteration",
+      "repetitions": 3, "repetition_index": 2, "iterations": 1000, "real_time": 2, "cpu_time": 2, "time_unit": "us" },
+    { "name": "BM_RingAudioBuffer/1/256_mean", "family_index": 0, "run_name": "BM_RingAudioBuffer/1/256", "run_type": "aggregate",
+      "repetitions": 3, "aggregate_name": "mean", "iterations": 3, "real_time": 1.58, "cpu_time": 1.58, "time_unit": "us" },
+    { "name": "BM_AudioWriter<\"wav\">", "run_name": "BM_AudioWriter<\"wav\">", "run_type": "iteration", "real_time": 3,
+      "time_unit": "ms", "label": "café" },
+    { "name": "BM_Skipped", "run_name": "BM_Skipped", "run_type": "iteration", "error_occurred": true,
+      "error_message": "No device" }
+  ]
+})" };
+
+}
+
+TEST(BenchmarkComparison, parseBenchmarkRuns) {
+    const auto runs { parseBenchmarkRuns(benchmarkOutput) };
+
+    ASSERT_TRUE(runs.has_value());
+    EXPECT_EQ(*runs, (BenchmarkRuns {
+        { "BM_AudioWriter<\"wav\">", { 3e6 } },
+        { "BM_RingAudioBuffer/1/256", { 1500.0, 1250.0, 2000.0 } }
+    }));
+
+    EXPECT_EQ(parseBenchmarkRuns(R"({ "benchmarks": [] })"), BenchmarkRuns {});
+    EXPECT_EQ(parseBenchmarkRuns(R"({ "benchmarks": [ { "name": "BM_A", "real_time": 1 } ] })").error(),
+        "Invalid benchmark output: Benchmark BM_A has no name, real time or known time unit");
+    EXPECT_FALSE(parseBenchmarkRuns(R"({ "benchmarks": [ )").has_value());
+    EXPECT_FALSE(parseBenchmarkRuns(R"({ "benchmarks": [] } })").has_value());
+    EXPECT_FALSE(parseBenchmarkRuns(R"({ "benchmarks": [ { "name": "BM_A", "real_time": 1x } ] })").has_value());
+}
+
+TEST(BenchmarkComparison, median) {
+    EXPECT_EQ(median({ 3.0, 1.0, 2.0 }), 2.0);
+    EXPECT_EQ(median({ 4.0, 1.0, 3.0, 2.0 }), 2.5);
+    EXPECT_TRUE(std::isnan(median({})));
+}
+
+TEST(BenchmarkComparison, mannWhitneyPValue) {
+    const std::vector<double> baseline { 10.0, 11.0, 12.0, 13.0, 14.0 };
+
+    // Every contender time above the baseline ones: 1 of the 252 orderings
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue(baseline, std::vector { 15.0, 16.0, 17.0, 18.0, 19.0 }), 1.0 / 252.0);
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue(baseline, std::vector { 5.0, 6.0, 7.0, 8.0, 9.0 }), 1.0);
+    // U of 1 or more, all orderings but the one where every contender time is below
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue(baseline, std::vector { 5.0, 6.0, 7.0, 8.0, 10.5 }), 251.0 / 252.0);
+    // Three repetitions can not tell
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue(std::vector { 1.0, 2.0, 3.0 }, std::vector { 4.0, 5.0, 6.0 }), 1.0 / 20.0);
+    EXPECT_EQ(mannWhitneyPValue({}, baseline), 1.0);
+
+    // Normal approximation
+    std::vector<double> many {};
+    std::vector<double> manySlower {};
+
+    for (int i { 0 }; i < 30; ++i) {
+        many.push_back(100.0 + i);
+        manySlower.push_back(110.0 + i);
+    }
+
+    EXPECT_LT(mannWhitneyPValue(many, manySlower), 0.01);
+    EXPECT_GT(mannWhitneyPValue(manySlower, many), 0.99);
+    EXPECT_NEAR(mannWhitneyPValue(many, many), 0.5, 0.01);
+    EXPECT_EQ(mannWhitneyPValue(std::vector<double>(30, 1.0), std::vector<double>(30, 1.0)), 1.0);
+}
+
+TEST(BenchmarkComparison, compare) {
+    const BenchmarkRuns baseline {
+        { "BM_Faster", { 100.0, 101.0, 102.0, 103.0, 104.0 } },
+        { "BM_Noisy", { 100.0, 150.0, 90.0, 200.0, 95.0 } },
+        { "BM_Only", { 100.0 } },
+        { "BM_Slower", { 100.0, 101.0, 102.0, 103.0, 104.0 } },
+        { "BM_SlightlySlower", { 100.0, 101.0, 102.0, 103.0, 104.0 } }
+    };
+    const BenchmarkRuns contender {
+        { "BM_Faster", { 80.0, 81.0, 82.0, 83.0, 84.0 } },
+        { "BM_Noisy", { 190.0, 92.0, 160.0, 98.0, 140.0 } },
+        { "BM_Slower", { 120.0, 121.0, 122.0, 123.0, 124.0 } },
+        { "BM_SlightlySlower", { 104.5, 105.0, 105.5, 106.0, 106.5 } }
+    };
+
+    const auto comparisons { compare(baseline, contender, ComparisonSettings { 0.1, 0.05 }) };
+
+    ASSERT_EQ(comparisons.size(), 4u);
+
+    EXPECT_EQ(comparisons[0].m_name, "BM_Faster");
+    EXPECT_DOUBLE_EQ(comparisons[0].m_change, 82.0 / 102.0 - 1.0);
+    EXPECT_FALSE(comparisons[0].m_regressed);
+
+    // Slower median, but not significantly
+    EXPECT_EQ(comparisons[1].m_name, "BM_Noisy");
+    EXPECT_GT(comparisons[1].m_change, 0.1);
+    EXPECT_GT(comparisons[1].m_pValue, 0.05);
+    EXPECT_FALSE(comparisons[1].m_regressed);
+
+    // Significantly, but below the threshold
+    EXPECT_EQ(comparisons[2].m_name, "BM_SlightlySlower");
+    EXPECT_LT(comparisons[2].m_pValue, 0.05);
+    EXPECT_FALSE(comparisons[2].m_regressed);
+
+    EXPECT_EQ(comparisons[3].m_name, "BM_Slower");
+    EXPECT_DOUBLE_EQ(comparisons[3].m_baselineMedian, 102.0);
+    EXPECT_DOUBLE_EQ(comparisons[3].m_contenderMedian, 122.0);
+    EXPECT_DOUBLE_EQ(comparisons[3].m_pValue, 1.0 / 252.0);
+    EXPECT_TRUE(comparisons[3].m_regressed);
+}
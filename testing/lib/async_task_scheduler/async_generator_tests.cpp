@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+AsyncGenerator<int> count(const int to, std::atomic<int>& yielded) {
+    for (int i { 0 }; i < to; ++i) {
+        if (not (co_yield i)) {
+            co_return;
+        }
+
+        yielded.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+AsyncGenerator<int> square(AsyncStream<int> input) {
+    while (const auto value { co_await input.next() }) {
+        if (not (co_yield *value * *value)) {
+            co_return;
+        }
+    }
+}
+
+AsyncGenerator<int> failAfter(const int to) {
+    for (int i { 0 }; i < to; ++i) {
+        co_yield i;
+    }
+
+    throw std::runtime_error { "Failed" };
+}
+
+ResumableTask<std::vector<int>> collect(AsyncStream<int> input, const std::chrono::milliseconds pause = std::chrono::milliseconds { 0 }) {
+    std::vector<int> values {};
+
+    while (const auto value { co_await input.next() }) {
+        values.push_back(*value);
+
+        if (pause.count() != 0) {
+            std::this_thread::sleep_for(pause);
+        }
+    }
+
+    co_return values;
+}
+
+ResumableTask<int> takeFirst(AsyncStream<int> input) {
+    co_return *(co_await input.next());
+}
+
+TEST(AsyncGenerator, pipeline) {
+    auto scheduler { makeAsyncTaskScheduler(3).value() };
+    std::atomic yielded { 0 };
+
+    auto source { makeAsyncGenerator(count(100, yielded)) };
+    auto squares { makeAsyncGenerator(square(source->stream())) };
+    auto sink { makeResumableTask(collect(squares->stream())) };
+
+    const auto sourceResult { source->result() };
+    const auto sinkResult { sink->result() };
+
+    scheduler->enqueueTask(std::move(sink), 2);
+    scheduler->enqueueTask(std::move(squares), 1);
+    scheduler->enqueueTask(std::move(source), 0);
+
+    const auto values { sinkResult.get() };
+
+    ASSERT_EQ(values.size(), 100);
+
+    for (int i { 0 }; i < 100; ++i) {
+        EXPECT_EQ(values[static_cast<std::size_t>(i)], i * i);
+    }
+
+    sourceResult.get();
+    EXPECT_EQ(yielded.load(), 100);
+}
+
+TEST(AsyncGenerator, backpressure) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+    std::atomic yielded { 0 };
+
+    auto source { makeAsyncGenerator(count(20, yielded)) };
+    source->capacity(4);
+    auto sink { makeResumableTask(collect(source->stream(), std::chrono::milliseconds { 20 })) };
+    const auto sinkResult { sink->result() };
+
+    scheduler->enqueueTask(std::move(source), 0);
+
+    // Nobody reads yet, the generator waits with the queue full and one value left to queue
+    std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+    EXPECT_EQ(yielded.load(), 4);
+
+    scheduler->enqueueTask(std::move(sink), 1);
+
+    EXPECT_EQ(sinkResult.get().size(), 20);
+    EXPECT_EQ(yielded.load(), 20);
+}
+
+TEST(AsyncGenerator, exception) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    auto source { makeAsyncGenerator(failAfter(3)) };
+    const auto sourceResult { source->result() };
+    auto sink { makeResumableTask(collect(source->stream())) };
+    const auto sinkResult { sink->result() };
+
+    scheduler->enqueueTask(std::move(sink), 1);
+    scheduler->enqueueTask(std::move(source), 0);
+
+    EXPECT_THROW(std::ignore = sinkResult.get(), std::runtime_error);
+    EXPECT_THROW(sourceResult.get(), std::runtime_error);
+}
+
+TEST(AsyncGenerator, readerGone) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+    std::atomic yielded { 0 };
+
+    auto source { makeAsyncGenerator(count(std::numeric_limits<int>::max(), yielded)) };
+    const auto sourceResult { source->result() };
+    auto sink { makeResumableTask(takeFirst(source->stream())) };
+    const auto sinkResult { sink->result() };
+
+    scheduler->enqueueTask(std::move(sink), 1);
+    scheduler->enqueueTask(std::move(source), 0);
+
+    EXPECT_EQ(sinkResult.get(), 0);
+
+    // The reader is gone, the next yield ends the generator
+    sourceResult.get();
+    EXPECT_LT(yielded.load(), std::numeric_limits<int>::max());
+
+    // Nobody ever read
+    auto unread { makeAsyncGenerator(count(10, yielded)) };
+    const auto unreadResult { unread->result() };
+    yielded.store(0);
+
+    scheduler->enqueueTask(std::move(unread));
+
+    unreadResult.get();
+    EXPECT_EQ(yielded.load(), 0);
+}
+
+TEST(AsyncGenerator, stop) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+    std::atomic yielded { 0 };
+
+    std::stop_source stopSource {};
+    auto source { makeAsyncGenerator(count(10, yielded)) };
+    source->cancellation(stopSource.get_token());
+    const auto sourceResult { source->result() };
+    auto sink { makeResumableTask(collect(source->stream())) };
+    const auto sinkResult { sink->result() };
+
+    stopSource.request_stop();
+
+    scheduler->enqueueTask(std::move(sink), 1);
+    scheduler->enqueueTask(std::move(source), 0);
+
+    try {
+        sourceResult.get();
+        ADD_FAILURE() << "Stopped generator did not throw";
+    } catch (const std::system_error& error) {
+        EXPECT_EQ(error.code(), std::errc::operation_canceled);
+    }
+
+    // The reader learns why the stream ended
+    try {
+        std::ignore = sinkResult.get();
+        ADD_FAILURE() << "Stream of a stopped generator did not throw";
+    } catch (const std::system_error& error) {
+        EXPECT_EQ(error.code(), std::errc::operation_canceled);
+    }
+
+    EXPECT_EQ(yielded.load(), 0);
+}
@@ -56,4 +56,312 @@ TEST(AsyncTaskScheduler, executeTasks) {
         else
             ASSERT_EQ(taskCompletion, false);
     }
-}
\ No newline at end of file
+}
+
+TEST(AsyncTaskScheduler, stealTasks) {
+    auto scheduler { makeAsyncTaskScheduler(2) };
+
+    std::atomic_bool release { false };
+
+    // Keeps the first executor busy, tasks queued behind it are run by the other one
+    auto blockingTask { makeAtomicTask([&release] () { while (not release.load()) { std::this_thread::yield(); } }) };
+    const auto blockingDependency { blockingTask->dependency() };
+    scheduler.value()->enqueueTask(std::move(blockingTask), 0);
+
+    std::vector<Dependency> dependencies {};
+
+    for (unsigned int i { 0 }; i < numberOfTasks; ++i) {
+        auto task { makeAtomicTask([] () {}) };
+        dependencies.emplace_back(task->dependency());
+        scheduler.value()->enqueueTask(std::move(task), 0);
+    }
+
+    for (auto& dependency: dependencies) {
+        EXPECT_TRUE(dependency.waitFor(std::chrono::seconds { 10 }));
+    }
+
+    release.store(true);
+    blockingDependency.wait();
+}
+
+class CountingTask final : public AsyncTask {
+public:
+    explicit CountingTask(std::atomic<unsigned int>& runs) :  m_runs { runs }, m_done { false } {}
+
+    auto operator()() -> void override {
+        ++m_runs;
+
+        if (areDependenciesMet()) {
+            m_done = true;
+            signalCompletion();
+        }
+    }
+
+    [[nodiscard]] auto done() const -> bool override { return m_done; }
+
+private:
+    std::atomic<unsigned int>& m_runs;
+    bool m_done;
+};
+
+TEST(AsyncTaskScheduler, waitForDependencies) {
+    auto scheduler { makeAsyncTaskScheduler(2) };
+
+    std::atomic<unsigned int> runs { 0 };
+
+    auto firstTask { makeAtomicTask([] () { std::this_thread::sleep_for(std::chrono::milliseconds { 100 }); }) };
+    auto secondTask { makeAtomicTask([] () {}) };
+    auto waitingTask { std::make_unique<CountingTask>(runs) };
+
+    waitingTask->dependency(*firstTask);
+    waitingTask->dependency(*secondTask);
+    const auto dependency { waitingTask->dependency() };
+
+    // Set aside until both dependencies complete instead of being run again and again
+    scheduler.value()->enqueueTask(std::move(waitingTask), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+    scheduler.value()->enqueueTask(std::move(firstTask), 1);
+    scheduler.value()->enqueueTask(std::move(secondTask), 1);
+
+    EXPECT_TRUE(dependency.waitFor(std::chrono::seconds { 10 }));
+    EXPECT_EQ(runs.load(), 1u);
+}
+
+TEST(AsyncTaskScheduler, destroyedWithWaitingTasks) {
+    std::atomic<unsigned int> runs { 0 };
+    auto delayedTask { makeAtomicTask([] () { return 1; }) };
+    auto queuedTask { makeAtomicTask([] () { std::this_thread::sleep_for(std::chrono::milliseconds { 10 }); }) };
+    auto waitingTask { std::make_unique<CountingTask>(runs) };
+
+    waitingTask->dependency(*delayedTask);
+    waitingTask->dependency(*queuedTask);
+
+    const auto delayedResult { delayedTask->result() };
+    const auto waiting { waitingTask->dependency() };
+    const auto all { whenAll(delayedResult) };
+
+    {
+        auto scheduler { makeAsyncTaskScheduler(1) };
+
+        scheduler.value()->enqueueTask(std::move(waitingTask));
+        scheduler.value()->enqueueAfter(std::move(delayedTask), std::chrono::hours { 1 });
+
+        for (int i { 0 }; i < 10; ++i) {
+            scheduler.value()->enqueueTask(makeAtomicTask([] () { std::this_thread::sleep_for(std::chrono::milliseconds { 10 }); }));
+        }
+
+        scheduler.value()->enqueueTask(std::move(queuedTask));
+    }
+
+    // Tasks never run release whoever waits for them, tasks waiting for them are stopped
+    EXPECT_TRUE(waiting.waitFor(std::chrono::milliseconds { 0 }));
+    EXPECT_TRUE(waiting.cancelled());
+    EXPECT_EQ(runs.load(), 0u);
+    EXPECT_THROW(std::ignore = delayedResult.get(), std::future_error);
+    EXPECT_TRUE(all.ready());
+}
+
+TEST(AsyncTaskScheduler, enqueueAfter) {
+    auto scheduler { makeAsyncTaskScheduler(1) };
+
+    const auto start { std::chrono::steady_clock::now() };
+    auto task { makeAtomicTask([] () { return std::chrono::steady_clock::now(); }) };
+    const auto taskResult { task->result() };
+
+    scheduler.value()->enqueueAfter(std::move(task), std::chrono::milliseconds { 50 });
+    EXPECT_GE(taskResult.get() - start, std::chrono::milliseconds { 50 });
+
+    auto cancelledTask { makeAtomicTask([] () {}) };
+    const auto cancelledTaskDependency { cancelledTask->dependency() };
+    const auto timerId { scheduler.value()->enqueueAfter(std::move(cancelledTask), std::chrono::milliseconds { 50 }) };
+
+    // Destroyed without running, which completes its dependencies
+    EXPECT_TRUE(scheduler.value()->cancelTimer(timerId));
+    EXPECT_TRUE(cancelledTaskDependency.waitFor(std::chrono::milliseconds { 0 }));
+}
+
+TEST(AsyncTaskScheduler, enqueueEvery) {
+    auto scheduler { makeAsyncTaskScheduler(2) };
+    std::atomic<unsigned int> runs { 0 };
+    std::atomic<unsigned int> concurrentRuns { 0 };
+    std::atomic<unsigned int> maxConcurrentRuns { 0 };
+
+    // Slower than its period
+    const auto timerId { scheduler.value()->enqueueEvery([&] () {
+        maxConcurrentRuns = std::max(maxConcurrentRuns.load(), ++concurrentRuns);
+        std::this_thread::sleep_for(std::chrono::milliseconds { 15 });
+        --concurrentRuns;
+        ++runs;
+    }, std::chrono::milliseconds { 5 }) };
+
+    while (runs < 5) {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+    }
+
+    EXPECT_TRUE(scheduler.value()->cancelTimer(timerId));
+    EXPECT_EQ(maxConcurrentRuns.load(), 1u);
+}
+
+TEST(AsyncTaskScheduler, reservedControlExecutors) {
+    auto scheduler { makeAsyncTaskScheduler(1, 1) };
+    EXPECT_EQ(scheduler.value()->concurrencyLevel(), 1u);
+
+    auto controlTask { makeAtomicTask([] () {}) };
+    controlTask->priority(Priority::Control);
+    const auto controlTaskDependency { controlTask->dependency() };
+
+    // Holds the only executor background tasks run on until the control task is done
+    auto backgroundTask { makeAtomicTask([controlTaskDependency] () { return controlTaskDependency.waitFor(std::chrono::seconds { 5 }); }) };
+    const auto backgroundTaskResult { backgroundTask->result() };
+
+    scheduler.value()->enqueueTask(std::move(backgroundTask));
+    scheduler.value()->enqueueTask(std::move(controlTask));
+
+    EXPECT_TRUE(backgroundTaskResult.get());
+}
+
+TEST(AsyncTaskScheduler, threadConfigurations) {
+    const ThreadConfiguration named { "writer", {}, std::nullopt, std::nullopt, std::nullopt, {} };
+
+    EXPECT_TRUE(makeAsyncTaskScheduler(2, 1, { named, named }).has_value());
+    EXPECT_EQ(makeAsyncTaskScheduler(1, 0, { named, named }).error(), "More thread configurations than executors");
+
+    // The reserved executor cannot apply its configuration
+    const ThreadConfiguration outOfRange { {}, { 1 << 20 }, std::nullopt, std::nullopt, std::nullopt, {} };
+    EXPECT_FALSE(makeAsyncTaskScheduler(1, 1, { named, outOfRange }).has_value());
+}
+
+TEST(AsyncTaskScheduler, enqueueTasks) {
+    auto scheduler { makeAsyncTaskScheduler(numberOfThreads, 1) };
+
+    std::mutex threadAccess {};
+    std::set<std::thread::id> threads {};
+    std::vector<std::unique_ptr<AsyncTask>> tasks {};
+    std::vector<Dependency> dependencies {};
+
+    // Enough to keep every executor busy once spread over them
+    for (unsigned int i { 0 }; i < numberOfThreads * numberOfTasks; ++i) {
+        auto task { makeAtomicTask([&threadAccess, &threads] () {
+            std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+
+            std::lock_guard lock { threadAccess };
+            threads.insert(std::this_thread::get_id());
+        }) };
+
+        // Control tasks go to the reserved executor
+        if (i == 0) {
+            task->priority(Priority::Control);
+        }
+
+        dependencies.emplace_back(task->dependency());
+        tasks.emplace_back(std::move(task));
+    }
+
+    scheduler.value()->enqueueTasks(std::move(tasks), 2);
+
+    for (auto& dependency: dependencies) {
+        dependency.wait();
+    }
+
+    EXPECT_GT(threads.size(), 1u);
+}
+
+TEST(AsyncTaskScheduler, statistics) {
+    auto scheduler { makeAsyncTaskScheduler(2, 1) };
+
+    std::vector<Dependency> dependencies {};
+
+    for (unsigned int i { 0 }; i < numberOfTasks; ++i) {
+        auto task { makeAtomicTask([] () { std::this_thread::sleep_for(std::chrono::milliseconds { 1 }); }) };
+        dependencies.emplace_back(task->dependency());
+        scheduler.value()->enqueueTask(std::move(task), i % 2);
+    }
+
+    for (auto& dependency: dependencies) {
+        dependency.wait();
+    }
+
+    // Runs are recorded once the task completed
+    const auto tasksRun = [&scheduler] () {
+        return std::ranges::fold_left(scheduler.value()->statistics(), std::uint64_t { 0 },
+            [] (const std::uint64_t count, const ExecutorStatistics& statistics) { return count + statistics.m_tasksRun; });
+    };
+
+    const auto deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 1 } };
+
+    while (tasksRun() < numberOfTasks and std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+
+    const auto statistics { scheduler.value()->statistics() };
+    ASSERT_EQ(statistics.size(), 3u);
+    EXPECT_EQ(tasksRun(), numberOfTasks);
+    EXPECT_EQ(statistics[0].m_name, "ats-executor-0");
+    EXPECT_EQ(statistics[2].m_lowestPriority, Priority::Control);
+
+    for (const auto& executorStatistics: statistics) {
+        EXPECT_EQ(executorStatistics.m_queueDepth, 0u);
+        EXPECT_EQ(executorStatistics.m_runTime.count(), executorStatistics.m_tasksRun);
+        EXPECT_EQ(executorStatistics.m_queueLatency.count(), executorStatistics.m_tasksRun);
+
+        if (executorStatistics.m_tasksRun > 0) {
+            EXPECT_GE(executorStatistics.m_busyTime, std::chrono::milliseconds { executorStatistics.m_tasksRun });
+            EXPECT_GE(executorStatistics.m_runTime.percentile(50.0), std::chrono::milliseconds { 1 });
+        }
+    }
+}
+
+TEST(AsyncTaskScheduler, traceTasks) {
+    auto scheduler { makeAsyncTaskScheduler(2) };
+
+    std::mutex traceAccess {};
+    std::vector<TaskTrace> traces {};
+
+    scheduler.value()->traceTasks([&traceAccess, &traces] (const TaskTrace& trace) {
+        std::lock_guard lock { traceAccess };
+        traces.push_back(trace);
+    });
+
+    const auto traceCount = [&traceAccess, &traces] () {
+        std::lock_guard lock { traceAccess };
+        return traces.size();
+    };
+
+    const auto runTasks = [&scheduler, &traceCount] (const std::size_t expectedTraces) {
+        std::vector<Dependency> dependencies {};
+
+        for (unsigned int i { 0 }; i < numberOfTasks; ++i) {
+            auto task { makeAtomicTask([] () {}) };
+            dependencies.emplace_back(task->dependency());
+            scheduler.value()->enqueueTask(std::move(task), i % 2);
+        }
+
+        for (auto& dependency: dependencies) {
+            dependency.wait();
+        }
+
+        const auto deadline { std::chrono::steady_clock::now() + std::chrono::seconds { 1 } };
+
+        while (traceCount() < expectedTraces and std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    };
+
+    runTasks(numberOfTasks);
+    EXPECT_EQ(traceCount(), numberOfTasks);
+
+    {
+        std::lock_guard lock { traceAccess };
+
+        for (const auto& trace: traces) {
+            EXPECT_LT(trace.m_executor, 2u);
+            EXPECT_EQ(trace.m_priority, Priority::Background);
+            EXPECT_LE(trace.m_enqueuedAt, trace.m_startedAt);
+            EXPECT_LE(trace.m_startedAt, trace.m_finishedAt);
+        }
+    }
+
+    scheduler.value()->traceTasks({});
+    runTasks(numberOfTasks);
+    EXPECT_EQ(traceCount(), numberOfTasks);
+}
@@ -241,4 +241,69 @@ TEST(AtomicTask, result) {
 
     auto thread1 { std::jthread { std::move(*task1) } };
     EXPECT_EQ(task1Result.get(), "Task 1");
-}
\ No newline at end of file
+}
+
+TEST(AtomicTask, exception) {
+    const auto task { makeAtomicTask([] () -> int { throw std::runtime_error { "Task failed" }; }) };
+    const auto taskResult { task->result() };
+
+    (*task)();
+
+    EXPECT_TRUE(task->done());
+    EXPECT_TRUE(taskResult.ready());
+    EXPECT_THROW(std::ignore = taskResult.get(), std::runtime_error);
+}
+
+TEST(AtomicTask, cancellation) {
+    std::stop_source stopSource {};
+    auto ran { false };
+
+    const auto task { makeAtomicTask([&ran] () { ran = true; }) };
+    const auto taskResult { task->result() };
+    task->cancellation(stopSource.get_token());
+
+    // A task depending on a stopped one is stopped as well
+    const auto dependentTask { makeAtomicTask([&ran] () { ran = true; }) };
+    const auto dependentTaskResult { dependentTask->result() };
+    dependentTask->dependency(*task);
+
+    stopSource.request_stop();
+    (*task)();
+    (*dependentTask)();
+
+    EXPECT_FALSE(ran);
+    EXPECT_TRUE(task->done());
+    EXPECT_TRUE(dependentTask->done());
+    EXPECT_TRUE(task->dependency().cancelled());
+
+    for (const auto& result: { taskResult, dependentTaskResult }) {
+        try {
+            result.get();
+            ADD_FAILURE() << "Stopped task did not throw";
+        } catch (const std::system_error& error) {
+            EXPECT_EQ(error.code(), std::errc::operation_canceled);
+        }
+    }
+}
+
+TEST(AtomicTask, deadline) {
+    const auto task { makeAtomicTask([] () { return 1; }) };
+    const auto taskResult { task->result() };
+    task->deadline(std::chrono::steady_clock::now());
+
+    (*task)();
+
+    EXPECT_TRUE(task->done());
+    EXPECT_THROW(std::ignore = taskResult.get(), std::system_error);
+
+    const auto lateTask { makeAtomicTask([] () { return 1; }) };
+    const auto lateTaskResult { lateTask->result() };
+    lateTask->deadline(std::chrono::steady_clock::now() + std::chrono::hours { 1 });
+
+    EXPECT_EQ(lateTaskResult.getFor(std::chrono::milliseconds { 10 }), std::unexpected { std::errc::timed_out });
+
+    (*lateTask)();
+
+    EXPECT_FALSE(lateTask->dependency().cancelled());
+    EXPECT_EQ(lateTaskResult.getFor(std::chrono::milliseconds { 0 }), 1);
+}
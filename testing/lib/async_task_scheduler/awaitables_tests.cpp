@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+ResumableTask<int> addOne(const Result<int> result) {
+    co_return co_await result + 1;
+}
+
+ResumableTask<bool> waitFor(const Dependency dependency) {
+    co_await dependency;
+    co_return dependency.ready();
+}
+
+ResumableTask<std::chrono::steady_clock::duration> sleepTimes(const std::chrono::milliseconds delay, const unsigned int times) {
+    const auto start { std::chrono::steady_clock::now() };
+
+    for (unsigned int i { 0 }; i < times; ++i) {
+        co_await after(delay);
+    }
+
+    co_return std::chrono::steady_clock::now() - start;
+}
+
+ResumableTask<bool> moveTo(AsyncTaskScheduler& scheduler, const unsigned int threadId) {
+    co_await scheduleOn(scheduler, threadId);
+    co_return TaskExecutor::current() != nullptr;
+}
+
+TEST(Awaitables, awaitResult) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    auto producer { makeAtomicTask([] () {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+        return 41;
+    }) };
+
+    auto consumer { makeResumableTask(addOne(producer->result())) };
+    const auto consumerResult { consumer->result() };
+
+    scheduler->enqueueTask(std::move(consumer), 0);
+    scheduler->enqueueTask(std::move(producer), 1);
+
+    EXPECT_EQ(consumerResult.get(), 42);
+}
+
+TEST(Awaitables, awaitDependency) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    auto task { makeAtomicTask([] () { std::this_thread::sleep_for(std::chrono::milliseconds { 50 }); }) };
+    auto waitingTask { makeResumableTask(waitFor(task->dependency())) };
+    const auto waitingTaskResult { waitingTask->result() };
+
+    scheduler->enqueueTask(std::move(waitingTask), 0);
+    scheduler->enqueueTask(std::move(task), 1);
+
+    EXPECT_TRUE(waitingTaskResult.get());
+
+    // Complete before being awaited
+    auto completedTask { makeAtomicTask([] () {}) };
+    const auto completedTaskDependency { completedTask->dependency() };
+    (*completedTask)();
+
+    auto notWaitingTask { makeResumableTask(waitFor(completedTaskDependency)) };
+    const auto notWaitingTaskResult { notWaitingTask->result() };
+    scheduler->enqueueTask(std::move(notWaitingTask), 0);
+
+    EXPECT_TRUE(notWaitingTaskResult.get());
+}
+
+TEST(Awaitables, after) {
+    auto scheduler { makeAsyncTaskScheduler(1).value() };
+
+    auto sleepingTask { makeResumableTask(sleepTimes(std::chrono::milliseconds { 100 }, 2)) };
+    const auto sleepingTaskResult { sleepingTask->result() };
+    scheduler->enqueueTask(std::move(sleepingTask));
+
+    // The only executor is free while the coroutine waits
+    auto task { makeAtomicTask([] () {}) };
+    const auto taskDependency { task->dependency() };
+    scheduler->enqueueTask(std::move(task));
+
+    EXPECT_TRUE(taskDependency.waitFor(std::chrono::milliseconds { 150 }));
+    EXPECT_FALSE(sleepingTaskResult.ready());
+    EXPECT_GE(sleepingTaskResult.get(), std::chrono::milliseconds { 200 });
+
+    // Without a scheduler the calling thread sleeps
+    const auto directTask { makeResumableTask(sleepTimes(std::chrono::milliseconds { 10 }, 1)) };
+    (*directTask)();
+
+    EXPECT_TRUE(directTask->done());
+    EXPECT_GE(directTask->result().get(), std::chrono::milliseconds { 10 });
+}
+
+TEST(Awaitables, scheduleOn) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    auto task { makeResumableTask(moveTo(*scheduler, 1)) };
+    const auto taskResult { task->result() };
+    scheduler->enqueueTask(std::move(task), 0);
+
+    EXPECT_TRUE(taskResult.get());
+}
+
+TEST(Awaitables, stopAfter) {
+    auto scheduler { makeAsyncTaskScheduler(1).value() };
+
+    // Woken up as soon as stop is requested, rather than once the delay has passed
+    std::stop_source stopSource {};
+    auto cancelledTask { makeResumableTask(sleepTimes(std::chrono::seconds { 10 }, 1)) };
+    const auto cancelledTaskResult { cancelledTask->result() };
+    cancelledTask->cancellation(stopSource.get_token());
+    scheduler->enqueueTask(std::move(cancelledTask));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+    stopSource.request_stop();
+
+    EXPECT_TRUE(cancelledTaskResult.waitFor(std::chrono::seconds { 1 }));
+    EXPECT_THROW(std::ignore = cancelledTaskResult.get(), std::system_error);
+
+    // Woken up at its deadline
+    auto lateTask { makeResumableTask(sleepTimes(std::chrono::seconds { 10 }, 1)) };
+    const auto lateTaskResult { lateTask->result() };
+    lateTask->deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds { 20 });
+    scheduler->enqueueTask(std::move(lateTask));
+
+    EXPECT_TRUE(lateTaskResult.waitFor(std::chrono::seconds { 1 }));
+
+    try {
+        std::ignore = lateTaskResult.get();
+        ADD_FAILURE() << "Late task did not throw";
+    } catch (const std::system_error& error) {
+        EXPECT_EQ(error.code(), std::errc::timed_out);
+    }
+}
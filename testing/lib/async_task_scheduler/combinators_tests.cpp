@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import async_task_scheduler;
+
+using namespace async_task_scheduler;
+
+ResumableTask<int> sumAll(const Result<int> first, const Result<int> second) {
+    co_await whenAll(first, second);
+    co_return first.get() + second.get();
+}
+
+TEST(Combinators, whenAll) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    std::latch release { 1 };
+    auto slowTask { makeAtomicTask([&release] () { release.wait(); return 1; }) };
+    auto fastTask { makeAtomicTask([] () { return std::string { "fast" }; }) };
+    auto failingTask { makeAtomicTask([] () { throw std::runtime_error { "Task failed" }; }) };
+
+    const auto slowResult { slowTask->result() };
+    const auto fastResult { fastTask->result() };
+    const auto failingResult { failingTask->result() };
+    const auto all { whenAll(slowResult, fastResult, failingResult) };
+
+    scheduler->enqueueTask(std::move(slowTask), 0);
+    scheduler->enqueueTask(std::move(fastTask), 1);
+    scheduler->enqueueTask(std::move(failingTask), 1);
+
+    EXPECT_TRUE(whenAll(fastResult, failingResult).waitFor(std::chrono::seconds { 1 }));
+    EXPECT_FALSE(all.ready());
+
+    release.count_down();
+    all.wait();
+
+    // Errors stay with the inputs
+    EXPECT_NO_THROW(all.get());
+    EXPECT_EQ(slowResult.get(), 1);
+    EXPECT_EQ(fastResult.get(), "fast");
+    EXPECT_THROW(failingResult.get(), std::runtime_error);
+
+    // Inputs complete already, and none at all
+    EXPECT_TRUE(whenAll(std::vector { slowResult, slowResult }).ready());
+    EXPECT_TRUE(whenAll(std::vector<Result<int>> {}).ready());
+}
+
+TEST(Combinators, whenAny) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    std::latch release { 1 };
+    auto slowTask { makeAtomicTask([&release] () { release.wait(); return 1; }) };
+    auto fastTask { makeAtomicTask([] () { return 2; }) };
+
+    const std::vector results { slowTask->result(), fastTask->result() };
+    const auto any { whenAny(results) };
+
+    scheduler->enqueueTask(std::move(slowTask), 0);
+    scheduler->enqueueTask(std::move(fastTask), 1);
+
+    EXPECT_EQ(any.get(), 1u);
+    EXPECT_EQ(whenAny(results[1], results[0]).get(), 0u);
+
+    // The join waits for the slow task before going away
+    release.count_down();
+    results[0].wait();
+
+    EXPECT_THROW(std::ignore = whenAny(std::vector<Result<int>> {}).get(), std::invalid_argument);
+}
+
+TEST(Combinators, abandonedInput) {
+    auto task { makeAtomicTask([] () { return 1; }) };
+    const auto result { task->result() };
+    const auto all { whenAll(result) };
+    const auto any { whenAny(std::vector { result }) };
+
+    // Destroyed without running
+    task.reset();
+
+    EXPECT_NO_THROW(all.get());
+    EXPECT_EQ(any.get(), 0u);
+    EXPECT_THROW(std::ignore = result.get(), std::future_error);
+}
+
+TEST(Combinators, awaitWhenAll) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    auto first { makeAtomicTask([] () { return 20; }) };
+    auto second { makeAtomicTask([] () { return 22; }) };
+    auto sum { makeResumableTask(sumAll(first->result(), second->result())) };
+    const auto sumResult { sum->result() };
+
+    scheduler->enqueueTask(std::move(sum), 0);
+    scheduler->enqueueTask(std::move(first), 1);
+    scheduler->enqueueTask(std::move(second), 0);
+
+    EXPECT_EQ(sumResult.get(), 42);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import async_task;
+import executor_statistics;
+
+using namespace async_task_scheduler;
+
+TEST(ExecutorStatistics, histogram) {
+    AtomicHistogram histogram {};
+    EXPECT_EQ(histogram.snapshot().count(), 0u);
+    EXPECT_EQ(histogram.snapshot().percentile(50.0), std::chrono::nanoseconds::zero());
+
+    for (unsigned int i { 0 }; i < 90; ++i) {
+        histogram.record(std::chrono::microseconds { 1 });
+    }
+
+    for (unsigned int i { 0 }; i < 10; ++i) {
+        histogram.record(std::chrono::milliseconds { 1 });
+    }
+
+    // Negative durations land in the first bucket, huge ones in the last
+    histogram.record(std::chrono::nanoseconds { -1 });
+    histogram.record(std::chrono::hours { 24 * 365 });
+
+    const auto snapshot { histogram.snapshot() };
+    EXPECT_EQ(snapshot.count(), 102u);
+    EXPECT_EQ(snapshot.m_counts.front(), 1u);
+    EXPECT_EQ(snapshot.m_counts.back(), 1u);
+
+    // Upper bounds of the buckets, within twice the duration recorded
+    EXPECT_GE(snapshot.percentile(50.0), std::chrono::microseconds { 1 });
+    EXPECT_LT(snapshot.percentile(50.0), std::chrono::microseconds { 2 });
+    EXPECT_GE(snapshot.percentile(95.0), std::chrono::milliseconds { 1 });
+    EXPECT_LT(snapshot.percentile(95.0), std::chrono::milliseconds { 2 });
+}
+
+TEST(ExecutorStatistics, since) {
+    AtomicHistogram histogram {};
+    histogram.record(std::chrono::microseconds { 1 });
+
+    const ExecutorStatistics earlier { "executor", Priority::Background, 3, 10, 1, std::chrono::milliseconds { 4 },
+        std::chrono::milliseconds { 4 }, histogram.snapshot(), histogram.snapshot() };
+
+    histogram.record(std::chrono::milliseconds { 1 });
+
+    const ExecutorStatistics later { "executor", Priority::Background, 0, 15, 2, std::chrono::milliseconds { 7 },
+        std::chrono::milliseconds { 5 }, histogram.snapshot(), histogram.snapshot() };
+
+    const auto period { later.since(earlier) };
+    EXPECT_EQ(period.m_queueDepth, 0u);
+    EXPECT_EQ(period.m_tasksRun, 5u);
+    EXPECT_EQ(period.m_tasksStolen, 1u);
+    EXPECT_EQ(period.m_runTime.count(), 1u);
+    EXPECT_GE(period.m_runTime.percentile(50.0), std::chrono::milliseconds { 1 });
+    EXPECT_DOUBLE_EQ(period.utilization(), 0.75);
+
+    EXPECT_DOUBLE_EQ(ExecutorStatistics {}.utilization(), 0.0);
+}
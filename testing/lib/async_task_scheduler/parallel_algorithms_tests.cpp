@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import async_task_scheduler;
+import parallel_algorithms;
+
+using namespace async_task_scheduler;
+
+constexpr unsigned int numberOfThreads { 4 };
+constexpr std::size_t numberOfElements { 100'000 };
+
+// Split by the executor itself, awaited rather than waited on so that it goes on running the chunks
+ResumableTask<int> sumFromTask(AsyncTaskScheduler& scheduler) {
+    std::atomic<int> sum { 0 };
+
+    co_await parallelFor(scheduler, std::views::iota(1, 101), 1, [&sum] (const int i) { sum += i; });
+    co_return sum.load();
+}
+
+TEST(ParallelAlgorithms, parallelFor) {
+    auto scheduler { makeAsyncTaskScheduler(numberOfThreads).value() };
+    std::vector<std::atomic<unsigned int>> visits(numberOfElements);
+
+    parallelFor(*scheduler, std::views::iota(std::size_t { 0 }, numberOfElements), 1000, [&visits] (const std::size_t i) { ++visits[i]; }).get();
+    EXPECT_TRUE(std::ranges::all_of(visits, [] (const auto& visit) { return visit.load() == 1; }));
+
+    // Elements are references into the range, a grain of zero gives a chunk per element
+    std::vector<int> values(1000, 1);
+    parallelFor(*scheduler, values, 0, [] (int& value) { value *= 2; }).get();
+    EXPECT_TRUE(std::ranges::all_of(values, [] (const int value) { return value == 2; }));
+
+    // A grain larger than the range gives a single chunk
+    parallelFor(*scheduler, values, std::numeric_limits<std::size_t>::max(), [] (int& value) { value += 1; }).get();
+    EXPECT_TRUE(std::ranges::all_of(values, [] (const int value) { return value == 3; }));
+
+    const std::vector<int> empty {};
+    EXPECT_TRUE(parallelFor(*scheduler, empty, 10, [] (int) {}).ready());
+}
+
+TEST(ParallelAlgorithms, parallelReduce) {
+    auto scheduler { makeAsyncTaskScheduler(numberOfThreads).value() };
+    const auto elements { std::views::iota(std::uint64_t { 1 }, std::uint64_t { numberOfElements + 1 }) };
+
+    EXPECT_EQ(parallelReduce(*scheduler, elements, 777, std::uint64_t { 0 }, std::plus {}).get(), numberOfElements * (numberOfElements + 1) / 2);
+    EXPECT_EQ(parallelReduce(*scheduler, elements, 777, std::uint64_t { 0 }, std::plus {}, [] (const std::uint64_t i) { return i % 2; }).get(),
+        numberOfElements / 2);
+
+    // Not commutative, chunks are reduced in order
+    const std::vector<std::string> letters { "a", "b", "c", "d", "e", "f", "g" };
+    EXPECT_EQ(parallelReduce(*scheduler, letters, 2, std::string { ">" }, std::plus {}).get(), ">abcdefg");
+    EXPECT_EQ(parallelReduce(*scheduler, letters, std::numeric_limits<std::size_t>::max(), std::string { ">" }, std::plus {}).get(), ">abcdefg");
+
+    const std::vector<int> empty {};
+    EXPECT_EQ(parallelReduce(*scheduler, empty, 10, 42, std::plus {}).get(), 42);
+}
+
+TEST(ParallelAlgorithms, parallelTransform) {
+    auto scheduler { makeAsyncTaskScheduler(numberOfThreads).value() };
+    std::vector<float> samples(numberOfElements);
+
+    parallelTransform(*scheduler, std::views::iota(std::size_t { 0 }, numberOfElements), samples.begin(), 4096,
+        [] (const std::size_t i) { return static_cast<float>(i) / 2.0f; }).get();
+
+    for (std::size_t i { 0 }; i < numberOfElements; ++i) {
+        ASSERT_EQ(samples[i], static_cast<float>(i) / 2.0f);
+    }
+}
+
+TEST(ParallelAlgorithms, exception) {
+    auto scheduler { makeAsyncTaskScheduler(numberOfThreads).value() };
+
+    const auto result { parallelFor(*scheduler, std::views::iota(0, 1000), 10, [] (const int i) {
+        if (i == 500) {
+            throw std::runtime_error { "Failed" };
+        }
+    }) };
+
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(ParallelAlgorithms, fromTask) {
+    auto scheduler { makeAsyncTaskScheduler(1).value() };
+    auto task { makeResumableTask(sumFromTask(*scheduler)) };
+
+    const auto result { task->result() };
+    scheduler->enqueueTask(std::move(task));
+
+    EXPECT_EQ(result.get(), 5050);
+}
@@ -80,4 +80,23 @@ TEST(ResumableTask, result) {
 
     auto thread1 { std::jthread { std::jthread { [&] { while (not taskCheckResult->done()) (*taskCheckResult)(); } } } };
     EXPECT_EQ(task1Result.get(), "Task 1");
-}
\ No newline at end of file
+}
+
+TEST(ResumableTask, cancellation) {
+    std::stop_source stopSource {};
+
+    auto task { makeResumableTask(task1()) };
+    const auto taskResult { task->result() };
+    task->cancellation(stopSource.get_token());
+
+    (*task)();
+    EXPECT_FALSE(task->done());
+
+    // Stopped at its suspension point rather than resumed
+    stopSource.request_stop();
+    (*task)();
+
+    EXPECT_TRUE(task->done());
+    EXPECT_TRUE(taskResult.ready());
+    EXPECT_THROW(taskResult.get(), std::system_error);
+}
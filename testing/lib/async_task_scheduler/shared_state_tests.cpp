@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import shared_state;
+
+using namespace async_task_scheduler;
+
+class RecordingContinuation final : public Continuation {
+public:
+    RecordingContinuation(std::vector<int>& runs, const int id) :  m_runs { runs }, m_id { id } {}
+
+    auto run() -> void override { m_runs.push_back(m_id); }
+
+private:
+    std::vector<int>& m_runs;
+    int m_id;
+};
+
+TEST(SharedState, getValue) {
+    auto state { makeSharedState<std::string>() };
+    const auto reference { state };
+
+    EXPECT_FALSE(reference->ready());
+    EXPECT_FALSE(reference->waitFor(std::chrono::milliseconds { 1 }));
+
+    std::jthread producer { [state] () mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+        state->setValue("Result");
+        state->complete();
+    } };
+
+    EXPECT_EQ(reference->get(), "Result");
+    EXPECT_TRUE(reference->ready());
+    EXPECT_TRUE(reference->waitFor(std::chrono::milliseconds::zero()));
+}
+
+TEST(SharedState, waitFor) {
+    auto state { makeSharedState<int>() };
+
+    // Timed out, its wake up is left to the completion
+    EXPECT_FALSE(state->waitFor(std::chrono::milliseconds { 1 }));
+
+    std::jthread producer { [state] () mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+        state->setValue(1);
+        state->complete();
+    } };
+
+    // Woken up by the completion rather than the timeout
+    const auto start { std::chrono::steady_clock::now() };
+
+    EXPECT_TRUE(state->waitFor(std::chrono::seconds { 10 }));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds { 5 });
+}
+
+TEST(SharedState, getException) {
+    auto state { makeSharedState<void>() };
+
+    state->setException(std::make_exception_ptr(std::runtime_error { "Failed" }));
+    state->complete();
+
+    EXPECT_THROW(state->get(), std::runtime_error);
+}
+
+TEST(SharedState, continuations) {
+    std::vector<int> runs {};
+    RecordingContinuation first { runs, 1 };
+    RecordingContinuation second { runs, 2 };
+    RecordingContinuation third { runs, 3 };
+
+    auto state { makeSharedState<int>() };
+
+    EXPECT_TRUE(state->addContinuation(first));
+    EXPECT_TRUE(state->addContinuation(second));
+    EXPECT_TRUE(runs.empty());
+
+    state->setValue(3);
+    state->complete();
+
+    // In the order they were added, once complete it is up to the caller
+    EXPECT_EQ(runs, (std::vector { 1, 2 }));
+    EXPECT_FALSE(state->addContinuation(third));
+    EXPECT_EQ(runs, (std::vector { 1, 2 }));
+}
+
+TEST(SharedState, abandon) {
+    std::vector<int> runs {};
+    RecordingContinuation continuation { runs, 1 };
+
+    auto state { makeSharedState<int>() };
+    EXPECT_TRUE(state->addContinuation(continuation));
+
+    state->abandon();
+
+    EXPECT_TRUE(state->ready());
+    EXPECT_TRUE(state->cancelled());
+    EXPECT_THROW(std::ignore = state->get(), std::future_error);
+    EXPECT_EQ(runs, (std::vector { 1 }));
+}
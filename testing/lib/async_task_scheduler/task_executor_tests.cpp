@@ -45,4 +45,98 @@ TEST(TaskExecutor, executeTasks) {
     for (auto taskCompletion: tasksCompletion) {
         ASSERT_EQ(taskCompletion, true);
     }
-}
\ No newline at end of file
+}
+
+TEST(TaskExecutor, priorities) {
+    constexpr std::size_t numberOfControlTasks { 40 };
+
+    auto executor { makeTaskExecutor() };
+
+    std::latch gateRunning { 1 };
+    std::binary_semaphore gate { 0 };
+    std::vector<Priority> order {};
+    std::vector<Dependency> dependencies {};
+
+    // Keeps the executor busy while the other tasks are enqueued
+    executor->enqueueTask(makeAtomicTask([&gateRunning, &gate] () {
+        gateRunning.count_down();
+        gate.acquire();
+    }));
+
+    gateRunning.wait();
+
+    auto backgroundTask { makeAtomicTask([&order] () { order.push_back(Priority::Background); }) };
+    dependencies.push_back(backgroundTask->dependency());
+    executor->enqueueTask(std::move(backgroundTask));
+
+    for (std::size_t i { 0 }; i < numberOfControlTasks; ++i) {
+        auto controlTask { makeAtomicTask([&order] () { order.push_back(Priority::Control); }) };
+        controlTask->priority(Priority::Control);
+        dependencies.push_back(controlTask->dependency());
+        executor->enqueueTask(std::move(controlTask));
+    }
+
+    gate.release();
+
+    for (const auto& dependency: dependencies) {
+        dependency.wait();
+    }
+
+    // Control tasks first, yet the background task is not left until the last one
+    const auto backgroundTaskPosition { std::ranges::find(order, Priority::Background) - order.begin() };
+
+    ASSERT_EQ(order.size(), numberOfControlTasks + 1);
+    EXPECT_GT(backgroundTaskPosition, 0);
+    EXPECT_LT(backgroundTaskPosition, static_cast<std::ptrdiff_t>(numberOfControlTasks));
+}
+
+TEST(TaskExecutor, enqueueTasks) {
+    auto executor { makeTaskExecutor() };
+
+    std::atomic<unsigned int> completedTasks { 0 };
+    std::vector<std::unique_ptr<AsyncTask>> tasks {};
+    std::vector<Dependency> dependencies {};
+
+    for (unsigned int i { 0 }; i < numberOfTasks; ++i) {
+        auto task { makeAtomicTask([&completedTasks] () { ++completedTasks; }) };
+        dependencies.emplace_back(task->dependency());
+        tasks.emplace_back(std::move(task));
+    }
+
+    executor->enqueueTasks(std::move(tasks));
+    executor->enqueueTasks(std::vector<std::unique_ptr<AsyncTask>> {});
+
+    for (auto& dependency: dependencies) {
+        dependency.wait();
+    }
+
+    EXPECT_EQ(completedTasks.load(), numberOfTasks);
+}
+
+TEST(TaskExecutor, idlePolicies) {
+    using namespace std::chrono_literals;
+
+    // Sleeping straight away, spinning, yielding, and both before sleeping
+    for (const auto policy: { IdlePolicy {}, IdlePolicy { 10ms, 0ns }, IdlePolicy { 0ns, 10ms }, IdlePolicy { 1ms, 1ms } }) {
+        auto executor { makeTaskExecutor(Priority::Background, ThreadConfiguration { {}, {}, std::nullopt, std::nullopt, std::nullopt, policy }) };
+
+        // Enqueued while the executor spins or yields, then once it sleeps
+        for (const auto pause: { 0ms, 50ms }) {
+            std::this_thread::sleep_for(pause);
+
+            auto task { makeAtomicTask([] () { return true; }) };
+            const auto result { task->result() };
+
+            executor->enqueueTask(std::move(task));
+            EXPECT_TRUE(result.get());
+        }
+    }
+
+    // Stopping ends the spinning
+    auto executor { makeTaskExecutor(Priority::Background, ThreadConfiguration { {}, {}, std::nullopt, std::nullopt, std::nullopt, IdlePolicy { 1h, 0ns } }) };
+    const auto stoppedAt { std::chrono::steady_clock::now() };
+
+    executor->stop();
+
+    EXPECT_LT(std::chrono::steady_clock::now() - stoppedAt, 10s);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import async_task_scheduler;
+import task_graph;
+
+using namespace async_task_scheduler;
+
+TEST(TaskGraph, validate) {
+    TaskGraph graph {};
+
+    const auto first { graph.node([] () {}) };
+    const auto second { graph.node([] () {}) };
+    const auto third { graph.node([] () {}) };
+
+    EXPECT_EQ(graph.edge(first, 3), std::unexpected<std::string> { "Unknown node" });
+
+    EXPECT_TRUE(graph.edge(first, second).has_value());
+    EXPECT_TRUE(graph.edge(second, third).has_value());
+    EXPECT_TRUE(graph.validate().has_value());
+
+    EXPECT_TRUE(graph.edge(third, first).has_value());
+    EXPECT_EQ(graph.validate(), std::unexpected<std::string> { "Graph has a cycle" });
+
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+    EXPECT_EQ(graph.run(*scheduler), std::unexpected<std::string> { "Graph has a cycle" });
+}
+
+TEST(TaskGraph, run) {
+    auto scheduler { makeAsyncTaskScheduler(4).value() };
+
+    // A diamond of chains: every node records when it ran
+    constexpr std::size_t chainLength { 20 };
+    std::atomic<std::size_t> clock { 0 };
+    std::vector<std::atomic<std::size_t>> ranAt(2 + 2 * chainLength);
+
+    TaskGraph graph {};
+    std::vector<NodeId_t> nodes {};
+
+    for (std::size_t i { 0 }; i < ranAt.size(); ++i) {
+        nodes.push_back(graph.node([&clock, &ranAt, i] () { ranAt[i] = ++clock; }));
+    }
+
+    const auto source { nodes.front() };
+    const auto sink { nodes.back() };
+
+    for (std::size_t chain { 0 }; chain < 2; ++chain) {
+        auto previous { source };
+
+        for (std::size_t i { 0 }; i < chainLength; ++i) {
+            const auto node { nodes[1 + chain * chainLength + i] };
+            EXPECT_TRUE(graph.edge(previous, node).has_value());
+            previous = node;
+        }
+
+        EXPECT_TRUE(graph.edge(previous, sink).has_value());
+    }
+
+    // Replayed without building it again
+    for (std::size_t run { 0 }; run < 3; ++run) {
+        clock = 0;
+
+        const auto result { graph.run(*scheduler) };
+        ASSERT_TRUE(result.has_value());
+        EXPECT_NO_THROW(result->get());
+
+        EXPECT_EQ(clock.load(), ranAt.size());
+        EXPECT_EQ(ranAt[source].load(), 1u);
+        EXPECT_EQ(ranAt[sink].load(), ranAt.size());
+
+        for (std::size_t chain { 0 }; chain < 2; ++chain) {
+            for (std::size_t i { 1 }; i < chainLength; ++i) {
+                EXPECT_LT(ranAt[1 + chain * chainLength + i - 1].load(), ranAt[1 + chain * chainLength + i].load());
+            }
+        }
+    }
+
+    TaskGraph emptyGraph {};
+    const auto emptyResult { emptyGraph.run(*scheduler) };
+    ASSERT_TRUE(emptyResult.has_value());
+    EXPECT_TRUE(emptyResult->ready());
+}
+
+TEST(TaskGraph, alreadyRunning) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    std::latch release { 1 };
+    TaskGraph graph {};
+    std::ignore = graph.node([&release] () { release.wait(); });
+
+    const auto result { graph.run(*scheduler) };
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(graph.run(*scheduler), std::unexpected<std::string> { "Graph already running" });
+
+    release.count_down();
+    result->wait();
+
+    // Run again once done
+    const auto nextResult { graph.run(*scheduler) };
+    ASSERT_TRUE(nextResult.has_value());
+    nextResult->wait();
+}
+
+TEST(TaskGraph, exception) {
+    auto scheduler { makeAsyncTaskScheduler(2).value() };
+
+    std::atomic_bool ranAfterFailure { false };
+    TaskGraph graph {};
+
+    const auto failing { graph.node([] () { throw std::runtime_error { "Node failed" }; }) };
+    const auto next { graph.node([&ranAfterFailure] () { ranAfterFailure = true; }) };
+    std::ignore = graph.edge(failing, next);
+
+    const auto result { graph.run(*scheduler) };
+    ASSERT_TRUE(result.has_value());
+    EXPECT_THROW(result->get(), std::runtime_error);
+    EXPECT_FALSE(ranAfterFailure);
+
+    std::stop_source stopSource {};
+    stopSource.request_stop();
+
+    TaskGraph stoppedGraph {};
+    std::ignore = stoppedGraph.node([&ranAfterFailure] () { ranAfterFailure = true; });
+
+    const auto stoppedResult { stoppedGraph.run(*scheduler, stopSource.get_token()) };
+    ASSERT_TRUE(stoppedResult.has_value());
+    EXPECT_THROW(stoppedResult->get(), std::system_error);
+    EXPECT_FALSE(ranAfterFailure);
+}
+
+TEST(TaskGraph, abandoned) {
+    std::atomic_bool ran { false };
+    TaskGraph graph {};
+
+    const auto first { graph.node([&ran] () { ran = true; }) };
+    const auto second { graph.node([&ran] () { ran = true; }) };
+    std::ignore = graph.edge(first, second);
+
+    auto scheduler { makeAsyncTaskScheduler(1).value() };
+
+    for (int i { 0 }; i < 10; ++i) {
+        scheduler->enqueueTask(makeAtomicTask([] () { std::this_thread::sleep_for(std::chrono::milliseconds { 10 }); }));
+    }
+
+    const auto result { graph.run(*scheduler) };
+    ASSERT_TRUE(result.has_value());
+
+    // Destroyed before reaching the graph, the nodes never run still complete it
+    scheduler.reset();
+
+    EXPECT_TRUE(result->ready());
+    EXPECT_THROW(result->get(), std::future_error);
+    EXPECT_FALSE(ran);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import task_pool;
+import async_task;
+import atomic_task;
+
+using namespace async_task_scheduler;
+
+TEST(TaskPool, recycles) {
+    auto* block { TaskPool::allocate(100) };
+    TaskPool::deallocate(block, 100);
+
+    // Same class of size, the block freed last comes first
+    auto* sameClassBlock { TaskPool::allocate(128) };
+    EXPECT_EQ(sameClassBlock, block);
+
+    auto* otherClassBlock { TaskPool::allocate(200) };
+    EXPECT_NE(otherClassBlock, block);
+
+    TaskPool::deallocate(sameClassBlock, 128);
+    TaskPool::deallocate(otherClassBlock, 200);
+
+    // Beyond the largest class, from the heap
+    auto* largeBlock { TaskPool::allocate(TaskPool::largestBlockSize + 1) };
+    EXPECT_NE(largeBlock, nullptr);
+    TaskPool::deallocate(largeBlock, TaskPool::largestBlockSize + 1);
+
+    // Aligned beyond the blocks of the pool, from the heap
+    auto* alignedBlock { TaskPool::allocate(100, std::align_val_t { 256 }) };
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(alignedBlock) % 256, 0u);
+    TaskPool::deallocate(alignedBlock, 100, std::align_val_t { 256 });
+}
+
+TEST(TaskPool, acrossThreads) {
+    constexpr std::size_t blockCount { 1000 };
+
+    // Freed on another thread, handed over in batches
+    for (unsigned int round { 0 }; round < 3; ++round) {
+        std::vector<void*> blocks {};
+
+        for (std::size_t i { 0 }; i < blockCount; ++i) {
+            blocks.push_back(TaskPool::allocate(256));
+            std::memset(blocks.back(), 0xff, 256);
+        }
+
+        std::jthread { [&blocks] () {
+            for (auto* block: blocks) {
+                TaskPool::deallocate(block, 256);
+            }
+        } }.join();
+
+        std::ranges::sort(blocks);
+        EXPECT_EQ(std::ranges::adjacent_find(blocks), blocks.end());
+    }
+}
+
+TEST(TaskPool, overAlignedTask) {
+    class alignas(256) AlignedTask final : public AsyncTask {
+    public:
+        auto operator()() -> void override {}
+        [[nodiscard]] auto done() const -> bool override { return true; }
+    };
+
+    const std::unique_ptr<AsyncTask> task { std::make_unique<AlignedTask>() };
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(task.get()) % 256, 0u);
+}
+
+TEST(TaskFunction, inPlaceAndPooled) {
+    const auto counter { std::make_shared<int>(0) };
+
+    {
+        TaskFunction<int(int)> small { [counter] (const int value) { return value + 1; } };
+        EXPECT_EQ(small(1), 2);
+
+        std::array<std::int64_t, 32> values {};
+        values.fill(1);
+
+        TaskFunction<std::int64_t()> large { [counter, values] () { return std::ranges::fold_left(values, std::int64_t { 0 }, std::plus {}); } };
+        EXPECT_EQ(large(), 32);
+
+        // Move only captures
+        TaskFunction<int()> moveOnly { [value = std::make_unique<int>(3)] () { return *value; } };
+        EXPECT_EQ(moveOnly(), 3);
+
+        auto movedSmall { std::move(small) };
+        EXPECT_EQ(movedSmall(2), 3);
+
+        auto movedLarge { std::move(large) };
+        EXPECT_EQ(movedLarge(), 32);
+    }
+
+    // Destroyed along with the functions
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(TaskFunction, overAligned) {
+    struct alignas(256) Aligned {
+        int m_value;
+    };
+
+    TaskFunction<bool()> function { [aligned = Aligned { 1 }] () { return reinterpret_cast<std::uintptr_t>(&aligned) % 256 == 0; } };
+    EXPECT_TRUE(function());
+
+    auto moved { std::move(function) };
+    EXPECT_TRUE(moved());
+}
+
+TEST(TaskFunction, inAtomicTask) {
+    std::string prefix { "A string too long to fit in the small string buffer" };
+    const auto task { makeAtomicTask([prefix] (const int value) { return std::format("{} {}", prefix, value); }, 1) };
+    const auto result { task->result() };
+
+    (*task)();
+
+    EXPECT_EQ(result.get(), std::format("{} 1", prefix));
+}
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import thread_configuration;
+
+using namespace async_task_scheduler;
+
+TEST(ThreadConfiguration, parseCores) {
+    EXPECT_EQ(parseCores("0-3,8,10-11"), (std::vector<unsigned int> { 0, 1, 2, 3, 8, 10, 11 }));
+    EXPECT_EQ(parseCores("5"), std::vector<unsigned int> { 5 });
+    EXPECT_EQ(parseCores(""), std::vector<unsigned int> {});
+
+    EXPECT_EQ(parseCores("3-1").error(), "Invalid core list 3-1");
+    EXPECT_EQ(parseCores("0,a").error(), "Invalid core list 0,a");
+    EXPECT_EQ(parseCores("0-").error(), "Invalid core list 0-");
+}
+
+TEST(ThreadConfiguration, configureCurrentThread) {
+    std::expected<void, std::string> named {};
+    std::expected<void, std::string> unknownNumaNode {};
+
+    std::jthread { [&named, &unknownNumaNode] () {
+        named = configureCurrentThread(ThreadConfiguration { "configured", {}, std::nullopt, std::nullopt, std::nullopt, {} });
+        unknownNumaNode = configureCurrentThread(ThreadConfiguration { {}, {}, 100000, std::nullopt, std::nullopt, {} });
+    } }.join();
+
+    EXPECT_TRUE(named.has_value());
+    ASSERT_FALSE(unknownNumaNode.has_value());
+    EXPECT_EQ(unknownNumaNode.error(), "Unknown NUMA node 100000");
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import timer;
+
+using namespace async_task_scheduler;
+
+TEST(Timer, order) {
+    Timer timer {};
+
+    std::mutex access {};
+    std::vector<int> runs {};
+    std::latch done { 3 };
+
+    const auto now { std::chrono::steady_clock::now() };
+
+    for (const auto delay: { 30, 10, 20 }) {
+        timer.schedule(now + std::chrono::milliseconds { delay }, std::chrono::milliseconds::zero(), [&, delay] () {
+            std::lock_guard lock { access };
+            runs.push_back(delay);
+            done.count_down();
+        });
+    }
+
+    done.wait();
+    EXPECT_EQ(runs, (std::vector { 10, 20, 30 }));
+}
+
+TEST(Timer, cancel) {
+    Timer timer {};
+    std::atomic_bool ran { false };
+
+    const auto timerId { timer.schedule(std::chrono::steady_clock::now() + std::chrono::milliseconds { 50 },
+        std::chrono::milliseconds::zero(), [&ran] () { ran = true; }) };
+
+    // Far enough for the last level of the wheel
+    const auto farTimerId { timer.schedule(std::chrono::steady_clock::now() + std::chrono::hours { 10 },
+        std::chrono::milliseconds::zero(), [&ran] () { ran = true; }) };
+
+    EXPECT_EQ(timer.pendingTimers(), 2u);
+    EXPECT_TRUE(timer.cancel(timerId));
+    EXPECT_TRUE(timer.cancel(farTimerId));
+    EXPECT_FALSE(timer.cancel(timerId));
+    EXPECT_EQ(timer.pendingTimers(), 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds { 100 });
+    EXPECT_FALSE(ran);
+
+    // Running for the last time, it can not be cancelled anymore
+    std::latch running { 1 };
+    std::latch cancelled { 1 };
+
+    const auto runningTimerId { timer.schedule(std::chrono::steady_clock::now(), std::chrono::milliseconds::zero(), [&running, &cancelled] () {
+        running.count_down();
+        cancelled.wait();
+    }) };
+
+    running.wait();
+    EXPECT_FALSE(timer.cancel(runningTimerId));
+    cancelled.count_down();
+}
+
+TEST(Timer, period) {
+    Timer timer {};
+    std::atomic<unsigned int> runs { 0 };
+
+    const auto timerId { timer.schedule(std::chrono::steady_clock::now(), std::chrono::milliseconds { 10 }, [&runs] () { ++runs; }) };
+
+    while (runs < 5) {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+    }
+
+    EXPECT_TRUE(timer.cancel(timerId));
+
+    // A run may have been under way while cancelling
+    std::this_thread::sleep_for(std::chrono::milliseconds { 20 });
+    const auto cancelledRuns { runs.load() };
+    std::this_thread::sleep_for(std::chrono::milliseconds { 50 });
+
+    EXPECT_EQ(runs.load(), cancelledRuns);
+}
+
+TEST(Timer, manyTimers) {
+    constexpr std::size_t timerCount { 5000 };
+
+    Timer timer {};
+    std::mt19937 generator { 42 };
+    std::uniform_int_distribution delays { 0, 300 };
+
+    std::atomic<std::size_t> runs { 0 };
+    std::atomic<std::size_t> earlyRuns { 0 };
+    std::vector<TimerId_t> timerIds {};
+
+    for (std::size_t i { 0 }; i < timerCount; ++i) {
+        const auto deadline { std::chrono::steady_clock::now() + std::chrono::milliseconds { delays(generator) } };
+
+        timerIds.push_back(timer.schedule(deadline, std::chrono::milliseconds::zero(), [&runs, &earlyRuns, deadline] () {
+            if (std::chrono::steady_clock::now() < deadline) {
+                ++earlyRuns;
+            }
+
+            ++runs;
+        }));
+    }
+
+    std::size_t cancelled { 0 };
+
+    for (std::size_t i { 0 }; i < timerCount; i += 2) {
+        if (timer.cancel(timerIds[i])) {
+            ++cancelled;
+        }
+    }
+
+    while (runs + cancelled < timerCount) {
+        std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+    }
+
+    EXPECT_EQ(runs.load() + cancelled, timerCount);
+    EXPECT_EQ(earlyRuns.load(), 0u);
+    EXPECT_EQ(timer.pendingTimers(), 0u);
+}
+
+TEST(Timer, levelBoundary) {
+    // Due on the first ticks of the second level, they are moved down on the tick they run on. Running that tick late
+    // can not be told from a slow wake-up on a single run, so each timer is given a few
+    constexpr auto attempts { 10 };
+
+    for (const auto delay: { 64, 128 }) {
+        auto onTime { false };
+
+        for (auto attempt { 0 }; attempt < attempts and not onTime; ++attempt) {
+            // Taken before the timer starts counting, the deadline falls on the tick of the delay
+            const auto deadline { std::chrono::steady_clock::now() + std::chrono::milliseconds { delay } };
+
+            Timer timer {};
+            std::latch done { 1 };
+            std::chrono::steady_clock::time_point ranAt {};
+
+            timer.schedule(deadline, std::chrono::milliseconds::zero(), [&done, &ranAt] () {
+                ranAt = std::chrono::steady_clock::now();
+                done.count_down();
+            });
+
+            done.wait();
+            EXPECT_GE(ranAt, deadline);
+
+            onTime = ranAt < deadline + Timer::tick;
+        }
+
+        EXPECT_TRUE(onTime) << delay << " ms";
+    }
+}
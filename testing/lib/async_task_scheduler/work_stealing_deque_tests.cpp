@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import work_stealing_deque;
+
+using namespace async_task_scheduler;
+
+TEST(WorkStealingDeque, order) {
+    EXPECT_THROW(WorkStealingDeque<int*> { 3 }, std::invalid_argument);
+
+    std::array<int, 10> items {};
+    WorkStealingDeque<int*> deque { 2 };
+
+    EXPECT_EQ(deque.pop(), nullptr);
+    EXPECT_EQ(deque.steal(), nullptr);
+
+    // Grows past its initial capacity
+    for (auto& item: items) {
+        deque.push(&item);
+    }
+
+    EXPECT_EQ(deque.size(), items.size());
+
+    // Owner takes the newest, thieves the oldest
+    EXPECT_EQ(deque.pop(), &items.back());
+    EXPECT_EQ(deque.steal(), &items.front());
+    EXPECT_EQ(deque.steal(), &items[1]);
+    EXPECT_EQ(deque.pop(), &items[8]);
+    EXPECT_EQ(deque.size(), 6u);
+
+    for (std::size_t i { 2 }; i < 8; ++i) {
+        EXPECT_EQ(deque.steal(), &items[i]);
+    }
+
+    EXPECT_TRUE(deque.empty());
+    EXPECT_EQ(deque.pop(), nullptr);
+}
+
+TEST(WorkStealingDeque, concurrentSteal) {
+    constexpr std::size_t numberOfItems { 100000 };
+    constexpr std::size_t numberOfThieves { 4 };
+
+    std::vector<int> items(numberOfItems);
+    std::vector<std::atomic<unsigned int>> taken(numberOfItems);
+    WorkStealingDeque<int*> deque {};
+
+    std::atomic_bool done { false };
+    std::vector<std::jthread> thieves {};
+
+    for (std::size_t thief { 0 }; thief < numberOfThieves; ++thief) {
+        thieves.emplace_back([&] () {
+            while (not done.load()) {
+                if (auto* item { deque.steal() }) {
+                    taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+                }
+            }
+        });
+    }
+
+    // Owner pushes and pops while thieves steal, every item has to be taken exactly once
+    for (std::size_t i { 0 }; i < numberOfItems; ++i) {
+        deque.push(&items[i]);
+
+        if (i % 3 == 0) {
+            if (auto* item { deque.pop() }) {
+                taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+            }
+        }
+    }
+
+    while (auto* item { deque.pop() }) {
+        taken[static_cast<std::size_t>(item - items.data())].fetch_add(1);
+    }
+
+    done.store(true);
+    thieves.clear();
+
+    EXPECT_TRUE(std::ranges::all_of(taken, [] (const auto& count) { return count.load() == 1; }));
+}
@@ -403,3 +403,65 @@ TEST_F(AudioEngineTest, process) {
         EXPECT_NEAR(rawOutputRingAudioBuffer[i], expectedOutputRingAudioBuffer[i], std::numeric_limits<float>::epsilon());
     }
 }
+
+TEST_F(AudioEngineTest, preRoll) {
+    EXPECT_CALL(static_cast<AudioLibraryWrapperMock&>(*m_audioEngineMock.m_audioLibraryWrapper), isStreamOpen)
+        .WillRepeatedly(testing::Return(true));
+
+    EXPECT_CALL(static_cast<AudioLibraryWrapperMock&>(*m_audioEngineMock.m_audioLibraryWrapper), isStreamRunning)
+        .WillRepeatedly(testing::Return(true));
+
+    EXPECT_CALL(static_cast<AudioLibraryWrapperMock&>(*m_audioEngineMock.m_audioLibraryWrapper), startStream)
+        .WillRepeatedly(testing::Return(true));
+
+    EXPECT_CALL(static_cast<AudioLibraryWrapperMock&>(*m_audioEngineMock.m_audioLibraryWrapper), stopStream)
+        .WillRepeatedly(testing::Return(true));
+
+    EXPECT_CALL(static_cast<AudioLibraryWrapperMock&>(*m_audioEngineMock.m_audioLibraryWrapper), openStream(testing::_, testing::_))
+        .WillRepeatedly(testing::Return(true));
+
+    EXPECT_CALL(static_cast<AudioLibraryWrapperMock&>(*m_audioEngineMock.m_audioLibraryWrapper), closeStream)
+        .Times(1);
+
+    EXPECT_EQ(m_audioEngineMock.preRoll(std::chrono::milliseconds { -1 }), std::unexpected { "Pre-roll can not be negative" });
+    EXPECT_FALSE(m_audioEngineMock.trimPreRoll());
+
+    // 48 frames
+    EXPECT_EQ(m_audioEngineMock.preRoll(std::chrono::milliseconds { 1 }), (std::expected<void, std::string> {}));
+    EXPECT_EQ(m_audioEngineMock.preRoll(), std::chrono::milliseconds { 1 });
+
+    m_audioEngineMock.m_audioDevices.push_back(makeInputDevice());
+    m_audioEngineMock.m_audioDevices.push_back(makeOutputDevice());
+
+    EXPECT_EQ(m_audioEngineMock.startStream("input", "output", 2048), (std::expected<void, std::string> {}));
+
+    // Ring buffers were sized for the pre-roll the stream was started with
+    EXPECT_EQ(m_audioEngineMock.preRoll(std::chrono::seconds { 2 }), std::unexpected { "Pre-roll does not fit in the ring buffers, the stream needs to be restarted" });
+    EXPECT_EQ(m_audioEngineMock.preRoll(), std::chrono::milliseconds { 1 });
+
+    auto inputBuffer { audio_buffer::makeAudioBuffer<float>(audio_device::ChannelCount_t { 2 }, audio_stream_params::BufferLength_t { 5 }) };
+    auto outputBuffer { audio_buffer::makeAudioBuffer<float>(audio_device::ChannelCount_t { 2 }, audio_stream_params::BufferLength_t { 5 }) };
+    auto processedInputBuffer { audio_buffer::makeAudioBuffer<float>(audio_device::ChannelCount_t { 4 }, audio_stream_params::BufferLength_t { 5 }) };
+    m_audioEngineMock.m_processedInputBuffer.swap(processedInputBuffer);
+
+    // Not recording, rings are still filled
+    for (auto i { 0 }; i < 20; ++i) {
+        m_audioEngineMock.process(*inputBuffer, *outputBuffer);
+    }
+
+    EXPECT_EQ(m_audioEngineMock.m_inputRingAudioBuffer->availableFrames(), 100u);
+    EXPECT_EQ(m_audioEngineMock.m_outputRingAudioBuffer->availableFrames(), 100u);
+
+    EXPECT_TRUE(m_audioEngineMock.trimPreRoll());
+    EXPECT_EQ(m_audioEngineMock.m_inputRingAudioBuffer->availableFrames(), 48u);
+    EXPECT_EQ(m_audioEngineMock.m_outputRingAudioBuffer->availableFrames(), 48u);
+
+    EXPECT_EQ(m_audioEngineMock.startRecording(audio_format::AudioFormat::Float32, audio_format::EncodingFormat::Wav, {}, std::chrono::milliseconds { 2 }),
+        std::unexpected { "Requested pre-roll is longer than the captured one" });
+
+    EXPECT_EQ(m_audioEngineMock.preRoll(std::chrono::milliseconds { 0 }), (std::expected<void, std::string> {}));
+    EXPECT_FALSE(m_audioEngineMock.trimPreRoll());
+
+    m_audioEngineMock.process(*inputBuffer, *outputBuffer);
+    EXPECT_EQ(m_audioEngineMock.m_inputRingAudioBuffer->availableFrames(), 48u);
+}
@@ -39,4 +39,11 @@ TEST(audio_format, toAudioFormatAndMaFormat) {
     }
 
     EXPECT_EQ(audio_format::toAudioFormat(ma_format_count), std::unexpected { "ma_format unknown" });
+}
+
+TEST(audio_format, encodingFormatToString) {
+    EXPECT_EQ(audio_format::toString(audio_format::EncodingFormat::Wav).value(), "Wav");
+    EXPECT_EQ(audio_format::toString(audio_format::EncodingFormat::Flac).value(), "Flac");
+
+    EXPECT_EQ(audio_format::toString(static_cast<audio_format::EncodingFormat>(55)), std::unexpected { "Encoding format unknown" });
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include <gtest/gtest.h>
+#include <miniaudio.h>
 
 import std;
 
 import audio_recorder;
+import audio_buffer;
+import audio_stream_params;
 import channel_routing;
 import audio_format;
+import peak_file;
 
 using namespace audio_engine;
 
@@ -40,6 +44,13 @@ TEST(AudioRecorder, makeAudioRecorder) {
     ASSERT_FALSE(audioRecorderResult.has_value());
     EXPECT_EQ(audioRecorderResult.error(), "Unsupported audio format");
 
+    audioRecorderResult = audio_recorder::makeAudioRecorder(44100, audio_format::AudioFormat::Float32,
+                                                        { "test" }, { audio_mixer::ChannelRouting {audio_mixer::Routing_t { 0 }, audio_mixer::Routing_t { 1 } } },
+                                                        audio_format::EncodingFormat::Flac);
+
+    ASSERT_FALSE(audioRecorderResult.has_value());
+    EXPECT_EQ(audioRecorderResult.error(), "FLAC does not support floating point samples");
+
     audioRecorderResult =  audio_recorder::makeAudioRecorder(44100, audio_format::AudioFormat::SignedInt16,
                                                              { "test" }, { audio_mixer::ChannelRouting {} });
 
@@ -50,4 +61,103 @@ TEST(AudioRecorder, makeAudioRecorder) {
                                                              { "test1", "test2" }, { audio_mixer::ChannelRouting {audio_mixer::Routing_t { 0 }, audio_mixer::Routing_t { 1 } }, audio_mixer::ChannelRouting {} });
 
     ASSERT_TRUE(audioRecorderResult.has_value());
-}
\ No newline at end of file
+}
+auto readWav(const std::string& fileName) -> std::vector<float> {
+    ma_decoder decoder;
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 2, 44100);
+    config.encodingFormat = ma_encoding_format_wav;
+
+    if (ma_decoder_init_file(fileName.c_str(), &config, &decoder) != MA_SUCCESS) {
+        throw std::runtime_error("Failed to initialize decoder");
+    }
+
+    ma_uint64 length { 0 };
+    ma_decoder_get_length_in_pcm_frames(&decoder, &length);
+
+    std::vector<float> samples(length * 2);
+    ma_uint64 framesRead { 0 };
+    ma_decoder_read_pcm_frames(&decoder, samples.data(), length, &framesRead);
+    ma_decoder_uninit(&decoder);
+
+    samples.resize(framesRead * 2);
+    return samples;
+}
+
+TEST(AudioRecorder, rotate) {
+    constexpr audio_stream_params::BufferLength_t framesPerWrite { 1000 };
+    const std::vector routing { audio_mixer::ChannelRouting { audio_mixer::Routing_t { 0 }, audio_mixer::Routing_t { 1 } } };
+
+    // Previous files are finalized on another thread, as the async task scheduler would do
+    std::vector<std::jthread> finalizers {};
+    const audio_recorder::EncodeDispatcher_t dispatcher { [&finalizers] (std::function<void()> work) { finalizers.emplace_back(std::move(work)); } };
+
+    auto audioRecorder { audio_recorder::makeAudioRecorder(44100, audio_format::AudioFormat::Float32, { "rotate1" }, routing, audio_format::EncodingFormat::Wav, dispatcher).value() };
+    auto nextAudioRecorder { audio_recorder::makeAudioRecorder(44100, audio_format::AudioFormat::Float32, { "rotate2" }, routing, audio_format::EncodingFormat::Wav, dispatcher).value() };
+
+    EXPECT_EQ(audioRecorder->rotate(nullptr, 0).error(), "No audio recorder to rotate to");
+
+    // Rotation in the middle of the second write
+    ASSERT_TRUE(audioRecorder->rotate(std::move(nextAudioRecorder), 1500).has_value());
+    EXPECT_TRUE(audioRecorder->isRotating());
+
+    auto otherAudioRecorder { audio_recorder::makeAudioRecorder(44100, audio_format::AudioFormat::Float32, { "rotate3" }, routing).value() };
+    EXPECT_EQ(audioRecorder->rotate(std::move(otherAudioRecorder), 3000).error(), "Rotation already pending");
+
+    auto audioBuffer { audio_buffer::makeAudioBuffer<float>(2, framesPerWrite) };
+    std::vector<float> samples(framesPerWrite * 2);
+
+    for (unsigned int write { 0 }; write < 3; ++write) {
+        for (std::size_t frame { 0 }; frame < framesPerWrite; ++frame) {
+            const auto value { static_cast<float>(write * framesPerWrite + frame) / 4096.0f };
+            samples[frame * 2] = value;
+            samples[frame * 2 + 1] = -value;
+        }
+
+        audioBuffer->copyFromRawBuffer(samples.data(), 2, framesPerWrite);
+        EXPECT_TRUE(audioRecorder->write(*audioBuffer));
+    }
+
+    EXPECT_FALSE(audioRecorder->isRotating());
+    EXPECT_EQ(audioRecorder->framesWritten(), 3 * framesPerWrite);
+    EXPECT_EQ(audioRecorder->settings().m_fileNames, std::vector<std::string> { "rotate2" });
+
+    finalizers.clear();
+    EXPECT_TRUE(audioRecorder->close());
+    audioRecorder.reset();
+
+    const auto first { readWav("rotate1.wav") };
+    const auto second { readWav("rotate2.wav") };
+
+    ASSERT_EQ(first.size(), 1500 * 2);
+    ASSERT_EQ(second.size(), 1500 * 2);
+
+    // Frames follow each other across files without gap or overlap
+    for (std::size_t frame { 0 }; frame < 3000; ++frame) {
+        const auto left { frame < 1500 ? first[frame * 2] : second[(frame - 1500) * 2] };
+        EXPECT_EQ(left, static_cast<float>(frame) / 4096.0f) << frame;
+    }
+
+    // Each file has its own peaks
+    const auto firstPeaks { peak_file::readPeaks("rotate1", peak_file::binSizes.front()) };
+    const auto secondPeaks { peak_file::readPeaks("rotate2", peak_file::binSizes.front()) };
+
+    ASSERT_TRUE(firstPeaks.has_value());
+    ASSERT_TRUE(secondPeaks.has_value());
+    EXPECT_EQ(firstPeaks->m_totalFrames, 1500u);
+    EXPECT_EQ(secondPeaks->m_totalFrames, 1500u);
+    ASSERT_EQ(firstPeaks->m_peaks.size(), 6u * 2u);
+
+    // Left rises and right falls, so bins span from their first to their last frame
+    EXPECT_EQ(firstPeaks->m_peaks[0].m_min, first[0]);
+    EXPECT_EQ(firstPeaks->m_peaks[0].m_max, first[255 * 2]);
+    EXPECT_EQ(firstPeaks->m_peaks[10].m_max, first[1499 * 2]);
+    EXPECT_EQ(secondPeaks->m_peaks[1].m_min, second[255 * 2 + 1]);
+    EXPECT_EQ(secondPeaks->m_peaks[1].m_max, second[1]);
+
+    EXPECT_TRUE(std::filesystem::remove("rotate1.wav"));
+    EXPECT_TRUE(std::filesystem::remove("rotate2.wav"));
+    EXPECT_TRUE(std::filesystem::remove("rotate1.peaks"));
+    EXPECT_TRUE(std::filesystem::remove("rotate2.peaks"));
+    std::filesystem::remove("rotate3.wav");
+    std::filesystem::remove("rotate3.peaks");
+}
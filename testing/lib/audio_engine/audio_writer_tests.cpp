@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <miniaudio.h>
+#include "flac_decoder.h"
 
 import std;
 import audio_device;
@@ -121,4 +122,87 @@ TEST(AudioWriter, write) {
             EXPECT_TRUE(std::filesystem::remove((std::string { fileName }).append(".wav")));
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(AudioWriter, makeFlacAudioWriter) {
+    const auto audioWriterResult { audio_recorder::makeAudioWriter<audio_format::AudioFormat::Float32>("flacTest", audio_device::SampleRate_t { 44100 },
+        audio_device::ChannelCount_t { 2 }, audio_format::EncodingFormat::Flac) };
+
+    ASSERT_FALSE(audioWriterResult.has_value());
+    EXPECT_EQ(audioWriterResult.error(), "FLAC does not support floating point samples");
+}
+
+TEST(AudioWriter, writeFlac) {
+    std::string_view fileName { "writeFlacTest" };
+
+    // Frames are encoded on other threads, like the async task scheduler does
+    std::vector<std::jthread> encoders {};
+    std::mutex encodersMutex {};
+
+    const audio_recorder::EncodeDispatcher_t dispatcher { [&] (std::function<void()> encode) {
+        std::lock_guard lock { encodersMutex };
+        encoders.emplace_back(std::move(encode));
+    } };
+
+    for (const auto numberOfChannels: { audio_device::ChannelCount_t { 1 }, audio_device::ChannelCount_t { 2 } }) {
+        for (const auto format: { ma_format_s16, ma_format_s24 }) {
+            std::filesystem::remove((std::string { fileName }).append(".flac"));
+
+            // Several blocks and a short last one, written in uneven chunks
+            constexpr unsigned int numberOfFrames { 10000 };
+            constexpr unsigned int chunkSize { 1500 };
+
+            std::vector<float> samples(numberOfFrames * numberOfChannels);
+
+            for (std::size_t i { 0 }; i < samples.size(); ++i) {
+                samples[i] = 0.9f * std::sin(0.001f * static_cast<float>(i));
+            }
+
+            auto audioWriterResult { format == ma_format_s16 ?
+                audio_recorder::makeAudioWriter<audio_format::AudioFormat::SignedInt16>(fileName, audio_device::SampleRate_t { 48000 }, numberOfChannels, audio_format::EncodingFormat::Flac, dispatcher) :
+                audio_recorder::makeAudioWriter<audio_format::AudioFormat::SignedInt24>(fileName, audio_device::SampleRate_t { 48000 }, numberOfChannels, audio_format::EncodingFormat::Flac, dispatcher) };
+
+            ASSERT_TRUE(audioWriterResult.has_value());
+
+            auto audioWriter { std::move(audioWriterResult.value()) };
+
+            for (unsigned int offset { 0 }; offset < numberOfFrames; offset += chunkSize) {
+                const auto frames { std::min(chunkSize, numberOfFrames - offset) };
+
+                auto audioBuffer { audio_buffer::makeAudioBuffer<float>(numberOfChannels, frames) };
+                audioBuffer->copyFromRawBuffer(samples.data() + offset * numberOfChannels, numberOfChannels, frames, numberOfChannels == 2);
+
+                if (numberOfChannels == 1)
+                    EXPECT_TRUE(audioWriter->write(audioBuffer->view(0)));
+                else
+                    EXPECT_TRUE(audioWriter->write(audioBuffer->view(0, 1)));
+            }
+
+            // Waits for every frame and completes the header
+            EXPECT_TRUE(audioWriter->close());
+            audioWriter.reset(nullptr);
+
+            std::vector<float> result(samples.size());
+
+            const auto flacFileName { (std::string { fileName }).append(".flac") };
+
+            ma_uint64 length { 0 };
+            ASSERT_EQ(flacLengthInFrames(flacFileName.c_str(), &length), MA_SUCCESS);
+            EXPECT_EQ(length, numberOfFrames);
+
+            ma_uint64 framesRead { 0 };
+            EXPECT_EQ(readFlacFrames(flacFileName.c_str(), ma_format_f32, numberOfChannels, result.data(), numberOfFrames, &framesRead), MA_SUCCESS);
+            EXPECT_EQ(framesRead, numberOfFrames);
+
+            for (const auto [readSample, ogSample]: std::ranges::views::zip(result, samples)) {
+                constexpr float tolerance = 1e-4f;
+                EXPECT_NEAR(readSample, ogSample, tolerance);
+            }
+
+            EXPECT_TRUE(std::filesystem::remove((std::string { fileName }).append(".flac")));
+        }
+    }
+
+    std::lock_guard lock { encodersMutex };
+    encoders.clear();
+}
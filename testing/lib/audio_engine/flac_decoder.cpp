@@ -0,0 +1,50 @@
+// Every miniaudio function compiled here is static, so that none clashes with the library linked along
+#define MA_API static
+#define MA_NO_DEVICE_IO
+#define MA_NO_ENCODING
+#define MA_NO_MP3
+#define MA_NO_RESOURCE_MANAGER
+#define MA_NO_NODE_GRAPH
+#define MA_NO_ENGINE
+#define MA_NO_GENERATION
+#include <miniaudio.c>
+
+#include "flac_decoder.h"
+
+namespace {
+
+auto initDecoder(const char* fileName, const ma_format format, const ma_uint32 channels, ma_decoder& decoder) -> ma_result {
+    auto config { ma_decoder_config_init(format, channels, 0) };
+    config.encodingFormat = ma_encoding_format_flac;
+
+    return ma_decoder_init_file(fileName, &config, &decoder);
+}
+
+}
+
+auto flacLengthInFrames(const char* fileName, ma_uint64* length) -> ma_result {
+    ma_decoder decoder;
+
+    if (const auto result { initDecoder(fileName, ma_format_unknown, 0, decoder) }; result != MA_SUCCESS) {
+        return result;
+    }
+
+    const auto result { ma_decoder_get_length_in_pcm_frames(&decoder, length) };
+    ma_decoder_uninit(&decoder);
+
+    return result;
+}
+
+auto readFlacFrames(const char* fileName, const ma_format format, const ma_uint32 channels, void* frames, const ma_uint64 frameCount,
+        ma_uint64* framesRead) -> ma_result {
+    ma_decoder decoder;
+
+    if (const auto result { initDecoder(fileName, format, channels, decoder) }; result != MA_SUCCESS) {
+        return result;
+    }
+
+    const auto result { ma_decoder_read_pcm_frames(&decoder, frames, frameCount, framesRead) };
+    ma_decoder_uninit(&decoder);
+
+    return result;
+}
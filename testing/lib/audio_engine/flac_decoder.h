@@ -0,0 +1,10 @@
+#pragma once
+
+#include <miniaudio.h>
+
+// The miniaudio library is built without FLAC, tests read the files they write with a copy of its decoder compiled
+// into them. Frames are interleaved and converted to the format and channel count asked for, at the rate of the file
+
+auto flacLengthInFrames(const char* fileName, ma_uint64* length) -> ma_result;
+
+auto readFlacFrames(const char* fileName, ma_format format, ma_uint32 channels, void* frames, ma_uint64 frameCount, ma_uint64* framesRead) -> ma_result;
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "flac_decoder.h"
+
+import std;
+import audio_device;
+import flac_encoder;
+
+using namespace audio_engine;
+
+// Planar samples, mixing a tone, noise and silence so that every subframe type is exercised
+auto makeSamples(const unsigned int bitsPerSample, const audio_device::ChannelCount_t channels, const std::size_t frames) -> std::vector<std::vector<std::int32_t>> {
+    std::mt19937 generator { 42 };
+    std::uniform_real_distribution noise { -1.0, 1.0 };
+
+    const auto fullScale { static_cast<double>((1 << (bitsPerSample - 1)) - 1) };
+    std::vector samples(channels, std::vector<std::int32_t>(frames));
+
+    for (std::size_t frame { 0 }; frame < frames; ++frame) {
+        for (std::size_t channel { 0 }; channel < channels; ++channel) {
+            auto value { 0.0 };
+
+            if (frame < frames / 3) {
+                value = 0.8 * std::sin(0.01 * static_cast<double>(frame * (channel + 1)));
+            } else if (frame < 2 * frames / 3) {
+                value = noise(generator);
+            }
+
+            samples[channel][frame] = static_cast<std::int32_t>(std::lrint(value * fullScale));
+        }
+    }
+
+    return samples;
+}
+
+auto encodeFile(std::string_view fileName, const flac_encoder::StreamParameters& parameters, const std::vector<std::vector<std::int32_t>>& samples) -> void {
+    std::ofstream file { std::string { fileName }, std::ios::binary | std::ios::trunc };
+    const auto frames { samples.front().size() };
+
+    auto writeBytes { [&file] (const std::vector<std::uint8_t>& bytes) {
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    } };
+
+    writeBytes(flac_encoder::encodeStreamHeader(parameters, {}));
+
+    std::uint64_t frameNumber { 0 };
+
+    for (std::size_t offset { 0 }; offset < frames; offset += parameters.m_blockSize, ++frameNumber) {
+        const auto blockSize { static_cast<std::uint32_t>(std::min<std::size_t>(parameters.m_blockSize, frames - offset)) };
+        std::vector<std::int32_t> block {};
+
+        for (const auto& channel: samples) {
+            block.insert(block.end(), channel.begin() + static_cast<std::ptrdiff_t>(offset), channel.begin() + static_cast<std::ptrdiff_t>(offset + blockSize));
+        }
+
+        writeBytes(flac_encoder::encodeFrame(parameters, frameNumber, block, blockSize));
+    }
+
+    file.seekp(0);
+    writeBytes(flac_encoder::encodeStreamHeader(parameters, { frames, 0, 0 }));
+}
+
+auto decodeFlac(std::string_view fileName, const audio_device::ChannelCount_t channels) -> std::vector<std::int32_t> {
+    ma_uint64 length { 0 };
+
+    if (flacLengthInFrames(fileName.data(), &length) != MA_SUCCESS) {
+        throw std::runtime_error("Failed to read FLAC length");
+    }
+
+    std::vector<std::int32_t> samples(length * channels);
+    ma_uint64 framesRead { 0 };
+
+    if (length != 0 and readFlacFrames(fileName.data(), ma_format_s32, channels, samples.data(), length, &framesRead) != MA_SUCCESS) {
+        throw std::runtime_error("Failed to read from FLAC");
+    }
+
+    samples.resize(framesRead * channels);
+
+    return samples;
+}
+
+TEST(FlacEncoder, losslessRoundTrip) {
+    const std::string fileName { "flacEncoderTest.flac" };
+
+    for (const auto bitsPerSample: { 16u, 24u }) {
+        for (const auto channels: { audio_device::ChannelCount_t { 1 }, audio_device::ChannelCount_t { 2 } }) {
+            // Last block is shorter than the others
+            for (const auto frames: { std::size_t { 1 }, std::size_t { 4096 }, std::size_t { 30000 } }) {
+                const flac_encoder::StreamParameters parameters { 48000, channels, bitsPerSample, flac_encoder::defaultBlockSize };
+                const auto samples { makeSamples(bitsPerSample, channels, frames) };
+
+                encodeFile(fileName, parameters, samples);
+                const auto decoded { decodeFlac(fileName, channels) };
+
+                ASSERT_EQ(decoded.size(), frames * channels) << bitsPerSample << " " << channels << " " << frames;
+
+                for (std::size_t frame { 0 }; frame < frames; ++frame) {
+                    for (std::size_t channel { 0 }; channel < channels; ++channel) {
+                        // Decoder output is left aligned on 32 bits
+                        ASSERT_EQ(decoded[frame * channels + channel] >> (32 - bitsPerSample), samples[channel][frame])
+                            << bitsPerSample << " " << channels << " " << frames << " " << frame;
+                    }
+                }
+            }
+        }
+    }
+
+    EXPECT_TRUE(std::filesystem::remove(fileName));
+}
+
+TEST(FlacEncoder, compression) {
+    const flac_encoder::StreamParameters parameters { 48000, 2, 16, flac_encoder::defaultBlockSize };
+
+    std::vector<std::int32_t> block(std::size_t { parameters.m_blockSize } * 2);
+
+    for (std::size_t i { 0 }; i < parameters.m_blockSize; ++i) {
+        block[i] = static_cast<std::int32_t>(std::lrint(20000.0 * std::sin(0.01 * static_cast<double>(i))));
+        block[i + parameters.m_blockSize] = block[i];
+    }
+
+    // Identical channels are coded with a constant side channel
+    const auto encoded { flac_encoder::encodeFrame(parameters, 0, block, parameters.m_blockSize) };
+    EXPECT_LT(encoded.size(), block.size() * sizeof(std::int16_t) / 4);
+
+    std::ranges::fill(block, 0);
+    EXPECT_LT(flac_encoder::encodeFrame(parameters, 0, block, parameters.m_blockSize).size(), std::size_t { 32 });
+}
+
+TEST(FlacEncoder, isStreamSupported) {
+    EXPECT_TRUE(flac_encoder::isStreamSupported({ 48000, 2, 24, flac_encoder::defaultBlockSize }).has_value());
+
+    EXPECT_EQ(flac_encoder::isStreamSupported({ 48000, 2, 32, flac_encoder::defaultBlockSize }).error(), "Only 16 and 24 bits per sample are supported");
+    EXPECT_EQ(flac_encoder::isStreamSupported({ 48000, 0, 16, flac_encoder::defaultBlockSize }).error(), "Invalid channel count");
+    EXPECT_EQ(flac_encoder::isStreamSupported({ 48000, 9, 16, flac_encoder::defaultBlockSize }).error(), "Invalid channel count");
+    EXPECT_EQ(flac_encoder::isStreamSupported({ 0, 2, 16, flac_encoder::defaultBlockSize }).error(), "Invalid sample rate");
+    EXPECT_EQ(flac_encoder::isStreamSupported({ 48000, 2, 16, 8 }).error(), "Invalid block size");
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+import std;
+import audio_format;
+import audio_buffer;
+import pcm_converter;
+
+using namespace audio_engine;
+
+// Frame counts that are not a multiple of the SIMD width, so that both vector and scalar paths are exercised
+constexpr std::array frameCounts { std::size_t { 1 }, std::size_t { 4 }, std::size_t { 13 }, std::size_t { 1027 } };
+
+auto makeSamples(const std::size_t count, const unsigned int seed) -> std::vector<float> {
+    std::mt19937 generator { seed };
+    // Out of range values check clipping
+    std::uniform_real_distribution distribution { -1.2f, 1.2f };
+
+    std::vector<float> samples(count);
+    std::ranges::generate(samples, [&] () { return distribution(generator); });
+
+    return samples;
+}
+
+auto makeView(const std::vector<float>& left, const std::vector<float>& right) -> audio_buffer::ReadOnlyAudioBufferView<float> {
+    return audio_buffer::ReadOnlyAudioBufferView<float> { audio_buffer::AudioChannel<const float> { left }, audio_buffer::AudioChannel<const float> { right } };
+}
+
+TEST(PcmConverter, convertSignedInt16) {
+    for (const auto frames: frameCounts) {
+        for (const auto channels: { std::size_t { 1 }, std::size_t { 2 } }) {
+            const auto left { makeSamples(frames, 1) };
+            const auto right { channels == 2 ? makeSamples(frames, 2) : std::vector<float> {} };
+
+            std::vector<std::int16_t> output(pcm_converter::outputSize<audio_format::AudioFormat::SignedInt16>(frames, channels));
+            pcm_converter::TpdfDither dither {};
+
+            ASSERT_TRUE(pcm_converter::convert<audio_format::AudioFormat::SignedInt16>(makeView(left, right), output, dither));
+
+            for (std::size_t frame { 0 }; frame < frames; ++frame) {
+                for (std::size_t channel { 0 }; channel < channels; ++channel) {
+                    const auto expected { std::clamp(channel == 0 ? left[frame] : right[frame], -1.0f, 1.0f) * 32767.0f };
+                    // Dither is at most 1 LSB, plus rounding
+                    EXPECT_NEAR(output[frame * channels + channel], expected, 1.5f) << frames << " " << frame << " " << channel;
+                }
+            }
+        }
+    }
+}
+
+TEST(PcmConverter, convertSignedInt24) {
+    for (const auto frames: frameCounts) {
+        for (const auto channels: { std::size_t { 1 }, std::size_t { 2 } }) {
+            const auto left { makeSamples(frames, 3) };
+            const auto right { channels == 2 ? makeSamples(frames, 4) : std::vector<float> {} };
+
+            std::vector<std::uint8_t> output(pcm_converter::outputSize<audio_format::AudioFormat::SignedInt24>(frames, channels));
+            pcm_converter::TpdfDither dither {};
+
+            ASSERT_TRUE(pcm_converter::convert<audio_format::AudioFormat::SignedInt24>(makeView(left, right), output, dither));
+
+            for (std::size_t frame { 0 }; frame < frames; ++frame) {
+                for (std::size_t channel { 0 }; channel < channels; ++channel) {
+                    const auto index { (frame * channels + channel) * 3 };
+                    const auto sample { static_cast<std::int32_t>(output[index]) | (static_cast<std::int32_t>(output[index + 1]) << 8) |
+                        (static_cast<std::int32_t>(static_cast<std::int8_t>(output[index + 2])) * 65536) };
+
+                    const auto expected { static_cast<double>(std::clamp(channel == 0 ? left[frame] : right[frame], -1.0f, 1.0f)) * 8388607.0 };
+                    EXPECT_NEAR(sample, expected, 1.5) << frames << " " << frame << " " << channel;
+                }
+            }
+        }
+    }
+}
+
+TEST(PcmConverter, convertFloat32) {
+    for (const auto frames: frameCounts) {
+        const auto left { makeSamples(frames, 5) };
+        const auto right { makeSamples(frames, 6) };
+
+        std::vector<float> output(pcm_converter::outputSize<audio_format::AudioFormat::Float32>(frames, 2));
+        pcm_converter::TpdfDither dither {};
+
+        ASSERT_TRUE(pcm_converter::convert<audio_format::AudioFormat::Float32>(makeView(left, right), output, dither));
+
+        for (std::size_t frame { 0 }; frame < frames; ++frame) {
+            EXPECT_EQ(output[frame * 2], left[frame]);
+            EXPECT_EQ(output[frame * 2 + 1], right[frame]);
+        }
+
+        ASSERT_TRUE(pcm_converter::convert<audio_format::AudioFormat::Float32>(makeView(left, {}), output, dither));
+        EXPECT_TRUE(std::ranges::equal(std::span { output.data(), frames }, left));
+    }
+}
+
+TEST(PcmConverter, dither) {
+    constexpr std::size_t frames { 1 << 16 };
+
+    const std::vector silence(frames, 0.0f);
+    std::vector<std::int16_t> output(frames);
+    pcm_converter::TpdfDither dither {};
+
+    ASSERT_TRUE(pcm_converter::convert<audio_format::AudioFormat::SignedInt16>(makeView(silence, {}), output, dither));
+
+    // Triangular dither on silence only toggles the last bit around zero and has zero mean
+    EXPECT_EQ(*std::ranges::min_element(output), -1);
+    EXPECT_EQ(*std::ranges::max_element(output), 1);
+
+    const auto sum { std::accumulate(std::ranges::begin(output), std::ranges::end(output), 0.0) };
+    EXPECT_NEAR(sum / static_cast<double>(frames), 0.0, 0.01);
+}
+
+TEST(PcmConverter, invalidInput) {
+    const std::vector left(8, 0.5f);
+    const std::vector right(7, 0.5f);
+
+    std::vector<std::int16_t> output(16);
+    pcm_converter::TpdfDither dither {};
+
+    EXPECT_FALSE(pcm_converter::convert<audio_format::AudioFormat::SignedInt16>(makeView({}, {}), output, dither));
+    EXPECT_FALSE(pcm_converter::convert<audio_format::AudioFormat::SignedInt16>(makeView({}, right), output, dither));
+    EXPECT_FALSE(pcm_converter::convert<audio_format::AudioFormat::SignedInt16>(makeView(left, right), output, dither));
+
+    // Output too small for 8 stereo frames
+    output.resize(15);
+    EXPECT_FALSE(pcm_converter::convert<audio_format::AudioFormat::SignedInt16>(makeView(left, left), output, dither));
+}
+
+TEST(PcmConverter, convertPlanar) {
+    for (const auto frames: frameCounts) {
+        const auto input { makeSamples(frames, 7) };
+
+        std::vector<std::int32_t> output(frames);
+        pcm_converter::TpdfDither dither {};
+
+        ASSERT_TRUE(pcm_converter::convertPlanar<audio_format::AudioFormat::SignedInt24>(input, output, dither));
+
+        for (std::size_t frame { 0 }; frame < frames; ++frame) {
+            EXPECT_NEAR(output[frame], static_cast<double>(std::clamp(input[frame], -1.0f, 1.0f)) * 8388607.0, 1.5) << frames << " " << frame;
+        }
+
+        ASSERT_TRUE(pcm_converter::convertPlanar<audio_format::AudioFormat::SignedInt16>(input, output, dither));
+
+        for (std::size_t frame { 0 }; frame < frames; ++frame) {
+            EXPECT_NEAR(output[frame], std::clamp(input[frame], -1.0f, 1.0f) * 32767.0f, 1.5f) << frames << " " << frame;
+        }
+
+        output.resize(frames - 1);
+        EXPECT_FALSE(pcm_converter::convertPlanar<audio_format::AudioFormat::SignedInt16>(input, output, dither));
+    }
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+import std;
+import audio_buffer;
+import peak_file;
+
+using namespace audio_engine;
+
+TEST(PeakFile, computePeak) {
+    const auto empty { peak_file::computePeak({}) };
+    EXPECT_GT(empty.m_min, empty.m_max);
+
+    // Vectorized part and scalar tail
+    std::vector samples { 0.1f, -0.2f, 0.3f, -0.4f, 0.5f, -0.6f, 0.7f, -0.8f, 0.9f, -1.0f, 0.25f };
+
+    for (std::size_t size { 1 }; size <= samples.size(); ++size) {
+        const auto peak { peak_file::computePeak(std::span { samples }.first(size)) };
+        const auto [min, max] { std::ranges::minmax(std::span { samples }.first(size)) };
+
+        EXPECT_EQ(peak.m_min, min) << size;
+        EXPECT_EQ(peak.m_max, max) << size;
+    }
+}
+
+TEST(PeakFile, writeAndRead) {
+    constexpr std::size_t frames { 100000 };
+
+    std::mt19937 generator { 42 };
+    std::uniform_real_distribution noise { -1.0f, 1.0f };
+
+    std::vector<float> left(frames);
+    std::vector<float> right(frames);
+    std::ranges::generate(left, [&] { return noise(generator); });
+    std::ranges::generate(right, [&] { return noise(generator); });
+
+    {
+        auto peakWriter { peak_file::makePeakWriter("peakFileTest", 48000, 2).value() };
+
+        EXPECT_FALSE(peakWriter->write(audio_buffer::ReadOnlyAudioBufferView<float> { left, {} }));
+
+        // Writes do not line up with bins
+        for (std::size_t offset { 0 }; offset < frames; offset += 1000) {
+            EXPECT_TRUE(peakWriter->write(audio_buffer::ReadOnlyAudioBufferView<float> { left, right }.subview(offset, std::min<std::size_t>(1000, frames - offset))));
+        }
+    }
+
+    for (const auto binSize: peak_file::binSizes) {
+        const auto peakLevel { peak_file::readPeaks("peakFileTest", binSize) };
+
+        ASSERT_TRUE(peakLevel.has_value()) << peakLevel.error();
+        EXPECT_EQ(peakLevel->m_sampleRate, 48000u);
+        EXPECT_EQ(peakLevel->m_channelCount, 2u);
+        EXPECT_EQ(peakLevel->m_binSize, binSize);
+        EXPECT_EQ(peakLevel->m_totalFrames, frames);
+
+        const auto bins { (frames + binSize - 1) / binSize };
+        ASSERT_EQ(peakLevel->m_peaks.size(), bins * 2);
+
+        for (std::size_t bin { 0 }; bin < bins; ++bin) {
+            const auto count { std::min<std::size_t>(binSize, frames - bin * binSize) };
+            const auto [leftMin, leftMax] { std::ranges::minmax(std::span { left }.subspan(bin * binSize, count)) };
+            const auto [rightMin, rightMax] { std::ranges::minmax(std::span { right }.subspan(bin * binSize, count)) };
+
+            EXPECT_EQ(peakLevel->m_peaks[bin * 2].m_min, leftMin) << binSize << " " << bin;
+            EXPECT_EQ(peakLevel->m_peaks[bin * 2].m_max, leftMax) << binSize << " " << bin;
+            EXPECT_EQ(peakLevel->m_peaks[bin * 2 + 1].m_min, rightMin) << binSize << " " << bin;
+            EXPECT_EQ(peakLevel->m_peaks[bin * 2 + 1].m_max, rightMax) << binSize << " " << bin;
+        }
+    }
+
+    EXPECT_EQ(peak_file::readPeaks("peakFileTest", 1000).error(), "Bin size not found in peak file");
+    EXPECT_TRUE(std::filesystem::remove("peakFileTest.peaks"));
+
+    EXPECT_EQ(peak_file::readPeaks("peakFileTest", peak_file::binSizes.front()).error(), "Failed to open peak file");
+    EXPECT_EQ(peak_file::makePeakWriter("", 48000, 2).error(), "File name can not be empty");
+    EXPECT_EQ(peak_file::makePeakWriter("peakFileTest", 48000, 0).error(), "Invalid channel count");
+}
+
+TEST(PeakFile, readIncomplete) {
+    std::vector samples(70000, 0.5f);
+    samples[5000] = -0.5f;
+
+    {
+        auto peakWriter { peak_file::makePeakWriter("peakFileIncompleteTest", 48000, 1).value() };
+        EXPECT_TRUE(peakWriter->write(audio_buffer::ReadOnlyAudioBufferView<float> { samples, {} }));
+    }
+
+    // As if recording stopped abruptly: no frame count and only the finest bins
+    const auto headerSize { 16 + peak_file::binSizes.size() * sizeof(std::uint32_t) + sizeof(std::uint64_t) };
+
+    {
+        std::fstream file { "peakFileIncompleteTest.peaks", std::ios::binary | std::ios::in | std::ios::out };
+        file.seekp(static_cast<std::streamoff>(headerSize - sizeof(std::uint64_t)));
+
+        constexpr std::array<char, sizeof(std::uint64_t)> zero {};
+        file.write(zero.data(), static_cast<std::streamsize>(zero.size()));
+    }
+
+    std::filesystem::resize_file("peakFileIncompleteTest.peaks", headerSize + (samples.size() / 256) * 2 * sizeof(float));
+
+    const auto peakLevel { peak_file::readPeaks("peakFileIncompleteTest", 4096) };
+
+    ASSERT_TRUE(peakLevel.has_value()) << peakLevel.error();
+    EXPECT_EQ(peakLevel->m_totalFrames, samples.size() / 256 * 256);
+    ASSERT_EQ(peakLevel->m_peaks.size(), 18u);
+    EXPECT_EQ(peakLevel->m_peaks[1].m_min, -0.5f);
+    EXPECT_EQ(peakLevel->m_peaks[2].m_min, 0.5f);
+
+    EXPECT_TRUE(std::filesystem::remove("peakFileIncompleteTest.peaks"));
+}
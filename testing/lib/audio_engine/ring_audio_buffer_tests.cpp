@@ -130,4 +130,33 @@ TEST(RingAudioBuffer, enqueue_wraparound) {
     outputBuffer->writeToRawBuffer(outputSamples.data(), 2, 4, true);
 
     EXPECT_EQ(outputSamples, wrapInput);
-}
\ No newline at end of file
+}
+
+TEST(RingAudioBuffer, discardAndPartialDequeue) {
+    ring_audio_buffer::RingAudioBuffer<int> rb { audio_device::ChannelCount_t { 1 }, audio_stream_params::BufferLength_t { 8 } };
+
+    EXPECT_EQ(rb.capacity(), 8u);
+    EXPECT_EQ(rb.availableFrames(), 0u);
+
+    constexpr std::array input { 1, 2, 3, 4, 5, 6 };
+    const auto inputBuffer { audio_buffer::makeAudioBuffer<int>(1, 6) };
+    inputBuffer->copyFromRawBuffer(input.data(), 1, 6);
+    ASSERT_TRUE(rb.enqueue(*inputBuffer));
+
+    // Oldest frames go first
+    ASSERT_TRUE(rb.discard(2));
+    EXPECT_EQ(rb.availableFrames(), 4u);
+
+    const auto outputBuffer { audio_buffer::makeAudioBuffer<int>(0, 0) };
+    ASSERT_TRUE(rb.dequeue(*outputBuffer, 3));
+    ASSERT_EQ(outputBuffer->bufferLength(), 3u);
+
+    std::array<int, 3> output {};
+    outputBuffer->writeToRawBuffer(output.data(), 1, 3);
+    EXPECT_EQ(output, (std::array { 3, 4, 5 }));
+    EXPECT_EQ(rb.availableFrames(), 1u);
+
+    // Discarding more than available empties the buffer
+    ASSERT_TRUE(rb.discard(100));
+    EXPECT_EQ(rb.availableFrames(), 0u);
+}
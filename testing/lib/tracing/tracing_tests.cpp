@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+import std;
+
+import tracing;
+
+namespace {
+
+auto chromeTrace() -> std::string {
+    std::ostringstream stream {};
+    tracing::writeChromeTrace(stream);
+    return stream.str();
+}
+
+auto occurrences(const std::string_view text, const std::string_view pattern) -> std::size_t {
+    std::size_t count { 0 };
+
+    for (auto position { text.find(pattern) }; position != std::string_view::npos; position = text.find(pattern, position + pattern.size())) {
+        ++count;
+    }
+
+    return count;
+}
+
+}
+
+TEST(Tracing, writeChromeTrace) {
+    std::jthread { [] () {
+        tracing::nameCurrentThread("traced \"thread\"");
+
+        const auto startedAt { std::chrono::steady_clock::time_point { std::chrono::nanoseconds { 5'000'250 } } };
+        tracing::record("test", "written span", startedAt, startedAt + std::chrono::nanoseconds { 1'500 });
+
+        {
+            const tracing::TraceSpan span { "test", "scoped span" };
+        }
+    } }.join();
+
+    const auto trace { chromeTrace() };
+
+    EXPECT_TRUE(trace.starts_with(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+    EXPECT_TRUE(trace.ends_with("]}\n"));
+    EXPECT_TRUE(trace.contains(R"("name":"thread_name","ph":"M")"));
+    EXPECT_TRUE(trace.contains(R"("args":{"name":"traced \"thread\""})"));
+    EXPECT_TRUE(trace.contains(R"({"name":"written span","cat":"test","ph":"X")"));
+    EXPECT_TRUE(trace.contains(R"("ts":5000.250,"dur":1.500})"));
+    EXPECT_TRUE(trace.contains(R"({"name":"scoped span","cat":"test","ph":"X")"));
+}
+
+TEST(Tracing, oldestSpansOverwritten) {
+    std::jthread { [] () {
+        const auto startedAt { std::chrono::steady_clock::now() };
+
+        for (std::size_t i { 0 }; i < tracing::spansPerThread + 10; ++i) {
+            tracing::record("test", "overwritten span", startedAt, startedAt);
+        }
+    } }.join();
+
+    EXPECT_EQ(occurrences(chromeTrace(), R"("name":"overwritten span")"), tracing::spansPerThread);
+}
+
+TEST(Tracing, dumpWhileRecording) {
+    std::atomic_bool recording { true };
+
+    std::jthread recorder { [&recording] () {
+        while (recording.load(std::memory_order_relaxed)) {
+            const tracing::TraceSpan span { "test", "concurrent span" };
+        }
+    } };
+
+    for (int i { 0 }; i < 5; ++i) {
+        const auto trace { chromeTrace() };
+
+        // Every span written whole
+        EXPECT_EQ(occurrences(trace, R"("name":"concurrent span","cat":"test","ph":"X")"), occurrences(trace, "concurrent span"));
+    }
+
+    recording.store(false, std::memory_order_relaxed);
+}
+
+TEST(Tracing, reservedThread) {
+    std::optional<tracing::ReservedThread> reserved { std::in_place, "reserved thread" };
+
+    std::jthread { [&reserved] () {
+        reserved->attach();
+        const tracing::TraceSpan span { "test", "reserved span" };
+    } }.join();
+
+    // Named before its spans, on the same thread
+    EXPECT_TRUE(chromeTrace().contains(R"("args":{"name":"reserved thread"}},{"name":"reserved span","cat":"test")"));
+
+    // Released, the spans are kept until another thread takes them over
+    reserved.reset();
+    EXPECT_EQ(occurrences(chromeTrace(), "reserved span"), 1u);
+}
+
+TEST(Tracing, dumpChromeTrace) {
+    const auto path { std::filesystem::temp_directory_path() / "muesli-radio-tracing-test.json" };
+
+    EXPECT_TRUE(tracing::dumpChromeTrace(path).has_value());
+    EXPECT_GT(std::filesystem::file_size(path), 0u);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(tracing::dumpChromeTrace(path / "missing" / "trace.json").error(),
+        std::format("Cannot open {}", (path / "missing" / "trace.json").string()));
+}